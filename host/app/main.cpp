@@ -0,0 +1,107 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+// Runs the unmodified firmware (app_main and everything it starts) as a Linux process.
+//   smart_fountain_host [--softap] [--weight <g>] [--noise <counts>]
+// Environment: SMART_FOUNTAIN_HTTP_PORT (default 8080), SMART_FOUNTAIN_NVS_PATH (default nvs.txt),
+// SMART_FOUNTAIN_HOST_LOG_LEVEL (0 none .. 5 verbose).
+// Signals: SIGUSR1 drops the simulated Wi-Fi link, SIGUSR2 restores it, SIGINT/SIGTERM exit.
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <esp_log.h>
+#include <freertos/task.h>
+#include <host/hx711_sim.h>
+#include <host/wifi_sim.h>
+#include <nvs.h>
+#include <nvs_flash.h>
+#include <unistd.h>
+
+extern "C" void app_main(void);
+
+static auto TAG = "host";
+
+// CONFIG_ESP_MAIN_TASK_STACK_SIZE and priority of the IDF main task
+static constexpr uint32_t MAIN_TASK_STACK = 3584;
+static constexpr UBaseType_t MAIN_TASK_PRIORITY = 1;
+
+static void main_task([[maybe_unused]] void *arg) {
+    app_main();
+    ESP_LOGI(TAG, "app_main returned");
+    vTaskDelete(nullptr);
+}
+
+/**
+ * @brief Stores station credentials unless some are already saved, so boot takes the station path
+ */
+static void seed_wifi_credentials() {
+    nvs_flash_init();
+    nvs_handle_t nvs;
+    if (nvs_open("wifi", NVS_READWRITE, &nvs) != ESP_OK) {
+        return;
+    }
+    size_t size = 0;
+    if (nvs_get_str(nvs, "ssid", nullptr, &size) != ESP_OK) {
+        nvs_set_str(nvs, "ssid", "host");
+        nvs_set_str(nvs, "pass", "host");
+        nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+}
+
+int main(const int argc, char **argv) {
+    system_sim_init(argc, argv);
+
+    Hx711SimConfig scale;
+    bool softap = false;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--softap") == 0) {
+            softap = true;
+        } else if (strcmp(argv[i], "--weight") == 0 && i + 1 < argc) {
+            scale.weight_g = strtof(argv[++i], nullptr);
+        } else if (strcmp(argv[i], "--noise") == 0 && i + 1 < argc) {
+            scale.noise_counts = strtof(argv[++i], nullptr);
+        } else {
+            fprintf(stderr, "usage: %s [--softap] [--weight <g>] [--noise <counts>]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (!getenv("SMART_FOUNTAIN_HTTP_PORT")) {
+        setenv("SMART_FOUNTAIN_HTTP_PORT", "8080", 0);
+    }
+
+    // Tasks inherit the mask, so only this thread receives the control signals
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGUSR1);
+    sigaddset(&signals, SIGUSR2);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    // Same pins as app_main: PD_SCK on GPIO1, DOUT on GPIO2
+    hx711_sim_attach(GPIO_NUM_1, GPIO_NUM_2, scale);
+    if (!softap) {
+        seed_wifi_credentials();
+    }
+
+    xTaskCreatePinnedToCore(main_task, "main", MAIN_TASK_STACK, nullptr, MAIN_TASK_PRIORITY, nullptr, 0);
+
+    for (;;) {
+        int sig = 0;
+        sigwait(&signals, &sig);
+        if (sig == SIGUSR1) {
+            wifi_sim_drop();
+        } else if (sig == SIGUSR2) {
+            wifi_sim_restore();
+        } else {
+            ESP_LOGI(TAG, "Exiting on signal %d", sig);
+            fflush(nullptr);
+            // Tasks are still running, skip static destructors
+            _exit(0);
+        }
+    }
+}
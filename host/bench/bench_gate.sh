@@ -0,0 +1,30 @@
+#!/usr/bin/env bash
+# Starts smart_fountain_host on a spare port in a scratch directory and runs http_bench against it, for ctest.
+#   bench_gate.sh <smart_fountain_host> <http_bench> <port> [http_bench options...]
+# The exit code is http_bench's, or 2 when the host does not come up.
+set -u
+
+firmware=$1
+bench=$2
+port=$3
+shift 3
+
+dir=$(mktemp -d)
+SMART_FOUNTAIN_HTTP_PORT=$port SMART_FOUNTAIN_NVS_PATH=$dir/nvs.txt SMART_FOUNTAIN_OTA_DIR=$dir \
+    SMART_FOUNTAIN_HOST_LOG_LEVEL=2 "$firmware" > "$dir/host.log" 2>&1 < /dev/null &
+pid=$!
+trap 'kill $pid 2> /dev/null; wait $pid 2> /dev/null; rm -rf "$dir"' EXIT
+
+for _ in $(seq 50); do
+    if (exec 3<> "/dev/tcp/127.0.0.1/$port") 2> /dev/null; then
+        "$bench" --port "$port" "$@"
+        exit
+    fi
+    if ! kill -0 $pid 2> /dev/null; then
+        break
+    fi
+    sleep 0.1
+done
+echo "smart_fountain_host did not listen on port $port" >&2
+cat "$dir/host.log" >&2
+exit 2
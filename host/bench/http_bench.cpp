@@ -0,0 +1,557 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+// Closed-loop HTTP/1.1 load generator for the firmware API, against the host build or a real device.
+// Every connection keeps one request in flight and cycles through the routes; latency is measured per route
+// from the first byte written to the last byte of the response.
+//
+//   http_bench [--host 127.0.0.1] [--port 8080] [--duration 10] [--warmup 1] [--connections 6] [--threads 2]
+//              [--route /scale ...] [--json results.json] [--gate <route>:<metric>:<limit> ...]
+//              [--metric-gate <series>:<limit> ...]
+//
+// Gates turn the run into a CI check: metrics p50, p99 and p999 are upper bounds in milliseconds, rps is a lower
+// bound and errors an upper bound. Metric gates read /metrics once after the run and bound a series of the
+// firmware, e.g. heap_steady_state_violations_total:0 asserts that no handler allocated under load.
+// The exit code is 1 when a gate fails, 2 on usage or connection errors.
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string>
+#include <strings.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string host = "127.0.0.1";
+    std::string port = "8080";
+    double duration_s = 10;
+    double warmup_s = 1;
+    // The device serves 7 sockets, keep one free for the browser
+    int connections = 6;
+    int threads = 2;
+    std::vector<std::string> routes;
+    std::string json_path;
+    std::vector<std::string> gates;
+    std::vector<std::string> metric_gates;
+};
+
+struct RouteStats {
+    std::vector<uint32_t> latency_us;
+    uint64_t errors = 0;
+    uint64_t bytes = 0;
+};
+
+struct Connection {
+    int fd = -1;
+    size_t route = 0;
+    std::string request;
+    size_t written = 0;
+    std::string response;
+    Clock::time_point started;
+};
+
+static std::atomic<bool> measuring{false};
+static std::atomic<bool> finished{false};
+static std::atomic<uint64_t> connect_failures{0};
+
+static addrinfo *resolve(const Options &opt) {
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *result = nullptr;
+    if (getaddrinfo(opt.host.c_str(), opt.port.c_str(), &hints, &result) != 0) {
+        return nullptr;
+    }
+    return result;
+}
+
+static int open_connection(const addrinfo *addr) {
+    const int fd = socket(addr->ai_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    const int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (connect(fd, addr->ai_addr, addr->ai_addrlen) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief Returns the length of the complete response at the start of buf, 0 if more bytes are needed
+ * or -1 if it cannot be parsed. Sets status and whether the server closes the connection.
+ */
+static ssize_t response_length(const std::string &buf, int &status, bool &close_after) {
+    const size_t head_end = buf.find("\r\n\r\n");
+    if (head_end == std::string::npos) {
+        return 0;
+    }
+    if (buf.compare(0, 9, "HTTP/1.1 ") != 0 && buf.compare(0, 9, "HTTP/1.0 ") != 0) {
+        return -1;
+    }
+    status = atoi(buf.c_str() + 9);
+    close_after = buf.compare(0, 9, "HTTP/1.0 ") == 0;
+    const size_t body = head_end + 4;
+
+    ssize_t content_length = -1;
+    bool chunked = false;
+    for (size_t line = buf.find("\r\n") + 2; line < head_end;) {
+        const size_t eol = buf.find("\r\n", line);
+        const std::string_view header(buf.data() + line, eol - line);
+        const size_t colon = header.find(':');
+        if (colon != std::string_view::npos) {
+            const std::string_view name = header.substr(0, colon);
+            std::string_view value = header.substr(colon + 1);
+            while (!value.empty() && value.front() == ' ') {
+                value.remove_prefix(1);
+            }
+            auto is = [&](const char *expected) {
+                return name.size() == strlen(expected) && strncasecmp(name.data(), expected, name.size()) == 0;
+            };
+            if (is("Content-Length")) {
+                content_length = strtol(std::string(value).c_str(), nullptr, 10);
+            } else if (is("Transfer-Encoding")) {
+                chunked = value.find("chunked") != std::string_view::npos;
+            } else if (is("Connection")) {
+                close_after = strncasecmp(value.data(), "close", 5) == 0;
+            }
+        }
+        line = eol + 2;
+    }
+
+    if (!chunked) {
+        if (content_length < 0) {
+            return -1;
+        }
+        return buf.size() >= body + content_length ? static_cast<ssize_t>(body + content_length) : 0;
+    }
+    size_t pos = body;
+    for (;;) {
+        const size_t eol = buf.find("\r\n", pos);
+        if (eol == std::string::npos) {
+            return 0;
+        }
+        const size_t size = strtoul(buf.c_str() + pos, nullptr, 16);
+        if (size == 0) {
+            // No trailers are sent, the last chunk ends with an empty line
+            return buf.size() >= eol + 4 ? static_cast<ssize_t>(eol + 4) : 0;
+        }
+        pos = eol + 2 + size + 2;
+        if (pos > buf.size()) {
+            return 0;
+        }
+    }
+}
+
+static void worker(const Options &opt, const addrinfo *addr, const int connections, const int first,
+                   std::vector<RouteStats> &stats) {
+    const int ep = epoll_create1(EPOLL_CLOEXEC);
+    std::vector<Connection> conns(connections);
+    char buf[16384];
+
+    auto start_request = [&](Connection &c) {
+        c.request = "GET " + opt.routes[c.route] + " HTTP/1.1\r\nHost: " + opt.host + "\r\n\r\n";
+        c.written = 0;
+        c.response.clear();
+        c.started = Clock::now();
+    };
+    auto reconnect = [&](Connection &c, const size_t index) {
+        if (c.fd >= 0) {
+            epoll_ctl(ep, EPOLL_CTL_DEL, c.fd, nullptr);
+            close(c.fd);
+        }
+        c.fd = -1;
+        while (!finished.load() && (c.fd = open_connection(addr)) < 0) {
+            connect_failures.fetch_add(1);
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        if (c.fd < 0) {
+            return;
+        }
+        epoll_event ev = {};
+        ev.events = EPOLLIN | EPOLLOUT;
+        ev.data.u64 = index;
+        epoll_ctl(ep, EPOLL_CTL_ADD, c.fd, &ev);
+        start_request(c);
+    };
+
+    for (int i = 0; i < connections; ++i) {
+        conns[i].route = static_cast<size_t>(first + i) % opt.routes.size();
+        reconnect(conns[i], i);
+    }
+
+    epoll_event events[64];
+    while (!finished.load()) {
+        const int n = epoll_wait(ep, events, 64, 100);
+        for (int e = 0; e < n; ++e) {
+            const size_t index = events[e].data.u64;
+            Connection &c = conns[index];
+            if (c.fd < 0) {
+                continue;
+            }
+            if (c.written < c.request.size()) {
+                const ssize_t sent = send(c.fd, c.request.data() + c.written, c.request.size() - c.written,
+                                          MSG_NOSIGNAL);
+                if (sent < 0 && errno != EAGAIN) {
+                    if (measuring.load()) {
+                        stats[c.route].errors++;
+                    }
+                    reconnect(c, index);
+                    continue;
+                }
+                c.written += sent > 0 ? static_cast<size_t>(sent) : 0;
+                if (c.written == c.request.size()) {
+                    epoll_event ev = {};
+                    ev.events = EPOLLIN;
+                    ev.data.u64 = index;
+                    epoll_ctl(ep, EPOLL_CTL_MOD, c.fd, &ev);
+                }
+                continue;
+            }
+            const ssize_t got = recv(c.fd, buf, sizeof(buf), 0);
+            if (got <= 0) {
+                if (got < 0 && errno == EAGAIN) {
+                    continue;
+                }
+                if (measuring.load()) {
+                    stats[c.route].errors++;
+                }
+                c.route = (c.route + 1) % opt.routes.size();
+                reconnect(c, index);
+                continue;
+            }
+            c.response.append(buf, got);
+            int status = 0;
+            bool close_after = false;
+            const ssize_t len = response_length(c.response, status, close_after);
+            if (len == 0) {
+                continue;
+            }
+            if (measuring.load()) {
+                RouteStats &s = stats[c.route];
+                if (len < 0 || status < 200 || status >= 300) {
+                    s.errors++;
+                } else {
+                    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - c.started);
+                    s.latency_us.push_back(static_cast<uint32_t>(us.count()));
+                    s.bytes += static_cast<uint64_t>(len);
+                }
+            }
+            c.route = (c.route + 1) % opt.routes.size();
+            if (len < 0 || close_after) {
+                reconnect(c, index);
+                continue;
+            }
+            start_request(c);
+            epoll_event ev = {};
+            ev.events = EPOLLIN | EPOLLOUT;
+            ev.data.u64 = index;
+            epoll_ctl(ep, EPOLL_CTL_MOD, c.fd, &ev);
+        }
+    }
+    for (const Connection &c: conns) {
+        if (c.fd >= 0) {
+            close(c.fd);
+        }
+    }
+    close(ep);
+}
+
+struct Summary {
+    std::string route;
+    uint64_t requests;
+    uint64_t errors;
+    double rps;
+    double p50_ms;
+    double p99_ms;
+    double p999_ms;
+    double max_ms;
+    double kb_per_request;
+};
+
+static double percentile(const std::vector<uint32_t> &sorted, const double p) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    const auto rank = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[rank] / 1000.0;
+}
+
+static Summary summarize(const std::string &route, RouteStats &s, const double seconds) {
+    std::sort(s.latency_us.begin(), s.latency_us.end());
+    const auto count = static_cast<uint64_t>(s.latency_us.size());
+    return {
+        route, count, s.errors, static_cast<double>(count) / seconds,
+        percentile(s.latency_us, 0.50), percentile(s.latency_us, 0.99), percentile(s.latency_us, 0.999),
+        s.latency_us.empty() ? 0 : s.latency_us.back() / 1000.0,
+        count ? static_cast<double>(s.bytes) / static_cast<double>(count) / 1024.0 : 0,
+    };
+}
+
+static bool check_gate(const std::string &gate, const std::vector<Summary> &results) {
+    const size_t last = gate.rfind(':');
+    const size_t mid = last == std::string::npos ? std::string::npos : gate.rfind(':', last - 1);
+    if (mid == std::string::npos) {
+        fprintf(stderr, "invalid gate %s, expected <route>:<metric>:<limit>\n", gate.c_str());
+        return false;
+    }
+    const std::string route = gate.substr(0, mid);
+    const std::string metric = gate.substr(mid + 1, last - mid - 1);
+    const double limit = strtod(gate.c_str() + last + 1, nullptr);
+    for (const Summary &s: results) {
+        if (s.route != route) {
+            continue;
+        }
+        double actual;
+        bool lower_bound = false;
+        if (metric == "p50") {
+            actual = s.p50_ms;
+        } else if (metric == "p99") {
+            actual = s.p99_ms;
+        } else if (metric == "p999") {
+            actual = s.p999_ms;
+        } else if (metric == "errors") {
+            actual = static_cast<double>(s.errors);
+        } else if (metric == "rps") {
+            actual = s.rps;
+            lower_bound = true;
+        } else {
+            fprintf(stderr, "unknown gate metric %s\n", metric.c_str());
+            return false;
+        }
+        const bool ok = lower_bound ? actual >= limit : actual <= limit;
+        printf("gate %-32s %s (%.3f %s %.3f)\n", gate.c_str(), ok ? "pass" : "FAIL", actual,
+               lower_bound ? ">=" : "<=", limit);
+        return ok;
+    }
+    fprintf(stderr, "gate %s names a route that was not benchmarked\n", gate.c_str());
+    return false;
+}
+
+/**
+ * @brief Fetches /metrics on a new connection, returns the body with chunked framing removed, empty on failure
+ */
+static std::string fetch_metrics(const Options &opt, const addrinfo *addr) {
+    const int fd = open_connection(addr);
+    if (fd < 0) {
+        return {};
+    }
+    const std::string request = "GET /metrics HTTP/1.1\r\nHost: " + opt.host + "\r\n\r\n";
+    if (send(fd, request.data(), request.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(request.size())) {
+        close(fd);
+        return {};
+    }
+    std::string buf;
+    char chunk[16384];
+    int status = 0;
+    bool close_after = false;
+    ssize_t length;
+    while ((length = response_length(buf, status, close_after)) == 0) {
+        const ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+            break;
+        }
+        buf.append(chunk, n);
+    }
+    close(fd);
+    if (length <= 0 || status != 200) {
+        return {};
+    }
+    const size_t body = buf.find("\r\n\r\n") + 4;
+    const std::string head = buf.substr(0, body);
+    if (!strcasestr(head.c_str(), "Transfer-Encoding: chunked")) {
+        return buf.substr(body, length - body);
+    }
+    std::string out;
+    for (size_t pos = body;;) {
+        const size_t eol = buf.find("\r\n", pos);
+        const size_t size = strtoul(buf.c_str() + pos, nullptr, 16);
+        if (size == 0) {
+            return out;
+        }
+        out.append(buf, eol + 2, size);
+        pos = eol + 2 + size + 2;
+    }
+}
+
+static bool check_metric_gate(const std::string &gate, const std::string &metrics) {
+    const size_t colon = gate.rfind(':');
+    if (colon == std::string::npos || colon == 0) {
+        fprintf(stderr, "invalid metric gate %s, expected <series>:<limit>\n", gate.c_str());
+        return false;
+    }
+    const std::string series = gate.substr(0, colon);
+    const double limit = strtod(gate.c_str() + colon + 1, nullptr);
+    for (size_t line = 0; line < metrics.size();) {
+        size_t eol = metrics.find('\n', line);
+        if (eol == std::string::npos) {
+            eol = metrics.size();
+        }
+        if (metrics.compare(line, series.size(), series) == 0 && line + series.size() < eol &&
+            metrics[line + series.size()] == ' ') {
+            const double actual = strtod(metrics.c_str() + line + series.size() + 1, nullptr);
+            const bool ok = actual <= limit;
+            printf("gate %-32s %s (%.3f <= %.3f)\n", gate.c_str(), ok ? "pass" : "FAIL", actual, limit);
+            return ok;
+        }
+        line = eol + 1;
+    }
+    fprintf(stderr, "metric gate %s names a series that /metrics does not export\n", gate.c_str());
+    return false;
+}
+
+static void write_json(const std::string &path, const Options &opt, const std::vector<Summary> &results) {
+    FILE *f = fopen(path.c_str(), "w");
+    if (!f) {
+        fprintf(stderr, "cannot write %s: %s\n", path.c_str(), strerror(errno));
+        return;
+    }
+    fprintf(f, "{\"target\":\"%s:%s\",\"duration_s\":%.1f,\"connections\":%d,\"routes\":[", opt.host.c_str(),
+            opt.port.c_str(), opt.duration_s, opt.connections);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Summary &s = results[i];
+        fprintf(f, "%s{\"route\":\"%s\",\"requests\":%llu,\"errors\":%llu,\"rps\":%.1f,\"p50_ms\":%.3f,"
+                "\"p99_ms\":%.3f,\"p999_ms\":%.3f,\"max_ms\":%.3f}", i ? "," : "", s.route.c_str(),
+                static_cast<unsigned long long>(s.requests), static_cast<unsigned long long>(s.errors), s.rps,
+                s.p50_ms, s.p99_ms, s.p999_ms, s.max_ms);
+    }
+    fprintf(f, "]}\n");
+    fclose(f);
+}
+
+int main(const int argc, char **argv) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            fprintf(stderr, "missing value for %s\n", arg.c_str());
+            return 2;
+        }
+        ++i;
+        if (arg == "--host") {
+            opt.host = value;
+        } else if (arg == "--port") {
+            opt.port = value;
+        } else if (arg == "--duration") {
+            opt.duration_s = strtod(value, nullptr);
+        } else if (arg == "--warmup") {
+            opt.warmup_s = strtod(value, nullptr);
+        } else if (arg == "--connections") {
+            opt.connections = atoi(value);
+        } else if (arg == "--threads") {
+            opt.threads = atoi(value);
+        } else if (arg == "--route") {
+            opt.routes.emplace_back(value);
+        } else if (arg == "--json") {
+            opt.json_path = value;
+        } else if (arg == "--gate") {
+            opt.gates.emplace_back(value);
+        } else if (arg == "--metric-gate") {
+            opt.metric_gates.emplace_back(value);
+        } else {
+            fprintf(stderr, "unknown option %s\n", arg.c_str());
+            return 2;
+        }
+    }
+    if (opt.routes.empty()) {
+        opt.routes = {"/health", "/scale", "/api/pump", "/metrics", "/api/tasks"};
+    }
+    opt.threads = std::clamp(opt.threads, 1, std::max(opt.connections, 1));
+
+    addrinfo *addr = resolve(opt);
+    if (!addr) {
+        fprintf(stderr, "cannot resolve %s\n", opt.host.c_str());
+        return 2;
+    }
+    if (const int probe = open_connection(addr); probe >= 0) {
+        close(probe);
+    } else {
+        fprintf(stderr, "cannot connect to %s:%s: %s\n", opt.host.c_str(), opt.port.c_str(), strerror(errno));
+        freeaddrinfo(addr);
+        return 2;
+    }
+
+    std::vector<std::vector<RouteStats>> stats(opt.threads, std::vector<RouteStats>(opt.routes.size()));
+    std::vector<std::thread> workers;
+    for (int t = 0; t < opt.threads; ++t) {
+        const int first = opt.connections * t / opt.threads;
+        const int count = opt.connections * (t + 1) / opt.threads - first;
+        workers.emplace_back(worker, std::cref(opt), addr, count, first, std::ref(stats[t]));
+    }
+    std::this_thread::sleep_for(std::chrono::duration<double>(opt.warmup_s));
+    measuring.store(true);
+    const auto start = Clock::now();
+    std::this_thread::sleep_for(std::chrono::duration<double>(opt.duration_s));
+    measuring.store(false);
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    finished.store(true);
+    for (std::thread &w: workers) {
+        w.join();
+    }
+
+    std::vector<Summary> results;
+    RouteStats total;
+    for (size_t r = 0; r < opt.routes.size(); ++r) {
+        RouteStats merged;
+        for (auto &thread_stats: stats) {
+            RouteStats &s = thread_stats[r];
+            merged.latency_us.insert(merged.latency_us.end(), s.latency_us.begin(), s.latency_us.end());
+            merged.errors += s.errors;
+            merged.bytes += s.bytes;
+        }
+        total.latency_us.insert(total.latency_us.end(), merged.latency_us.begin(), merged.latency_us.end());
+        total.errors += merged.errors;
+        total.bytes += merged.bytes;
+        results.push_back(summarize(opt.routes[r], merged, seconds));
+    }
+    results.push_back(summarize("all", total, seconds));
+
+    printf("%-16s %9s %7s %10s %9s %9s %9s %9s %8s\n", "route", "requests", "errors", "req/s", "p50 ms", "p99 ms",
+           "p99.9 ms", "max ms", "KiB/req");
+    for (const Summary &s: results) {
+        printf("%-16s %9llu %7llu %10.1f %9.3f %9.3f %9.3f %9.3f %8.2f\n", s.route.c_str(),
+               static_cast<unsigned long long>(s.requests), static_cast<unsigned long long>(s.errors), s.rps,
+               s.p50_ms, s.p99_ms, s.p999_ms, s.max_ms, s.kb_per_request);
+    }
+    if (connect_failures.load()) {
+        printf("connect failures: %llu\n", static_cast<unsigned long long>(connect_failures.load()));
+    }
+    if (!opt.json_path.empty()) {
+        write_json(opt.json_path, opt, results);
+    }
+
+    bool passed = true;
+    for (const std::string &gate: opt.gates) {
+        passed = check_gate(gate, results) && passed;
+    }
+    if (!opt.metric_gates.empty()) {
+        const std::string metrics = fetch_metrics(opt, addr);
+        if (metrics.empty()) {
+            fprintf(stderr, "cannot fetch /metrics for the metric gates\n");
+            passed = false;
+        }
+        for (const std::string &gate: opt.metric_gates) {
+            passed = !metrics.empty() && check_metric_gate(gate, metrics) && passed;
+        }
+    }
+    freeaddrinfo(addr);
+    return passed ? 0 : 1;
+}
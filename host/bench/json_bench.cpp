@@ -0,0 +1,251 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+// Compares JsonWriter against std::string concatenation and snprintf on the payloads served by the API.
+// Responses go to a counting sink standing in for httpd, so only formatting and buffering are measured.
+// The exit code is 1 if a JsonWriter case allocated, so it can run in CI.
+//   json_bench [iterations]
+
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+
+#include "json/JsonWriter.hpp"
+
+// ---- httpd sink ----
+
+static size_t sink_bytes = 0;
+static size_t sink_chunks = 0;
+
+extern "C" esp_err_t httpd_resp_send(httpd_req_t *, const char *buf, const ssize_t buf_len) {
+    sink_bytes += buf_len == HTTPD_RESP_USE_STRLEN ? strlen(buf) : static_cast<size_t>(buf_len);
+    return ESP_OK;
+}
+
+extern "C" esp_err_t httpd_resp_send_chunk(httpd_req_t *, const char *, const ssize_t buf_len) {
+    sink_bytes += buf_len;
+    sink_chunks++;
+    return ESP_OK;
+}
+
+extern "C" esp_err_t httpd_resp_set_type(httpd_req_t *, const char *) { return ESP_OK; }
+
+extern "C" esp_err_t httpd_resp_set_status(httpd_req_t *, const char *) { return ESP_OK; }
+
+// ---- allocation counter ----
+
+static std::atomic<size_t> allocations{0};
+
+void *operator new(const size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+
+// ---- payloads, mirroring PumpStatus and TaskSample ----
+
+struct Status {
+    const char *mode;
+    uint8_t duty;
+    uint8_t output_duty;
+    bool dry;
+    float dry_threshold;
+    float dry_hysteresis;
+    uint32_t schedule_on_s;
+    uint32_t schedule_off_s;
+    uint32_t dry_trips;
+    uint32_t deadline_misses;
+};
+
+struct Task {
+    char name[16];
+    int core;
+    unsigned priority;
+    const char *state;
+    float cpu;
+    uint32_t stack_free;
+};
+
+template<>
+struct JsonSchema<Status> {
+    static constexpr auto fields = std::make_tuple(
+        json_field("mode", &Status::mode),
+        json_field("duty", &Status::duty),
+        json_field("output_duty", &Status::output_duty),
+        json_field("dry", &Status::dry),
+        json_field("dry_threshold", &Status::dry_threshold, 2),
+        json_field("dry_hysteresis", &Status::dry_hysteresis, 2),
+        json_field("schedule_on_s", &Status::schedule_on_s),
+        json_field("schedule_off_s", &Status::schedule_off_s),
+        json_field("dry_trips", &Status::dry_trips),
+        json_field("deadline_misses", &Status::deadline_misses));
+};
+
+template<>
+struct JsonSchema<Task> {
+    static constexpr auto fields = std::make_tuple(
+        json_field("name", &Task::name),
+        json_field("core", &Task::core),
+        json_field("priority", &Task::priority),
+        json_field("state", &Task::state),
+        json_field("cpu", &Task::cpu, 2),
+        json_field("stack_free", &Task::stack_free));
+};
+
+static constexpr size_t TASK_COUNT = 24;
+static volatile float weight = 1234.5678f;
+static Status status = {"schedule", 80, 64, false, 50.0f, 5.0f, 300, 900, 2, 0};
+static Task tasks[TASK_COUNT];
+static httpd_req_t req{};
+
+// ---- std::string, as /scale used to be written ----
+
+static void scale_string() {
+    const std::string resp = R"({"value": )" + std::to_string(weight) + "}";
+    httpd_resp_send(&req, resp.c_str(), static_cast<ssize_t>(resp.size()));
+}
+
+static void status_string() {
+    const Status &s = status;
+    const std::string resp = std::string(R"({"mode": ")") + s.mode + R"(", "duty": )" + std::to_string(s.duty) +
+                             R"(, "output_duty": )" + std::to_string(s.output_duty) +
+                             R"(, "dry": )" + (s.dry ? "true" : "false") +
+                             R"(, "dry_threshold": )" + std::to_string(s.dry_threshold) +
+                             R"(, "dry_hysteresis": )" + std::to_string(s.dry_hysteresis) +
+                             R"(, "schedule_on_s": )" + std::to_string(s.schedule_on_s) +
+                             R"(, "schedule_off_s": )" + std::to_string(s.schedule_off_s) +
+                             R"(, "dry_trips": )" + std::to_string(s.dry_trips) +
+                             R"(, "deadline_misses": )" + std::to_string(s.deadline_misses) + "}";
+    httpd_resp_send(&req, resp.c_str(), static_cast<ssize_t>(resp.size()));
+}
+
+static void tasks_string() {
+    std::string resp = R"({"tasks": [)";
+    for (size_t i = 0; i < TASK_COUNT; ++i) {
+        const Task &t = tasks[i];
+        resp += std::string(i ? ", " : "") + R"({"name": ")" + t.name + R"(", "core": )" + std::to_string(t.core) +
+                R"(, "priority": )" + std::to_string(t.priority) + R"(, "state": ")" + t.state +
+                R"(", "cpu": )" + std::to_string(t.cpu) + R"(, "stack_free": )" + std::to_string(t.stack_free) + "}";
+    }
+    resp += "]}";
+    httpd_resp_send(&req, resp.c_str(), static_cast<ssize_t>(resp.size()));
+}
+
+// ---- snprintf into stack or pooled buffers ----
+
+static void scale_snprintf() {
+    char resp[48];
+    snprintf(resp, sizeof(resp), R"({"value": %f})", static_cast<double>(weight));
+    httpd_resp_send(&req, resp, HTTPD_RESP_USE_STRLEN);
+}
+
+static void status_snprintf() {
+    const Status &s = status;
+    char resp[320];
+    snprintf(resp, sizeof(resp),
+             R"({"mode": "%s", "duty": %u, "output_duty": %u, "dry": %s, "dry_threshold": %.2f, )"
+             R"("dry_hysteresis": %.2f, "schedule_on_s": %)" PRIu32 R"(, "schedule_off_s": %)" PRIu32
+             R"(, "dry_trips": %)" PRIu32 R"(, "deadline_misses": %)" PRIu32 "}",
+             s.mode, s.duty, s.output_duty, s.dry ? "true" : "false",
+             static_cast<double>(s.dry_threshold), static_cast<double>(s.dry_hysteresis),
+             s.schedule_on_s, s.schedule_off_s, s.dry_trips, s.deadline_misses);
+    httpd_resp_send(&req, resp, HTTPD_RESP_USE_STRLEN);
+}
+
+static void tasks_snprintf() {
+    ResponseBuffer resp(&req);
+    resp.append(R"({"tasks": [)");
+    for (size_t i = 0; i < TASK_COUNT; ++i) {
+        const Task &t = tasks[i];
+        resp.appendf(R"(%s{"name": "%s", "core": %d, "priority": %u, "state": "%s", "cpu": %.2f, "stack_free": %)"
+                     PRIu32 "}",
+                     i ? ", " : "", t.name, t.core, t.priority, t.state, static_cast<double>(t.cpu), t.stack_free);
+    }
+    resp.append("]}");
+    resp.send();
+}
+
+// ---- JsonWriter ----
+
+static void scale_writer() {
+    ResponseBuffer resp(&req);
+    JsonWriter(resp).begin_object().field("value", json_fixed(weight, 3)).end_object();
+    resp.send();
+}
+
+static void status_writer() {
+    ResponseBuffer resp(&req);
+    JsonWriter(resp).object(status);
+    resp.send();
+}
+
+static void tasks_writer() {
+    ResponseBuffer resp(&req);
+    JsonWriter(resp).begin_object().key("tasks").array(tasks, TASK_COUNT).end_object();
+    resp.send();
+}
+
+// ---- runner ----
+
+/**
+ * @return Allocations per operation
+ */
+static double run(const char *name, void (*fn)(), const size_t iterations) {
+    for (size_t i = 0; i < iterations / 10; ++i) {
+        fn();
+    }
+    sink_bytes = 0;
+    sink_chunks = 0;
+    const size_t allocs_before = allocations.load();
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        fn();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    const double ns = std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations);
+    const double allocs = static_cast<double>(allocations.load() - allocs_before) / static_cast<double>(iterations);
+    printf("%-18s %10.1f %12.2f %10zu %8.2f\n", name, ns, allocs, sink_bytes / iterations,
+           static_cast<double>(sink_chunks) / static_cast<double>(iterations));
+    return allocs;
+}
+
+int main(const int argc, char **argv) {
+    const size_t iterations = argc > 1 ? strtoul(argv[1], nullptr, 10) : 200000;
+    static const char *states[] = {"running", "ready", "blocked", "suspended"};
+    for (size_t i = 0; i < TASK_COUNT; ++i) {
+        snprintf(tasks[i].name, sizeof(tasks[i].name), "task_%02zu", i);
+        tasks[i].core = static_cast<int>(i % 3) - 1;
+        tasks[i].priority = static_cast<unsigned>(i % 24);
+        tasks[i].state = states[i % 4];
+        tasks[i].cpu = static_cast<float>(i) * 1.37f;
+        tasks[i].stack_free = 1024 + static_cast<uint32_t>(i) * 96;
+    }
+
+    printf("%-18s %10s %12s %10s %8s\n", "case", "ns/op", "allocs/op", "bytes/op", "chunks");
+    run("scale/string", scale_string, iterations);
+    run("scale/snprintf", scale_snprintf, iterations);
+    double writer_allocs = run("scale/writer", scale_writer, iterations);
+    run("pump/string", status_string, iterations);
+    run("pump/snprintf", status_snprintf, iterations);
+    writer_allocs += run("pump/writer", status_writer, iterations);
+    run("tasks/string", tasks_string, iterations / 10);
+    run("tasks/snprintf", tasks_snprintf, iterations / 10);
+    writer_allocs += run("tasks/writer", tasks_writer, iterations / 10);
+    if (writer_allocs > 0) {
+        fprintf(stderr, "JsonWriter allocated on the response path\n");
+        return 1;
+    }
+    return 0;
+}
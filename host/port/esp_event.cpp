@@ -0,0 +1,200 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#include <esp_event.h>
+
+#include <condition_variable>
+#include <cstring>
+#include <esp_log.h>
+#include <freertos/task.h>
+#include <mutex>
+
+static auto TAG = "esp_event";
+
+static constexpr size_t MAX_LOOPS = 4;
+static constexpr size_t MAX_HANDLERS = 32;
+static constexpr size_t MAX_QUEUE = 32;
+static constexpr size_t MAX_EVENT_DATA = 128;
+
+struct Handler {
+    bool used;
+    esp_event_base_t base;
+    int32_t id;
+    esp_event_handler_t fn;
+    void *arg;
+};
+
+struct Event {
+    esp_event_base_t base;
+    int32_t id;
+    size_t size;
+    alignas(max_align_t) uint8_t data[MAX_EVENT_DATA];
+};
+
+struct esp_event_loop {
+    bool used;
+    std::mutex lock;
+    std::condition_variable changed;
+    Handler handlers[MAX_HANDLERS];
+    Event queue[MAX_QUEUE];
+    size_t capacity;
+    size_t head;
+    size_t count;
+    TaskHandle_t task;
+};
+
+static esp_event_loop loops[MAX_LOOPS];
+static esp_event_loop_handle_t default_loop = nullptr;
+static std::mutex loops_lock;
+
+[[noreturn]] static void run(void *arg) {
+    auto *loop = static_cast<esp_event_loop *>(arg);
+    for (;;) {
+        Event event;
+        {
+            std::unique_lock guard(loop->lock);
+            loop->changed.wait(guard, [loop] { return loop->count > 0; });
+            event = loop->queue[loop->head];
+            loop->head = (loop->head + 1) % loop->capacity;
+            loop->count--;
+        }
+        loop->changed.notify_all();
+
+        // Handlers may register or unregister others, dispatch from a copy of the table
+        Handler handlers[MAX_HANDLERS];
+        {
+            std::lock_guard guard(loop->lock);
+            memcpy(handlers, loop->handlers, sizeof(handlers));
+        }
+        for (const Handler &handler : handlers) {
+            if (handler.used && (handler.base == ESP_EVENT_ANY_BASE || handler.base == event.base ||
+                                 strcmp(handler.base, event.base) == 0) &&
+                (handler.id == ESP_EVENT_ANY_ID || handler.id == event.id)) {
+                handler.fn(handler.arg, event.base, event.id, event.size ? event.data : nullptr);
+            }
+        }
+    }
+}
+
+esp_err_t esp_event_loop_create(const esp_event_loop_args_t *args, esp_event_loop_handle_t *loop) {
+    if (!args || !loop || !args->task_name) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    std::lock_guard guard(loops_lock);
+    for (auto &candidate : loops) {
+        if (!candidate.used) {
+            candidate.used = true;
+            candidate.capacity = args->queue_size > 0 && static_cast<size_t>(args->queue_size) < MAX_QUEUE
+                                     ? static_cast<size_t>(args->queue_size)
+                                     : MAX_QUEUE;
+            xTaskCreatePinnedToCore(run, args->task_name, args->task_stack_size, &candidate, args->task_priority,
+                                    &candidate.task, args->task_core_id);
+            *loop = &candidate;
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+esp_err_t esp_event_loop_create_default() {
+    if (default_loop) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    constexpr esp_event_loop_args_t args = {
+        .queue_size = 32,
+        .task_name = "sys_evt",
+        .task_priority = 20,
+        .task_stack_size = 2304,
+        .task_core_id = 0,
+    };
+    return esp_event_loop_create(&args, &default_loop);
+}
+
+esp_err_t esp_event_post_to(esp_event_loop_handle_t loop, esp_event_base_t base, const int32_t id, const void *data,
+                            const size_t size, const TickType_t ticks) {
+    if (!loop || !base) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (size > MAX_EVENT_DATA) {
+        ESP_LOGE(TAG, "Event data of %zu bytes is larger than the host limit", size);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    {
+        std::unique_lock guard(loop->lock);
+        const auto has_room = [loop] { return loop->count < loop->capacity; };
+        if (ticks == portMAX_DELAY) {
+            loop->changed.wait(guard, has_room);
+        } else if (!loop->changed.wait_for(guard, std::chrono::milliseconds(ticks * portTICK_PERIOD_MS), has_room)) {
+            return ESP_ERR_TIMEOUT;
+        }
+        Event &event = loop->queue[(loop->head + loop->count) % loop->capacity];
+        event.base = base;
+        event.id = id;
+        event.size = data ? size : 0;
+        if (event.size) {
+            memcpy(event.data, data, size);
+        }
+        loop->count++;
+    }
+    loop->changed.notify_all();
+    return ESP_OK;
+}
+
+esp_err_t esp_event_post(esp_event_base_t base, const int32_t id, const void *data, const size_t size,
+                         const TickType_t ticks) {
+    return default_loop ? esp_event_post_to(default_loop, base, id, data, size, ticks) : ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t esp_event_handler_instance_register_with(esp_event_loop_handle_t loop, esp_event_base_t base,
+                                                   const int32_t id, const esp_event_handler_t handler, void *arg,
+                                                   esp_event_handler_instance_t *instance) {
+    if (!loop || !handler) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    std::lock_guard guard(loop->lock);
+    for (auto &slot : loop->handlers) {
+        if (!slot.used) {
+            slot = {.used = true, .base = base, .id = id, .fn = handler, .arg = arg};
+            if (instance) {
+                *instance = &slot;
+            }
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+esp_err_t esp_event_handler_register_with(esp_event_loop_handle_t loop, esp_event_base_t base, const int32_t id,
+                                          const esp_event_handler_t handler, void *arg) {
+    return esp_event_handler_instance_register_with(loop, base, id, handler, arg, nullptr);
+}
+
+esp_err_t esp_event_handler_instance_register(esp_event_base_t base, const int32_t id,
+                                              const esp_event_handler_t handler, void *arg,
+                                              esp_event_handler_instance_t *instance) {
+    return esp_event_handler_instance_register_with(default_loop, base, id, handler, arg, instance);
+}
+
+esp_err_t esp_event_handler_register(esp_event_base_t base, const int32_t id, const esp_event_handler_t handler,
+                                     void *arg) {
+    return esp_event_handler_instance_register_with(default_loop, base, id, handler, arg, nullptr);
+}
+
+esp_err_t esp_event_handler_instance_unregister_with(esp_event_loop_handle_t loop,
+                                                     [[maybe_unused]] esp_event_base_t base,
+                                                     [[maybe_unused]] int32_t id,
+                                                     esp_event_handler_instance_t instance) {
+    if (!loop || !instance) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    std::lock_guard guard(loop->lock);
+    static_cast<Handler *>(instance)->used = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_event_handler_instance_unregister(esp_event_base_t base, const int32_t id,
+                                                esp_event_handler_instance_t instance) {
+    return esp_event_handler_instance_unregister_with(default_loop, base, id, instance);
+}
@@ -0,0 +1,817 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#include <esp_http_server.h>
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <esp_log.h>
+#include <fcntl.h>
+#include <freertos/task.h>
+#include <mutex>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static auto TAG = "httpd";
+
+static constexpr size_t SESSION_BUFFER = 4096;
+static constexpr size_t MAX_RESP_HEADERS = 16;
+
+struct Session {
+    int fd;
+    uint64_t last_used;
+    size_t len;
+    std::atomic<bool> async{false}; ///< An async request owns the socket, the server task leaves it alone
+    bool resume;                    ///< Set with async cleared: serve the requests already buffered
+    bool close_pending;             ///< Set with async cleared: the async request ended the session
+    char buf[SESSION_BUFFER];
+};
+
+struct RespHeader {
+    const char *field;
+    const char *value;
+};
+
+struct httpd_req_aux {
+    Session *session;
+    size_t head_len;       ///< Request line and headers, including the blank line
+    size_t body_cursor;    ///< Next buffered body byte in session->buf
+    size_t body_end;       ///< End of the body bytes that arrived with the head
+    size_t remaining;      ///< Body bytes not handed to the handler yet
+    const char *status;
+    const char *content_type;
+    RespHeader headers[MAX_RESP_HEADERS];
+    size_t header_count;
+    size_t max_headers;
+    bool chunked;
+    bool keep_alive;
+    bool failed;
+    bool async;            ///< httpd_req_async_handler_begin() was called for this request
+};
+
+struct Server {
+    httpd_config_t config;
+    int listen_fd;
+    int wake[2];
+    std::atomic<bool> stopping;
+    std::atomic<bool> stopped;
+    std::mutex handlers_lock;
+    httpd_uri_t *handlers;
+    Session *sessions;
+    uint64_t lru_clock;
+};
+
+static uint16_t resolve_port(const uint16_t port) {
+    if (const char *env = getenv("SMART_FOUNTAIN_HTTP_PORT")) {
+        return static_cast<uint16_t>(strtoul(env, nullptr, 10));
+    }
+    return port < 1024 && geteuid() != 0 ? static_cast<uint16_t>(port + 8000) : port;
+}
+
+static void set_timeout(const int fd, const int option, const uint16_t seconds) {
+    const timeval tv = {.tv_sec = seconds, .tv_usec = 0};
+    setsockopt(fd, SOL_SOCKET, option, &tv, sizeof(tv));
+}
+
+static void close_session(Session &session) {
+    if (session.fd >= 0) {
+        close(session.fd);
+    }
+    session.fd = -1;
+    session.len = 0;
+}
+
+// ---- sending ----
+
+static bool send_all(httpd_req_aux *aux, iovec *iov, int count) {
+    if (aux->failed) {
+        return false;
+    }
+    while (count > 0) {
+        msghdr msg{};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = static_cast<size_t>(count);
+        const ssize_t sent = sendmsg(aux->session->fd, &msg, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            aux->failed = true;
+            return false;
+        }
+        auto left = static_cast<size_t>(sent);
+        while (count > 0 && left >= iov->iov_len) {
+            left -= iov->iov_len;
+            ++iov;
+            --count;
+        }
+        if (count > 0) {
+            iov->iov_base = static_cast<char *>(iov->iov_base) + left;
+            iov->iov_len -= left;
+        }
+    }
+    return true;
+}
+
+static int format_head(const httpd_req_aux *aux, char *head, const size_t size, const char *length_header) {
+    int n = snprintf(head, size, "HTTP/1.1 %s\r\nContent-Type: %s\r\n%s", aux->status, aux->content_type,
+                     length_header);
+    for (size_t i = 0; i < aux->header_count && n > 0 && static_cast<size_t>(n) < size; ++i) {
+        n += snprintf(head + n, size - n, "%s: %s\r\n", aux->headers[i].field, aux->headers[i].value);
+    }
+    if (n > 0 && static_cast<size_t>(n) < size) {
+        n += snprintf(head + n, size - n, "\r\n");
+    }
+    return n > 0 && static_cast<size_t>(n) < size ? n : -1;
+}
+
+esp_err_t httpd_resp_send(httpd_req_t *r, const char *buf, ssize_t buf_len) {
+    auto *aux = static_cast<httpd_req_aux *>(r->aux);
+    if (buf_len == HTTPD_RESP_USE_STRLEN) {
+        buf_len = buf ? static_cast<ssize_t>(strlen(buf)) : 0;
+    }
+    char length[48];
+    snprintf(length, sizeof(length), "Content-Length: %zd\r\n", buf_len);
+    char head[1024];
+    const int head_len = format_head(aux, head, sizeof(head), length);
+    if (head_len < 0) {
+        return ESP_ERR_HTTPD_RESP_HDR;
+    }
+    iovec iov[2] = {{head, static_cast<size_t>(head_len)}, {const_cast<char *>(buf), static_cast<size_t>(buf_len)}};
+    return send_all(aux, iov, buf_len > 0 ? 2 : 1) ? ESP_OK : ESP_ERR_HTTPD_RESP_SEND;
+}
+
+esp_err_t httpd_resp_send_chunk(httpd_req_t *r, const char *buf, ssize_t buf_len) {
+    auto *aux = static_cast<httpd_req_aux *>(r->aux);
+    if (buf_len == HTTPD_RESP_USE_STRLEN) {
+        buf_len = buf ? static_cast<ssize_t>(strlen(buf)) : 0;
+    }
+    char head[1024];
+    int head_len = 0;
+    if (!aux->chunked) {
+        head_len = format_head(aux, head, sizeof(head), "Transfer-Encoding: chunked\r\n");
+        if (head_len < 0) {
+            return ESP_ERR_HTTPD_RESP_HDR;
+        }
+        aux->chunked = true;
+    }
+    char size_line[16];
+    const int size_len = snprintf(size_line, sizeof(size_line), "%zx\r\n", buf_len);
+    iovec iov[4] = {
+        {head, static_cast<size_t>(head_len)},
+        {size_line, static_cast<size_t>(size_len)},
+        {const_cast<char *>(buf), static_cast<size_t>(buf_len)},
+        {const_cast<char *>("\r\n"), 2},
+    };
+    iovec *first = head_len > 0 ? iov : iov + 1;
+    return send_all(aux, first, static_cast<int>(iov + 4 - first)) ? ESP_OK : ESP_ERR_HTTPD_RESP_SEND;
+}
+
+esp_err_t httpd_resp_sendstr(httpd_req_t *r, const char *str) {
+    return httpd_resp_send(r, str, str ? HTTPD_RESP_USE_STRLEN : 0);
+}
+
+esp_err_t httpd_resp_sendstr_chunk(httpd_req_t *r, const char *str) {
+    return httpd_resp_send_chunk(r, str, str ? HTTPD_RESP_USE_STRLEN : 0);
+}
+
+esp_err_t httpd_resp_set_status(httpd_req_t *r, const char *status) {
+    static_cast<httpd_req_aux *>(r->aux)->status = status;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_type(httpd_req_t *r, const char *type) {
+    static_cast<httpd_req_aux *>(r->aux)->content_type = type;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_hdr(httpd_req_t *r, const char *field, const char *value) {
+    auto *aux = static_cast<httpd_req_aux *>(r->aux);
+    if (aux->header_count >= aux->max_headers) {
+        return ESP_ERR_HTTPD_RESP_HDR;
+    }
+    aux->headers[aux->header_count++] = {field, value};
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send_err(httpd_req_t *req, const httpd_err_code_t error, const char *msg) {
+    const char *status;
+    const char *text;
+    switch (error) {
+        case HTTPD_501_METHOD_NOT_IMPLEMENTED:
+            status = "501 Method Not Implemented";
+            text = "Server does not support this method";
+            break;
+        case HTTPD_505_VERSION_NOT_SUPPORTED:
+            status = "505 Version Not Supported";
+            text = "HTTP version not supported by server";
+            break;
+        case HTTPD_400_BAD_REQUEST:
+            status = "400 Bad Request";
+            text = "Bad request syntax";
+            break;
+        case HTTPD_401_UNAUTHORIZED:
+            status = "401 Unauthorized";
+            text = "No permission -- see authorization schemes";
+            break;
+        case HTTPD_403_FORBIDDEN:
+            status = "403 Forbidden";
+            text = "Request forbidden -- authorization will not help";
+            break;
+        case HTTPD_404_NOT_FOUND:
+            status = "404 Not Found";
+            text = "Nothing matches the given URI";
+            break;
+        case HTTPD_405_METHOD_NOT_ALLOWED:
+            status = "405 Method Not Allowed";
+            text = "Specified method is invalid for this resource";
+            break;
+        case HTTPD_408_REQ_TIMEOUT:
+            status = "408 Request Timeout";
+            text = "Server closed this connection";
+            break;
+        case HTTPD_411_LENGTH_REQUIRED:
+            status = "411 Length Required";
+            text = "Chunked encoding not supported by server";
+            break;
+        case HTTPD_414_URI_TOO_LONG:
+            status = "414 URI Too Long";
+            text = "URI is too long";
+            break;
+        case HTTPD_431_REQ_HDR_FIELDS_TOO_LARGE:
+            status = "431 Request Header Fields Too Large";
+            text = "Header fields are too long";
+            break;
+        default:
+            status = "500 Internal Server Error";
+            text = "Server has encountered an unexpected error";
+            break;
+    }
+    httpd_resp_set_status(req, status);
+    httpd_resp_set_type(req, HTTPD_TYPE_TEXT);
+    return httpd_resp_send(req, msg ? msg : text, HTTPD_RESP_USE_STRLEN);
+}
+
+// ---- receiving ----
+
+int httpd_req_recv(httpd_req_t *r, char *buf, size_t buf_len) {
+    auto *aux = static_cast<httpd_req_aux *>(r->aux);
+    if (aux->remaining == 0) {
+        return 0;
+    }
+    if (buf_len > aux->remaining) {
+        buf_len = aux->remaining;
+    }
+    if (aux->body_cursor < aux->body_end) {
+        const size_t n = std::min(buf_len, aux->body_end - aux->body_cursor);
+        memcpy(buf, aux->session->buf + aux->body_cursor, n);
+        aux->body_cursor += n;
+        aux->remaining -= n;
+        return static_cast<int>(n);
+    }
+    const ssize_t n = recv(aux->session->fd, buf, buf_len, 0);
+    if (n < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK ? HTTPD_SOCK_ERR_TIMEOUT : HTTPD_SOCK_ERR_FAIL;
+    }
+    if (n == 0) {
+        aux->failed = true;
+        return HTTPD_SOCK_ERR_FAIL;
+    }
+    aux->remaining -= static_cast<size_t>(n);
+    return static_cast<int>(n);
+}
+
+// Returns the value of a request header and its length, nullptr if absent
+static const char *find_header(const httpd_req_aux *aux, const char *field, size_t *len) {
+    const char *p = static_cast<const char *>(memchr(aux->session->buf, '\n', aux->head_len));
+    const char *end = aux->session->buf + aux->head_len;
+    const size_t field_len = strlen(field);
+    while (p && ++p < end) {
+        const char *eol = static_cast<const char *>(memchr(p, '\n', end - p));
+        if (!eol) {
+            break;
+        }
+        if (static_cast<size_t>(eol - p) > field_len && p[field_len] == ':' && strncasecmp(p, field, field_len) == 0) {
+            const char *value = p + field_len + 1;
+            while (value < eol && (*value == ' ' || *value == '\t')) {
+                ++value;
+            }
+            const char *value_end = eol;
+            while (value_end > value && (value_end[-1] == '\r' || value_end[-1] == ' ')) {
+                --value_end;
+            }
+            *len = static_cast<size_t>(value_end - value);
+            return value;
+        }
+        p = eol;
+    }
+    return nullptr;
+}
+
+size_t httpd_req_get_hdr_value_len(httpd_req_t *r, const char *field) {
+    size_t len = 0;
+    return find_header(static_cast<httpd_req_aux *>(r->aux), field, &len) ? len : 0;
+}
+
+esp_err_t httpd_req_get_hdr_value_str(httpd_req_t *r, const char *field, char *val, const size_t val_size) {
+    size_t len = 0;
+    const char *value = find_header(static_cast<httpd_req_aux *>(r->aux), field, &len);
+    if (!value) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (val_size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const size_t n = std::min(len, val_size - 1);
+    memcpy(val, value, n);
+    val[n] = '\0';
+    return n < len ? ESP_ERR_HTTPD_RESULT_TRUNC : ESP_OK;
+}
+
+size_t httpd_req_get_url_query_len(httpd_req_t *r) {
+    const char *query = strchr(r->uri, '?');
+    return query ? strlen(query + 1) : 0;
+}
+
+esp_err_t httpd_req_get_url_query_str(httpd_req_t *r, char *buf, const size_t buf_len) {
+    const char *query = strchr(r->uri, '?');
+    if (!query) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (buf_len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const size_t len = strlen(++query);
+    const size_t n = std::min(len, buf_len - 1);
+    memcpy(buf, query, n);
+    buf[n] = '\0';
+    return n < len ? ESP_ERR_HTTPD_RESULT_TRUNC : ESP_OK;
+}
+
+esp_err_t httpd_query_key_value(const char *qry, const char *key, char *val, const size_t val_size) {
+    const size_t key_len = strlen(key);
+    const char *p = qry;
+    while (p && *p) {
+        const char *next = strchr(p, '&');
+        const char *eq = strchr(p, '=');
+        if (eq && (!next || eq < next) && static_cast<size_t>(eq - p) == key_len && strncmp(p, key, key_len) == 0) {
+            const char *value = eq + 1;
+            const size_t len = next ? static_cast<size_t>(next - value) : strlen(value);
+            if (val_size == 0) {
+                return ESP_ERR_INVALID_ARG;
+            }
+            const size_t n = std::min(len, val_size - 1);
+            memcpy(val, value, n);
+            val[n] = '\0';
+            return n < len ? ESP_ERR_HTTPD_RESULT_TRUNC : ESP_OK;
+        }
+        p = next ? next + 1 : nullptr;
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+int httpd_req_to_sockfd(httpd_req_t *r) {
+    return r && r->aux ? static_cast<httpd_req_aux *>(r->aux)->session->fd : -1;
+}
+
+// ---- async requests ----
+
+namespace {
+    struct AsyncRequest {
+        httpd_req_t req;   ///< First member, httpd_req_async_handler_complete() gets this pointer back
+        httpd_req_aux aux;
+    };
+}
+
+// Drops the body the handler did not read, keeps pipelined bytes for the next request
+static bool finish_request(httpd_req_t *req) {
+    auto *aux = static_cast<httpd_req_aux *>(req->aux);
+    char sink[256];
+    while (aux->remaining > 0) {
+        if (httpd_req_recv(req, sink, sizeof(sink)) <= 0) {
+            return false;
+        }
+    }
+    Session &session = *aux->session;
+    const size_t consumed = aux->body_end;
+    memmove(session.buf, session.buf + consumed, session.len - consumed);
+    session.len -= consumed;
+    return true;
+}
+
+esp_err_t httpd_req_async_handler_begin(httpd_req_t *r, httpd_req_t **out) {
+    if (!r || !out) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    auto *aux = static_cast<httpd_req_aux *>(r->aux);
+    // Allocated like the device does, so HeapGuard sees the same allocations
+    auto *copy = new AsyncRequest{*r, *aux};
+    copy->req.aux = &copy->aux;
+    aux->async = true;
+    aux->session->async.store(true);
+    *out = &copy->req;
+    return ESP_OK;
+}
+
+esp_err_t httpd_req_async_handler_complete(httpd_req_t *r) {
+    if (!r) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    auto *copy = reinterpret_cast<AsyncRequest *>(r);
+    auto &server = *static_cast<Server *>(r->handle);
+    Session &session = *copy->aux.session;
+    const bool keep = copy->aux.keep_alive && !copy->aux.failed && finish_request(r);
+    session.resume = keep;
+    session.close_pending = !keep;
+    session.async.store(false);
+    delete copy;
+    // The server task polls the socket again from its next loop
+    const char wake = 0;
+    (void) write(server.wake[1], &wake, 1);
+    return ESP_OK;
+}
+
+// ---- request processing ----
+
+static int parse_method(const char *method, const size_t len) {
+    static constexpr struct {
+        const char *name;
+        httpd_method_t method;
+    } METHODS[] = {
+        {"GET", HTTP_GET}, {"POST", HTTP_POST}, {"PUT", HTTP_PUT}, {"DELETE", HTTP_DELETE},
+        {"HEAD", HTTP_HEAD}, {"OPTIONS", HTTP_OPTIONS}, {"PATCH", HTTP_PATCH},
+    };
+    for (const auto &m : METHODS) {
+        if (strlen(m.name) == len && strncmp(method, m.name, len) == 0) {
+            return m.method;
+        }
+    }
+    return -1;
+}
+
+// Reads until the request head is complete, returns its length, 0 if the peer closed and -1 on error
+static ssize_t read_head(Session &session) {
+    for (;;) {
+        if (const void *end = memmem(session.buf, session.len, "\r\n\r\n", 4)) {
+            return static_cast<const char *>(end) - session.buf + 4;
+        }
+        if (session.len == sizeof(session.buf)) {
+            return -1;
+        }
+        const ssize_t n = recv(session.fd, session.buf + session.len, sizeof(session.buf) - session.len, 0);
+        if (n == 0) {
+            return 0;
+        }
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        session.len += static_cast<size_t>(n);
+    }
+}
+
+// Handles one request, returns false if the session must be closed
+static bool process_request(Server &server, Session &session) {
+    const ssize_t head_len = read_head(session);
+    if (head_len <= 0) {
+        return false;
+    }
+
+    httpd_req_t req{};
+    httpd_req_aux aux{};
+    aux.session = &session;
+    aux.head_len = static_cast<size_t>(head_len);
+    aux.status = HTTPD_200;
+    aux.content_type = HTTPD_TYPE_TEXT;
+    aux.max_headers = std::min<size_t>(server.config.max_resp_headers, MAX_RESP_HEADERS);
+    aux.keep_alive = true;
+    req.handle = &server;
+    req.aux = &aux;
+
+    // Request line: METHOD SP URI SP VERSION CRLF
+    const char *line = session.buf;
+    const char *line_end = static_cast<const char *>(memchr(line, '\r', aux.head_len));
+    const char *sp1 = static_cast<const char *>(memchr(line, ' ', line_end - line));
+    const char *sp2 = sp1 ? static_cast<const char *>(memchr(sp1 + 1, ' ', line_end - sp1 - 1)) : nullptr;
+    bool ok = false;
+    if (!sp1 || !sp2) {
+        httpd_resp_send_err(&req, HTTPD_400_BAD_REQUEST, nullptr);
+    } else if ((req.method = parse_method(line, sp1 - line)) < 0) {
+        httpd_resp_send_err(&req, HTTPD_501_METHOD_NOT_IMPLEMENTED, nullptr);
+    } else if (static_cast<size_t>(sp2 - sp1 - 1) > HTTPD_MAX_URI_LEN) {
+        httpd_resp_send_err(&req, HTTPD_414_URI_TOO_LONG, nullptr);
+    } else {
+        ok = true;
+    }
+    if (!ok) {
+        return false;
+    }
+    memcpy(const_cast<char *>(req.uri), sp1 + 1, sp2 - sp1 - 1);
+    if (line_end - sp2 - 1 == 8 && strncmp(sp2 + 1, "HTTP/1.0", 8) == 0) {
+        aux.keep_alive = false;
+    }
+
+    char value[32];
+    if (httpd_req_get_hdr_value_str(&req, "Content-Length", value, sizeof(value)) == ESP_OK) {
+        req.content_len = strtoul(value, nullptr, 10);
+    }
+    if (httpd_req_get_hdr_value_str(&req, "Connection", value, sizeof(value)) == ESP_OK) {
+        if (strcasecmp(value, "close") == 0) {
+            aux.keep_alive = false;
+        } else if (strcasecmp(value, "keep-alive") == 0) {
+            aux.keep_alive = true;
+        }
+    }
+    aux.remaining = req.content_len;
+    aux.body_cursor = aux.head_len;
+    aux.body_end = aux.head_len + std::min(req.content_len, session.len - aux.head_len);
+
+    // Exact match on the path, the query string is ignored like httpd_uri_match_simple does
+    const size_t path_len = strcspn(req.uri, "?");
+    httpd_uri_t handler{};
+    bool path_found = false;
+    {
+        std::lock_guard guard(server.handlers_lock);
+        for (size_t i = 0; i < server.config.max_uri_handlers; ++i) {
+            const httpd_uri_t &candidate = server.handlers[i];
+            if (candidate.uri && strlen(candidate.uri) == path_len && strncmp(candidate.uri, req.uri, path_len) == 0) {
+                path_found = true;
+                if (candidate.method == req.method) {
+                    handler = candidate;
+                    break;
+                }
+            }
+        }
+    }
+
+    bool keep = false;
+    if (handler.handler) {
+        req.user_ctx = handler.user_ctx;
+        const esp_err_t err = handler.handler(&req);
+        keep = err == ESP_OK && aux.keep_alive;
+        if (err != ESP_OK) {
+            ESP_LOGD(TAG, "Handler for %s failed, closing the session", req.uri);
+        }
+    } else if (path_found) {
+        httpd_resp_send_err(&req, HTTPD_405_METHOD_NOT_ALLOWED, "Request method for this URI is not handled by server");
+    } else {
+        ESP_LOGW(TAG, "URI '%s' not found", req.uri);
+        httpd_resp_send_err(&req, HTTPD_404_NOT_FOUND, nullptr);
+    }
+    if (aux.async) {
+        // The async copy finishes the request, the session is idle until then
+        return true;
+    }
+    if (aux.failed || !keep) {
+        return false;
+    }
+    return finish_request(&req);
+}
+
+// ---- server task ----
+
+static void accept_session(Server &server) {
+    const int fd = accept4(server.listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+    Session *slot = nullptr;
+    Session *oldest = nullptr;
+    for (size_t i = 0; i < server.config.max_open_sockets; ++i) {
+        Session &session = server.sessions[i];
+        if (session.fd < 0) {
+            slot = &session;
+            break;
+        }
+        if (!session.async.load() && (!oldest || session.last_used < oldest->last_used)) {
+            oldest = &session;
+        }
+    }
+    if (!slot && server.config.lru_purge_enable && oldest) {
+        ESP_LOGD(TAG, "Purging least recently used session %d", oldest->fd);
+        close_session(*oldest);
+        slot = oldest;
+    }
+    if (!slot) {
+        close(fd);
+        return;
+    }
+    // Without this, Nagle and delayed ACKs add 40 ms to multi-write responses, lwIP does not show that stall
+    constexpr int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    set_timeout(fd, SO_RCVTIMEO, server.config.recv_wait_timeout);
+    set_timeout(fd, SO_SNDTIMEO, server.config.send_wait_timeout);
+    slot->fd = fd;
+    slot->len = 0;
+    slot->last_used = ++server.lru_clock;
+}
+
+// Serves every complete request already buffered, pipelined requests do not wait for poll
+static void serve(Server &server, Session &session) {
+    session.last_used = ++server.lru_clock;
+    bool alive = process_request(server, session);
+    while (alive && !session.async.load() && memmem(session.buf, session.len, "\r\n\r\n", 4)) {
+        alive = process_request(server, session);
+    }
+    if (!alive) {
+        close_session(session);
+    }
+}
+
+[[noreturn]] static void run(void *arg) {
+    auto &server = *static_cast<Server *>(arg);
+    const size_t max_sessions = server.config.max_open_sockets;
+    pollfd fds[2 + 64];
+    Session *owners[2 + 64];
+
+    while (!server.stopping.load()) {
+        size_t count = 0;
+        size_t open = 0;
+        fds[count++] = {server.wake[0], POLLIN, 0};
+        for (size_t i = 0; i < max_sessions; ++i) {
+            Session &session = server.sessions[i];
+            if (session.fd < 0) {
+                continue;
+            }
+            ++open;
+            if (session.async.load()) {
+                continue;
+            }
+            if (session.close_pending) {
+                session.close_pending = false;
+                close_session(session);
+                --open;
+                continue;
+            }
+            if (session.resume) {
+                session.resume = false;
+                if (memmem(session.buf, session.len, "\r\n\r\n", 4)) {
+                    serve(server, session);
+                    if (session.fd < 0) {
+                        --open;
+                        continue;
+                    }
+                    if (session.async.load()) {
+                        continue;
+                    }
+                }
+            }
+            owners[count] = &session;
+            fds[count++] = {session.fd, POLLIN, 0};
+        }
+        // Like the device, new connections wait in the backlog while every session is taken
+        const bool can_accept = open < max_sessions || server.config.lru_purge_enable;
+        const size_t listen_index = count;
+        if (can_accept) {
+            fds[count++] = {server.listen_fd, POLLIN, 0};
+        }
+
+        if (poll(fds, count, -1) < 0) {
+            continue;
+        }
+        if (fds[0].revents & POLLIN) {
+            char drain[64];
+            while (read(server.wake[0], drain, sizeof(drain)) > 0) {
+            }
+        }
+        for (size_t i = 1; i < listen_index; ++i) {
+            if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+                serve(server, *owners[i]);
+            }
+        }
+        if (can_accept && (fds[listen_index].revents & POLLIN)) {
+            accept_session(server);
+        }
+    }
+
+    for (size_t i = 0; i < max_sessions; ++i) {
+        close_session(server.sessions[i]);
+    }
+    close(server.listen_fd);
+    server.stopped.store(true);
+    vTaskDelete(nullptr);
+    abort();
+}
+
+esp_err_t httpd_start(httpd_handle_t *handle, const httpd_config_t *config) {
+    if (!handle || !config || config->max_open_sockets == 0 || config->max_open_sockets > 64) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    auto *server = new Server();
+    server->config = *config;
+    server->handlers = new httpd_uri_t[config->max_uri_handlers]();
+    server->sessions = new Session[config->max_open_sockets];
+    for (size_t i = 0; i < config->max_open_sockets; ++i) {
+        server->sessions[i].fd = -1;
+        server->sessions[i].len = 0;
+        server->sessions[i].resume = false;
+        server->sessions[i].close_pending = false;
+    }
+
+    const uint16_t port = resolve_port(config->server_port);
+    server->listen_fd = socket(AF_INET6, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    constexpr int one = 1;
+    constexpr int zero = 0;
+    setsockopt(server->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    setsockopt(server->listen_fd, IPPROTO_IPV6, IPV6_V6ONLY, &zero, sizeof(zero));
+    sockaddr_in6 addr{};
+    addr.sin6_family = AF_INET6;
+    addr.sin6_addr = in6addr_any;
+    addr.sin6_port = htons(port);
+    if (server->listen_fd < 0 || bind(server->listen_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 ||
+        listen(server->listen_fd, config->backlog_conn) != 0 || pipe2(server->wake, O_CLOEXEC | O_NONBLOCK) != 0) {
+        ESP_LOGE(TAG, "Cannot listen on port %u: %s", port, strerror(errno));
+        if (server->listen_fd >= 0) {
+            close(server->listen_fd);
+        }
+        delete[] server->sessions;
+        delete[] server->handlers;
+        delete server;
+        return ESP_ERR_HTTPD_TASK;
+    }
+
+    if (xTaskCreatePinnedToCore(run, "httpd", static_cast<uint32_t>(config->stack_size), server,
+                                config->task_priority, nullptr, config->core_id) != pdPASS) {
+        close(server->listen_fd);
+        return ESP_ERR_HTTPD_TASK;
+    }
+    ESP_LOGI(TAG, "Listening on port %u", port);
+    *handle = server;
+    return ESP_OK;
+}
+
+esp_err_t httpd_stop(httpd_handle_t handle) {
+    auto *server = static_cast<Server *>(handle);
+    if (!server) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    server->stopping.store(true);
+    const char wake = 0;
+    (void) write(server->wake[1], &wake, 1);
+    while (!server->stopped.load()) {
+        vTaskDelay(1);
+    }
+    close(server->wake[0]);
+    close(server->wake[1]);
+    for (size_t i = 0; i < server->config.max_uri_handlers; ++i) {
+        free(const_cast<char *>(server->handlers[i].uri));
+    }
+    delete[] server->sessions;
+    delete[] server->handlers;
+    delete server;
+    return ESP_OK;
+}
+
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t *uri_handler) {
+    auto *server = static_cast<Server *>(handle);
+    if (!server || !uri_handler || !uri_handler->uri) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    std::lock_guard guard(server->handlers_lock);
+    httpd_uri_t *free_slot = nullptr;
+    for (size_t i = 0; i < server->config.max_uri_handlers; ++i) {
+        httpd_uri_t &slot = server->handlers[i];
+        if (!slot.uri) {
+            free_slot = free_slot ? free_slot : &slot;
+        } else if (slot.method == uri_handler->method && strcmp(slot.uri, uri_handler->uri) == 0) {
+            ESP_LOGW(TAG, "Handler %s already registered", uri_handler->uri);
+            return ESP_ERR_HTTPD_HANDLER_EXISTS;
+        }
+    }
+    if (!free_slot) {
+        ESP_LOGW(TAG, "No slots left for registering handler %s", uri_handler->uri);
+        return ESP_ERR_HTTPD_HANDLERS_FULL;
+    }
+    *free_slot = *uri_handler;
+    free_slot->uri = strdup(uri_handler->uri);
+    return ESP_OK;
+}
+
+esp_err_t httpd_unregister_uri_handler(httpd_handle_t handle, const char *uri, const httpd_method_t method) {
+    auto *server = static_cast<Server *>(handle);
+    if (!server || !uri) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    std::lock_guard guard(server->handlers_lock);
+    for (size_t i = 0; i < server->config.max_uri_handlers; ++i) {
+        httpd_uri_t &slot = server->handlers[i];
+        if (slot.uri && slot.method == method && strcmp(slot.uri, uri) == 0) {
+            free(const_cast<char *>(slot.uri));
+            slot = {};
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
@@ -0,0 +1,150 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#include <esp_timer.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <esp_log.h>
+#include <esp_rom_sys.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <mutex>
+
+static auto TAG = "esp_timer";
+
+static constexpr size_t MAX_TIMERS = 32;
+
+struct esp_timer {
+    esp_timer_create_args_t args;
+    bool used;
+    bool active;
+    int64_t next_us;
+    uint64_t period_us; ///< 0 for one-shot timers
+};
+
+static const auto boot = std::chrono::steady_clock::now();
+static esp_timer timers[MAX_TIMERS];
+static std::mutex lock;
+static std::condition_variable changed;
+static TaskHandle_t task = nullptr;
+
+int64_t esp_timer_get_time() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - boot).count();
+}
+
+void esp_rom_delay_us(const uint32_t us) {
+    const int64_t until = esp_timer_get_time() + us;
+    while (esp_timer_get_time() < until) {
+    }
+}
+
+[[noreturn]] static void run([[maybe_unused]] void *arg) {
+    std::unique_lock guard(lock);
+    for (;;) {
+        esp_timer *due = nullptr;
+        for (auto &timer : timers) {
+            if (timer.used && timer.active && (!due || timer.next_us < due->next_us)) {
+                due = &timer;
+            }
+        }
+        if (!due) {
+            changed.wait(guard);
+            continue;
+        }
+        const int64_t now_us = esp_timer_get_time();
+        if (due->next_us > now_us) {
+            changed.wait_for(guard, std::chrono::microseconds(due->next_us - now_us));
+            continue;
+        }
+
+        if (due->period_us == 0) {
+            due->active = false;
+        } else {
+            due->next_us += static_cast<int64_t>(due->period_us);
+            if (due->args.skip_unhandled_events && due->next_us <= now_us) {
+                due->next_us = now_us + static_cast<int64_t>(due->period_us);
+            }
+        }
+        const esp_timer_cb_t callback = due->args.callback;
+        void *callback_arg = due->args.arg;
+        guard.unlock();
+        callback(callback_arg);
+        guard.lock();
+    }
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out_handle) {
+    if (!args || !args->callback || !out_handle) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    std::lock_guard guard(lock);
+    if (!task) {
+        xTaskCreatePinnedToCore(run, "esp_timer", 4096, nullptr, 22, &task, 0);
+    }
+    for (auto &timer : timers) {
+        if (!timer.used) {
+            timer = {.args = *args, .used = true, .active = false, .next_us = 0, .period_us = 0};
+            *out_handle = &timer;
+            return ESP_OK;
+        }
+    }
+    ESP_LOGE(TAG, "Timer table full");
+    return ESP_ERR_NO_MEM;
+}
+
+static esp_err_t start(esp_timer_handle_t timer, const uint64_t timeout_us, const uint64_t period_us) {
+    if (!timer) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    {
+        std::lock_guard guard(lock);
+        if (timer->active) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        timer->active = true;
+        timer->next_us = esp_timer_get_time() + static_cast<int64_t>(timeout_us);
+        timer->period_us = period_us;
+    }
+    changed.notify_one();
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, const uint64_t timeout_us) {
+    return start(timer, timeout_us, 0);
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, const uint64_t period_us) {
+    return start(timer, period_us, period_us);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    if (!timer) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    std::lock_guard guard(lock);
+    if (!timer->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->active = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    if (!timer) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    std::lock_guard guard(lock);
+    if (timer->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->used = false;
+    return ESP_OK;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer) {
+    std::lock_guard guard(lock);
+    return timer && timer->active;
+}
@@ -0,0 +1,351 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <condition_variable>
+#include <cstring>
+#include <ctime>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <mutex>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <thread>
+
+static auto TAG = "freertos";
+
+// Host stacks are larger than on the device, x86-64 frames and glibc need more room than Xtensa ones
+static constexpr size_t HOST_STACK_SCALE = 8;
+static constexpr size_t HOST_STACK_MIN = 256 * 1024;
+static constexpr uint8_t STACK_PAINT = 0xA5;
+static constexpr size_t MAX_TASKS = 64;
+
+struct tskTaskControlBlock {
+    char name[configMAX_TASK_NAME_LEN];
+    TaskFunction_t fn;
+    void *arg;
+    UBaseType_t priority;
+    BaseType_t core;
+    UBaseType_t number;
+    bool idle;
+    bool foreign; ///< Host thread not created through xTaskCreate, hidden from the system state
+    std::atomic<eTaskState> state;
+    std::atomic<bool> has_clock;
+    clockid_t cpu_clock;
+    uint8_t *stack;
+    size_t stack_size;
+    std::mutex notify_lock;
+    std::condition_variable notify_cv;
+    uint32_t notify_value;
+};
+
+// Tasks live in a static table: xTaskGetCurrentTaskHandle runs inside the heap hooks and must not allocate
+static tskTaskControlBlock tasks[MAX_TASKS];
+static std::atomic<size_t> task_count{0};
+static tskTaskControlBlock *idle_tasks[portNUM_PROCESSORS];
+static thread_local tskTaskControlBlock *current_task = nullptr;
+
+static tskTaskControlBlock *new_task(const char *name, const UBaseType_t priority, const BaseType_t core) {
+    const size_t index = task_count.fetch_add(1);
+    if (index >= MAX_TASKS) {
+        ESP_LOGE(TAG, "Task table full, cannot create %s", name);
+        abort();
+    }
+    tskTaskControlBlock *task = &tasks[index];
+    snprintf(task->name, sizeof(task->name), "%s", name ? name : "");
+    task->priority = priority;
+    task->core = core;
+    task->number = static_cast<UBaseType_t>(index + 1);
+    task->state.store(eReady);
+    return task;
+}
+
+static void bind_current(tskTaskControlBlock *task) {
+    current_task = task;
+    if (pthread_getcpuclockid(pthread_self(), &task->cpu_clock) == 0) {
+        task->has_clock.store(true);
+    }
+    pthread_setname_np(pthread_self(), task->name);
+    task->state.store(eRunning);
+}
+
+static void *task_main(void *arg) {
+    auto *task = static_cast<tskTaskControlBlock *>(arg);
+    bind_current(task);
+    task->fn(task->arg);
+    // Returning from a FreeRTOS task is a bug on the device, mirror the abort
+    ESP_LOGE(TAG, "Task %s returned", task->name);
+    abort();
+}
+
+static uint64_t cpu_time_us(const tskTaskControlBlock &task) {
+    timespec ts{};
+    if (!task.has_clock.load() || clock_gettime(task.cpu_clock, &ts) != 0) {
+        return 0;
+    }
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void ensure_idle_tasks() {
+    static std::once_flag once;
+    std::call_once(once, [] {
+        for (BaseType_t c = 0; c < portNUM_PROCESSORS; ++c) {
+            char name[configMAX_TASK_NAME_LEN];
+            snprintf(name, sizeof(name), "IDLE%d", static_cast<int>(c));
+            idle_tasks[c] = new_task(name, 0, c);
+            idle_tasks[c]->idle = true;
+        }
+    });
+}
+
+void vPortEnterCritical(portMUX_TYPE *mux) {
+    // Any per-thread address identifies the owner, the current task handle may not exist yet
+    static thread_local char token;
+    void *self = &token;
+    if (mux->owner.load(std::memory_order_acquire) == self) {
+        mux->count++;
+        return;
+    }
+    void *expected = nullptr;
+    while (!mux->owner.compare_exchange_weak(expected, self, std::memory_order_acquire)) {
+        expected = nullptr;
+        sched_yield();
+    }
+    mux->count = 1;
+}
+
+void vPortExitCritical(portMUX_TYPE *mux) {
+    if (--mux->count == 0) {
+        mux->owner.store(nullptr, std::memory_order_release);
+    }
+}
+
+BaseType_t xTaskCreatePinnedToCore(const TaskFunction_t fn, const char *name, const uint32_t stack_depth, void *arg,
+                                   const UBaseType_t priority, TaskHandle_t *created, const BaseType_t core_id) {
+    ensure_idle_tasks();
+    tskTaskControlBlock *task = new_task(name, priority, core_id);
+    task->fn = fn;
+    task->arg = arg;
+    task->stack_size = std::max(static_cast<size_t>(stack_depth) * HOST_STACK_SCALE, HOST_STACK_MIN);
+    void *stack = mmap(nullptr, task->stack_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (stack == MAP_FAILED) {
+        ESP_LOGE(TAG, "Cannot map stack for %s", name);
+        return pdFAIL;
+    }
+    task->stack = static_cast<uint8_t *>(stack);
+    memset(task->stack, STACK_PAINT, task->stack_size);
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstack(&attr, task->stack, task->stack_size);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    pthread_t thread;
+    const int err = pthread_create(&thread, &attr, task_main, task);
+    pthread_attr_destroy(&attr);
+    if (err != 0) {
+        ESP_LOGE(TAG, "Cannot start %s: %s", name, strerror(err));
+        return pdFAIL;
+    }
+    if (created) {
+        *created = task;
+    }
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    tskTaskControlBlock *self = xTaskGetCurrentTaskHandle();
+    if (task && task != self) {
+        ESP_LOGE(TAG, "Deleting another task is not supported on the host");
+        abort();
+    }
+    self->has_clock.store(false);
+    self->state.store(eDeleted);
+    pthread_exit(nullptr);
+}
+
+static void block_for(const TickType_t ticks) {
+    tskTaskControlBlock *self = xTaskGetCurrentTaskHandle();
+    self->state.store(eBlocked);
+    if (ticks == portMAX_DELAY) {
+        for (;;) {
+            pause();
+        }
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(static_cast<uint64_t>(ticks) * 1000000 / configTICK_RATE_HZ));
+    self->state.store(eRunning);
+}
+
+void vTaskDelay(const TickType_t ticks) {
+    if (ticks == 0) {
+        sched_yield();
+        return;
+    }
+    block_for(ticks);
+}
+
+BaseType_t xTaskDelayUntil(TickType_t *previous_wake, const TickType_t increment) {
+    const TickType_t wake = *previous_wake + increment;
+    *previous_wake = wake;
+    const auto remaining = static_cast<int32_t>(wake - xTaskGetTickCount());
+    if (remaining <= 0) {
+        return pdFALSE;
+    }
+    block_for(static_cast<TickType_t>(remaining));
+    return pdTRUE;
+}
+
+TickType_t xTaskGetTickCount() {
+    return static_cast<TickType_t>(esp_timer_get_time() * configTICK_RATE_HZ / 1000000);
+}
+
+BaseType_t xPortGetCoreID() {
+    const BaseType_t core = xTaskGetCurrentTaskHandle()->core;
+    if (core != tskNO_AFFINITY) {
+        return core;
+    }
+    const int cpu = sched_getcpu();
+    return cpu > 0 ? cpu % portNUM_PROCESSORS : 0;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    if (!current_task) {
+        char name[configMAX_TASK_NAME_LEN] = "thread";
+        pthread_getname_np(pthread_self(), name, sizeof(name));
+        tskTaskControlBlock *task = new_task(name, 1, tskNO_AFFINITY);
+        task->foreign = true;
+        bind_current(task);
+    }
+    return current_task;
+}
+
+char *pcTaskGetName(TaskHandle_t task) {
+    return (task ? task : xTaskGetCurrentTaskHandle())->name;
+}
+
+BaseType_t xTaskGetCoreID(TaskHandle_t task) {
+    return (task ? task : xTaskGetCurrentTaskHandle())->core;
+}
+
+TaskHandle_t xTaskGetIdleTaskHandleForCore(const BaseType_t core_id) {
+    ensure_idle_tasks();
+    return core_id >= 0 && core_id < portNUM_PROCESSORS ? idle_tasks[core_id] : nullptr;
+}
+
+UBaseType_t uxTaskGetNumberOfTasks() {
+    ensure_idle_tasks();
+    UBaseType_t count = 0;
+    for (size_t i = 0; i < std::min(task_count.load(), MAX_TASKS); ++i) {
+        count += tasks[i].state.load() != eDeleted && !tasks[i].foreign;
+    }
+    return count;
+}
+
+UBaseType_t uxTaskGetSystemState(TaskStatus_t *out, const UBaseType_t size,
+                                 configRUN_TIME_COUNTER_TYPE *total_run_time) {
+    ensure_idle_tasks();
+    const size_t count = std::min(task_count.load(), MAX_TASKS);
+    if (uxTaskGetNumberOfTasks() > size) {
+        return 0;
+    }
+
+    // Idle time of a core is whatever its pinned tasks did not use, unpinned tasks are split evenly
+    const auto now_us = static_cast<uint64_t>(esp_timer_get_time());
+    uint64_t busy_us[portNUM_PROCESSORS] = {};
+    UBaseType_t n = 0;
+    for (size_t i = 0; i < count; ++i) {
+        tskTaskControlBlock &task = tasks[i];
+        if (task.idle || task.foreign || task.state.load() == eDeleted) {
+            continue;
+        }
+        const uint64_t used = cpu_time_us(task);
+        for (BaseType_t c = 0; c < portNUM_PROCESSORS; ++c) {
+            if (task.core == c) {
+                busy_us[c] += used;
+            } else if (task.core == tskNO_AFFINITY) {
+                busy_us[c] += used / portNUM_PROCESSORS;
+            }
+        }
+        out[n++] = {
+            .xHandle = &task,
+            .pcTaskName = task.name,
+            .xTaskNumber = task.number,
+            .eCurrentState = task.state.load(),
+            .uxCurrentPriority = task.priority,
+            .uxBasePriority = task.priority,
+            .ulRunTimeCounter = static_cast<configRUN_TIME_COUNTER_TYPE>(used),
+            .pxStackBase = task.stack,
+            .usStackHighWaterMark = static_cast<uint32_t>(uxTaskGetStackHighWaterMark(&task)),
+            .xCoreID = task.core,
+        };
+    }
+    for (BaseType_t c = 0; c < portNUM_PROCESSORS; ++c) {
+        tskTaskControlBlock &idle = *idle_tasks[c];
+        out[n++] = {
+            .xHandle = &idle,
+            .pcTaskName = idle.name,
+            .xTaskNumber = idle.number,
+            .eCurrentState = eReady,
+            .uxCurrentPriority = 0,
+            .uxBasePriority = 0,
+            .ulRunTimeCounter = static_cast<configRUN_TIME_COUNTER_TYPE>(now_us > busy_us[c] ? now_us - busy_us[c] : 0),
+            .pxStackBase = nullptr,
+            .usStackHighWaterMark = 0,
+            .xCoreID = c,
+        };
+    }
+    if (total_run_time) {
+        *total_run_time = static_cast<configRUN_TIME_COUNTER_TYPE>(now_us);
+    }
+    return n;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+    const tskTaskControlBlock *t = task ? task : xTaskGetCurrentTaskHandle();
+    if (!t->stack) {
+        return 0;
+    }
+    // Stacks grow down, count the painted bytes left at the bottom
+    size_t untouched = 0;
+    while (untouched < t->stack_size && t->stack[untouched] == STACK_PAINT) {
+        ++untouched;
+    }
+    return static_cast<UBaseType_t>(untouched);
+}
+
+uint32_t ulTaskNotifyTake(const BaseType_t clear_on_exit, const TickType_t ticks_to_wait) {
+    tskTaskControlBlock *self = xTaskGetCurrentTaskHandle();
+    std::unique_lock lock(self->notify_lock);
+    if (self->notify_value == 0 && ticks_to_wait > 0) {
+        self->state.store(eBlocked);
+        const auto ready = [self] { return self->notify_value > 0; };
+        if (ticks_to_wait == portMAX_DELAY) {
+            self->notify_cv.wait(lock, ready);
+        } else {
+            self->notify_cv.wait_for(lock, std::chrono::microseconds(
+                                         static_cast<uint64_t>(ticks_to_wait) * 1000000 / configTICK_RATE_HZ), ready);
+        }
+        self->state.store(eRunning);
+    }
+    const uint32_t value = self->notify_value;
+    if (value > 0) {
+        self->notify_value = clear_on_exit ? 0 : value - 1;
+    }
+    return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    {
+        std::lock_guard lock(task->notify_lock);
+        task->notify_value++;
+    }
+    task->notify_cv.notify_one();
+    return pdPASS;
+}
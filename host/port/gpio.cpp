@@ -0,0 +1,140 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#include <driver/gpio.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <esp_timer.h>
+#include <host/hx711_sim.h>
+#include <mutex>
+
+static std::atomic<uint8_t> levels[GPIO_NUM_MAX];
+
+struct Hx711Sim {
+    bool attached = false;
+    gpio_num_t clk = GPIO_NUM_NC;
+    gpio_num_t dout = GPIO_NUM_NC;
+    Hx711SimConfig config;
+    std::atomic<float> weight_g{0.0f};
+    std::atomic<bool> stalled{false};
+    std::mutex lock;
+    int64_t next_ready_us = 0;
+    int pulses = 0;        ///< Rising edges since the read started, 0 when idle
+    uint32_t sample = 0;   ///< 24-bit two's complement word being shifted out
+    uint64_t rng = 0x2545F4914F6CDD1DULL;
+};
+
+static Hx711Sim sim;
+
+// xorshift64* and Box-Muller, no allocation and reproducible runs
+static float gaussian() {
+    auto next = [] {
+        sim.rng ^= sim.rng >> 12;
+        sim.rng ^= sim.rng << 25;
+        sim.rng ^= sim.rng >> 27;
+        return static_cast<float>((sim.rng * 0x2545F4914F6CDD1DULL) >> 40) / static_cast<float>(1 << 24);
+    };
+    const float u1 = next() + 1e-7f;
+    const float u2 = next();
+    return std::sqrt(-2.0f * std::log(u1)) * std::cos(6.2831853f * u2);
+}
+
+static int64_t period_us() {
+    return static_cast<int64_t>(1000000.0f / sim.config.samples_per_second);
+}
+
+static bool conversion_ready(const int64_t now_us) {
+    return sim.pulses == 0 && !sim.stalled.load() && now_us >= sim.next_ready_us;
+}
+
+static void clock_rising_edge() {
+    const int64_t now_us = esp_timer_get_time();
+    if (sim.pulses == 0) {
+        if (!conversion_ready(now_us)) {
+            return;
+        }
+        const float counts = static_cast<float>(sim.config.offset_counts) +
+                             sim.weight_g.load() * sim.config.counts_per_gram + sim.config.noise_counts * gaussian();
+        auto value = static_cast<int32_t>(std::lround(counts));
+        value = std::clamp(value, -0x800000, 0x7FFFFF);
+        sim.sample = static_cast<uint32_t>(value) & 0xFFFFFF;
+    }
+    ++sim.pulses;
+    if (sim.pulses <= 24) {
+        levels[sim.dout].store((sim.sample >> (24 - sim.pulses)) & 1);
+    } else {
+        // Gain pulses, DOUT stays high until the next conversion completes
+        levels[sim.dout].store(1);
+        if (sim.pulses == 25) {
+            sim.next_ready_us = now_us + period_us();
+        }
+    }
+}
+
+void hx711_sim_attach(const gpio_num_t clk, const gpio_num_t dout, const Hx711SimConfig &config) {
+    std::lock_guard guard(sim.lock);
+    sim.attached = true;
+    sim.clk = clk;
+    sim.dout = dout;
+    sim.config = config;
+    sim.weight_g.store(config.weight_g);
+    sim.next_ready_us = esp_timer_get_time() + period_us();
+    levels[dout].store(1);
+}
+
+void hx711_sim_set_weight(const float grams) {
+    sim.weight_g.store(grams);
+}
+
+float hx711_sim_weight() {
+    return sim.weight_g.load();
+}
+
+void hx711_sim_set_stalled(const bool stalled) {
+    sim.stalled.store(stalled);
+}
+
+esp_err_t gpio_config(const gpio_config_t *config) {
+    return config ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t gpio_reset_pin(const gpio_num_t gpio_num) {
+    return gpio_set_level(gpio_num, 0);
+}
+
+esp_err_t gpio_set_direction([[maybe_unused]] gpio_num_t gpio_num, [[maybe_unused]] gpio_mode_t mode) {
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level(const gpio_num_t gpio_num, const uint32_t level) {
+    if (gpio_num < 0 || gpio_num >= GPIO_NUM_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const uint8_t previous = levels[gpio_num].exchange(level ? 1 : 0);
+    if (sim.attached && gpio_num == sim.clk) {
+        std::lock_guard guard(sim.lock);
+        if (!previous && level) {
+            clock_rising_edge();
+        } else if (previous && !level && sim.pulses > 24) {
+            sim.pulses = 0;
+        }
+    }
+    return ESP_OK;
+}
+
+int gpio_get_level(const gpio_num_t gpio_num) {
+    if (gpio_num < 0 || gpio_num >= GPIO_NUM_MAX) {
+        return 0;
+    }
+    if (sim.attached && gpio_num == sim.dout) {
+        std::lock_guard guard(sim.lock);
+        if (sim.pulses == 0) {
+            return conversion_ready(esp_timer_get_time()) ? 0 : 1;
+        }
+    }
+    return levels[gpio_num].load();
+}
@@ -0,0 +1,95 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#include <esp_heap_caps.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <malloc.h>
+#include <new>
+
+#include "sdkconfig.h"
+
+// Internal RAM left for the heap on an ESP32-S3 once the app is loaded
+static constexpr size_t HEAP_SIZE = 320 * 1024;
+
+static std::atomic<size_t> allocated{0};
+static std::atomic<size_t> peak{0};
+
+#if CONFIG_HEAP_USE_HOOKS
+extern "C" void esp_heap_trace_alloc_hook(void *ptr, size_t size, uint32_t caps);
+
+extern "C" void esp_heap_trace_free_hook(void *ptr);
+#endif
+
+void *heap_caps_malloc(const size_t size, const uint32_t caps) {
+    void *ptr = malloc(size ? size : 1);
+    if (!ptr) {
+        return nullptr;
+    }
+    const size_t now = allocated.fetch_add(malloc_usable_size(ptr)) + malloc_usable_size(ptr);
+    size_t seen = peak.load(std::memory_order_relaxed);
+    while (now > seen && !peak.compare_exchange_weak(seen, now)) {
+    }
+#if CONFIG_HEAP_USE_HOOKS
+    esp_heap_trace_alloc_hook(ptr, size, caps);
+#endif
+    return ptr;
+}
+
+void heap_caps_free(void *ptr) {
+    if (!ptr) {
+        return;
+    }
+#if CONFIG_HEAP_USE_HOOKS
+    esp_heap_trace_free_hook(ptr);
+#endif
+    allocated.fetch_sub(malloc_usable_size(ptr));
+    free(ptr);
+}
+
+size_t heap_caps_get_free_size([[maybe_unused]] uint32_t caps) {
+    const size_t used = allocated.load();
+    return used < HEAP_SIZE ? HEAP_SIZE - used : 0;
+}
+
+size_t heap_caps_get_minimum_free_size([[maybe_unused]] uint32_t caps) {
+    const size_t used = peak.load();
+    return used < HEAP_SIZE ? HEAP_SIZE - used : 0;
+}
+
+size_t heap_caps_get_largest_free_block(const uint32_t caps) {
+    // glibc does not fragment a region this small in a meaningful way
+    return heap_caps_get_free_size(caps);
+}
+
+// C++ allocations go through the same path as on the device, where operator new calls heap_caps_malloc
+
+void *operator new(const size_t size) {
+    if (void *ptr = heap_caps_malloc(size, MALLOC_CAP_DEFAULT)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](const size_t size) {
+    return operator new(size);
+}
+
+void *operator new(const size_t size, const std::nothrow_t &) noexcept {
+    return heap_caps_malloc(size, MALLOC_CAP_DEFAULT);
+}
+
+void *operator new[](const size_t size, const std::nothrow_t &) noexcept {
+    return heap_caps_malloc(size, MALLOC_CAP_DEFAULT);
+}
+
+void operator delete(void *ptr) noexcept { heap_caps_free(ptr); }
+
+void operator delete[](void *ptr) noexcept { heap_caps_free(ptr); }
+
+void operator delete(void *ptr, size_t) noexcept { heap_caps_free(ptr); }
+
+void operator delete[](void *ptr, size_t) noexcept { heap_caps_free(ptr); }
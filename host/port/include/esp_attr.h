@@ -0,0 +1,16 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+// Host stand-in for esp_attr.h, placement attributes have no meaning on the host
+
+#ifndef SMART_FOUNTAIN_HOST_ESP_ATTR_H
+#define SMART_FOUNTAIN_HOST_ESP_ATTR_H
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+#define NOINLINE_ATTR __attribute__((noinline))
+
+#endif //SMART_FOUNTAIN_HOST_ESP_ATTR_H
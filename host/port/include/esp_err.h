@@ -0,0 +1,45 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+// Host stand-in for ESP-IDF esp_err.h
+
+#ifndef SMART_FOUNTAIN_HOST_ESP_ERR_H
+#define SMART_FOUNTAIN_HOST_ESP_ERR_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef int esp_err_t;
+
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_NO_MEM 0x101
+#define ESP_ERR_INVALID_ARG 0x102
+#define ESP_ERR_INVALID_STATE 0x103
+#define ESP_ERR_INVALID_SIZE 0x104
+#define ESP_ERR_NOT_FOUND 0x105
+#define ESP_ERR_TIMEOUT 0x107
+#define ESP_ERR_INVALID_VERSION 0x10A
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+const char *esp_err_to_name(esp_err_t code);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define ESP_ERROR_CHECK(x) do {                                                              \
+        const esp_err_t err_rc_ = (x);                                                      \
+        if (err_rc_ != ESP_OK) {                                                            \
+            fprintf(stderr, "ESP_ERROR_CHECK failed: %s at %s:%d\n", esp_err_to_name(err_rc_), \
+                    __FILE__, __LINE__);                                                    \
+            abort();                                                                        \
+        }                                                                                   \
+    } while (0)
+
+#endif //SMART_FOUNTAIN_HOST_ESP_ERR_H
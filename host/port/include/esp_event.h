@@ -0,0 +1,63 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+// Host stand-in for esp_event.h, each loop dispatches from its own task through a bounded queue
+
+#ifndef SMART_FOUNTAIN_HOST_ESP_EVENT_H
+#define SMART_FOUNTAIN_HOST_ESP_EVENT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+typedef const char *esp_event_base_t;
+typedef struct esp_event_loop *esp_event_loop_handle_t;
+typedef void *esp_event_handler_instance_t;
+typedef void (*esp_event_handler_t)(void *handler_arg, esp_event_base_t event_base, int32_t event_id,
+                                    void *event_data);
+
+#define ESP_EVENT_DECLARE_BASE(id) extern esp_event_base_t const id
+#define ESP_EVENT_DEFINE_BASE(id) esp_event_base_t const id = #id
+
+#define ESP_EVENT_ANY_BASE NULL
+#define ESP_EVENT_ANY_ID -1
+
+typedef struct {
+    int32_t queue_size;
+    const char *task_name; ///< Required on the host, loops without a task are not supported
+    UBaseType_t task_priority;
+    uint32_t task_stack_size;
+    BaseType_t task_core_id;
+} esp_event_loop_args_t;
+
+esp_err_t esp_event_loop_create(const esp_event_loop_args_t *args, esp_event_loop_handle_t *loop);
+
+esp_err_t esp_event_loop_create_default();
+
+esp_err_t esp_event_post(esp_event_base_t base, int32_t id, const void *data, size_t size, TickType_t ticks);
+
+esp_err_t esp_event_post_to(esp_event_loop_handle_t loop, esp_event_base_t base, int32_t id, const void *data,
+                            size_t size, TickType_t ticks);
+
+esp_err_t esp_event_handler_register(esp_event_base_t base, int32_t id, esp_event_handler_t handler, void *arg);
+
+esp_err_t esp_event_handler_register_with(esp_event_loop_handle_t loop, esp_event_base_t base, int32_t id,
+                                          esp_event_handler_t handler, void *arg);
+
+esp_err_t esp_event_handler_instance_register(esp_event_base_t base, int32_t id, esp_event_handler_t handler,
+                                              void *arg, esp_event_handler_instance_t *instance);
+
+esp_err_t esp_event_handler_instance_register_with(esp_event_loop_handle_t loop, esp_event_base_t base, int32_t id,
+                                                   esp_event_handler_t handler, void *arg,
+                                                   esp_event_handler_instance_t *instance);
+
+esp_err_t esp_event_handler_instance_unregister(esp_event_base_t base, int32_t id,
+                                                esp_event_handler_instance_t instance);
+
+esp_err_t esp_event_handler_instance_unregister_with(esp_event_loop_handle_t loop, esp_event_base_t base, int32_t id,
+                                                     esp_event_handler_instance_t instance);
+
+#endif //SMART_FOUNTAIN_HOST_ESP_EVENT_H
@@ -0,0 +1,33 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+// Host stand-in for esp_heap_caps.h.
+// The port routes operator new/delete through the heap hooks (CONFIG_HEAP_USE_HOOKS) and reports the internal
+// heap as a fixed-size region minus what is currently allocated through them.
+
+#ifndef SMART_FOUNTAIN_HOST_ESP_HEAP_CAPS_H
+#define SMART_FOUNTAIN_HOST_ESP_HEAP_CAPS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MALLOC_CAP_EXEC (1 << 0)
+#define MALLOC_CAP_32BIT (1 << 1)
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_DMA (1 << 3)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_DEFAULT (1 << 12)
+
+void *heap_caps_malloc(size_t size, uint32_t caps);
+
+void heap_caps_free(void *ptr);
+
+size_t heap_caps_get_free_size(uint32_t caps);
+
+size_t heap_caps_get_minimum_free_size(uint32_t caps);
+
+size_t heap_caps_get_largest_free_block(uint32_t caps);
+
+#endif //SMART_FOUNTAIN_HOST_ESP_HEAP_CAPS_H
@@ -0,0 +1,46 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+// Host stand-in for ESP-IDF esp_log.h, logs to stderr up to SMART_FOUNTAIN_HOST_LOG_LEVEL,
+// set at compile time or in the environment
+
+#ifndef SMART_FOUNTAIN_HOST_ESP_LOG_H
+#define SMART_FOUNTAIN_HOST_ESP_LOG_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_err.h"
+
+// 0 none, 1 error, 2 warn, 3 info, 4 debug, 5 verbose
+#ifndef SMART_FOUNTAIN_HOST_LOG_LEVEL
+#define SMART_FOUNTAIN_HOST_LOG_LEVEL 2
+#endif
+
+/**
+ * @brief The SMART_FOUNTAIN_HOST_LOG_LEVEL environment variable overrides the compiled-in level
+ */
+static inline int host_log_level(void) {
+    static int level = -1;
+    if (level < 0) {
+        const char *env = getenv("SMART_FOUNTAIN_HOST_LOG_LEVEL");
+        level = env ? atoi(env) : SMART_FOUNTAIN_HOST_LOG_LEVEL;
+    }
+    return level;
+}
+
+#define HOST_LOG_(level, letter, tag, format, ...) do {                              \
+        if (host_log_level() >= (level)) {                                           \
+            fprintf(stderr, letter " (%s) " format "\n", tag, ##__VA_ARGS__);        \
+        }                                                                            \
+    } while (0)
+
+#define ESP_LOGE(tag, format, ...) HOST_LOG_(1, "E", tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) HOST_LOG_(2, "W", tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) HOST_LOG_(3, "I", tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) HOST_LOG_(4, "D", tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) HOST_LOG_(5, "V", tag, format, ##__VA_ARGS__)
+
+#endif //SMART_FOUNTAIN_HOST_ESP_LOG_H
@@ -0,0 +1,23 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+// Host stand-in for esp_mac.h, the base MAC is derived from the host name so several instances differ
+
+#ifndef SMART_FOUNTAIN_HOST_ESP_MAC_H
+#define SMART_FOUNTAIN_HOST_ESP_MAC_H
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+typedef enum {
+    ESP_MAC_WIFI_STA,
+    ESP_MAC_WIFI_SOFTAP,
+    ESP_MAC_BT,
+    ESP_MAC_ETH,
+} esp_mac_type_t;
+
+esp_err_t esp_read_mac(uint8_t *mac, esp_mac_type_t type);
+
+#endif //SMART_FOUNTAIN_HOST_ESP_MAC_H
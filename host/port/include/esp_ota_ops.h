@@ -0,0 +1,68 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+// Host stand-in for esp_ota_ops.h. Each slot is a file in SMART_FOUNTAIN_OTA_DIR (default the working directory),
+// ota_0.bin and ota_1.bin, and otadata.txt records the boot slot and the state of each slot. The bootloader's part
+// of rollback runs on the first call: a NEW boot slot becomes PENDING_VERIFY, and one still pending from the
+// previous run is ABORTED in favour of the other slot. Images are not validated beyond their digest.
+
+#ifndef SMART_FOUNTAIN_HOST_ESP_OTA_OPS_H
+#define SMART_FOUNTAIN_HOST_ESP_OTA_OPS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "esp_partition.h"
+
+#define OTA_SIZE_UNKNOWN 0xffffffff
+#define OTA_WITH_SEQUENTIAL_WRITES 0xfffffffe
+
+#define ESP_ERR_OTA_BASE 0x1500
+#define ESP_ERR_OTA_PARTITION_CONFLICT (ESP_ERR_OTA_BASE + 0x01)
+#define ESP_ERR_OTA_SELECT_INFO_INVALID (ESP_ERR_OTA_BASE + 0x02)
+#define ESP_ERR_OTA_VALIDATE_FAILED (ESP_ERR_OTA_BASE + 0x03)
+#define ESP_ERR_OTA_ROLLBACK_FAILED (ESP_ERR_OTA_BASE + 0x05)
+#define ESP_ERR_OTA_ROLLBACK_INVALID_STATE (ESP_ERR_OTA_BASE + 0x06)
+
+typedef uint32_t esp_ota_handle_t;
+
+typedef enum {
+    ESP_OTA_IMG_NEW = 0x0U,
+    ESP_OTA_IMG_PENDING_VERIFY = 0x1U,
+    ESP_OTA_IMG_VALID = 0x2U,
+    ESP_OTA_IMG_INVALID = 0x3U,
+    ESP_OTA_IMG_ABORTED = 0x4U,
+    ESP_OTA_IMG_UNDEFINED = 0xFFFFFFFFU,
+} esp_ota_img_states_t;
+
+esp_err_t esp_ota_begin(const esp_partition_t *partition, size_t image_size, esp_ota_handle_t *out_handle);
+
+esp_err_t esp_ota_write(esp_ota_handle_t handle, const void *data, size_t size);
+
+/**
+ * @brief Stores the written image in the slot file
+ */
+esp_err_t esp_ota_end(esp_ota_handle_t handle);
+
+esp_err_t esp_ota_abort(esp_ota_handle_t handle);
+
+esp_err_t esp_ota_set_boot_partition(const esp_partition_t *partition);
+
+const esp_partition_t *esp_ota_get_boot_partition();
+
+const esp_partition_t *esp_ota_get_running_partition();
+
+const esp_partition_t *esp_ota_get_next_update_partition(const esp_partition_t *start_from);
+
+esp_err_t esp_ota_get_state_partition(const esp_partition_t *partition, esp_ota_img_states_t *ota_state);
+
+esp_err_t esp_ota_mark_app_valid_cancel_rollback();
+
+/**
+ * @brief Marks the running slot invalid, boots the other one and restarts the process (see esp_restart)
+ */
+esp_err_t esp_ota_mark_app_invalid_rollback_and_reboot();
+
+#endif //SMART_FOUNTAIN_HOST_ESP_OTA_OPS_H
@@ -0,0 +1,49 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+// Host stand-in for esp_partition.h, only the two OTA app slots of partitions.csv exist, see esp_ota_ops.h
+
+#ifndef SMART_FOUNTAIN_HOST_ESP_PARTITION_H
+#define SMART_FOUNTAIN_HOST_ESP_PARTITION_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+typedef enum {
+    ESP_PARTITION_TYPE_APP = 0x00,
+    ESP_PARTITION_TYPE_DATA = 0x01,
+} esp_partition_type_t;
+
+typedef enum {
+    ESP_PARTITION_SUBTYPE_APP_OTA_0 = 0x10,
+    ESP_PARTITION_SUBTYPE_APP_OTA_1 = 0x11,
+    ESP_PARTITION_SUBTYPE_ANY = 0xff,
+} esp_partition_subtype_t;
+
+typedef struct {
+    void *flash_chip;
+    esp_partition_type_t type;
+    esp_partition_subtype_t subtype;
+    uint32_t address;
+    uint32_t size;
+    uint32_t erase_size;
+    char label[17];
+    bool encrypted;
+    bool readonly;
+} esp_partition_t;
+
+/**
+ * @brief Reads a slot, bytes past the stored image read as erased flash (0xFF)
+ */
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t src_offset, void *dst, size_t size);
+
+/**
+ * @brief Digest of the stored image: for an esptool image with an appended digest, the SHA-256 of everything
+ * before it, like the bootloader computes it; otherwise the SHA-256 of the whole image
+ */
+esp_err_t esp_partition_get_sha256(const esp_partition_t *partition, uint8_t *sha_256);
+
+#endif //SMART_FOUNTAIN_HOST_ESP_PARTITION_H
@@ -0,0 +1,18 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+// Host stand-in for esp_rom_crc.h
+
+#ifndef SMART_FOUNTAIN_HOST_ESP_ROM_CRC_H
+#define SMART_FOUNTAIN_HOST_ESP_ROM_CRC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief CRC-32 (IEEE 802.3, little endian), same values as the ROM routine and zlib's crc32
+ */
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len);
+
+#endif //SMART_FOUNTAIN_HOST_ESP_ROM_CRC_H
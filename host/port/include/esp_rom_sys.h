@@ -0,0 +1,17 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+// Host stand-in for esp_rom_sys.h
+
+#ifndef SMART_FOUNTAIN_HOST_ESP_ROM_SYS_H
+#define SMART_FOUNTAIN_HOST_ESP_ROM_SYS_H
+
+#include <stdint.h>
+
+/**
+ * @brief Busy-waits like the ROM routine, sleeping would be far too coarse for bit-banged protocols
+ */
+void esp_rom_delay_us(uint32_t us);
+
+#endif //SMART_FOUNTAIN_HOST_ESP_ROM_SYS_H
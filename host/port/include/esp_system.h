@@ -0,0 +1,15 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+// Host stand-in for esp_system.h
+
+#ifndef SMART_FOUNTAIN_HOST_ESP_SYSTEM_H
+#define SMART_FOUNTAIN_HOST_ESP_SYSTEM_H
+
+/**
+ * @brief Re-executes the host binary with its original arguments, state persists only through the NVS file
+ */
+[[noreturn]] void esp_restart();
+
+#endif //SMART_FOUNTAIN_HOST_ESP_SYSTEM_H
@@ -0,0 +1,64 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+// Host stand-in for FreeRTOS on ESP-IDF, tasks are pthreads and critical sections are recursive spinlocks
+
+#ifndef SMART_FOUNTAIN_HOST_FREERTOS_H
+#define SMART_FOUNTAIN_HOST_FREERTOS_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sdkconfig.h"
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+
+#define portMAX_DELAY ((TickType_t) 0xffffffffUL)
+#define configTICK_RATE_HZ CONFIG_FREERTOS_HZ
+#define portTICK_PERIOD_MS ((TickType_t) 1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms) ((TickType_t) (((uint64_t) (ms) * configTICK_RATE_HZ) / 1000U))
+#define portNUM_PROCESSORS 2
+#define configMAX_TASK_NAME_LEN 16
+#define configRUN_TIME_COUNTER_TYPE uint32_t
+#define tskNO_AFFINITY ((BaseType_t) 0x7FFFFFFF)
+
+/**
+ * @brief Recursive spinlock, owned by a task rather than a core on the host
+ */
+typedef struct {
+    std::atomic<void *> owner;
+    uint32_t count;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED {nullptr, 0}
+
+void vPortEnterCritical(portMUX_TYPE *mux);
+
+void vPortExitCritical(portMUX_TYPE *mux);
+
+/**
+ * @brief Core of a pinned task, otherwise derived from the host CPU the thread runs on
+ */
+BaseType_t xPortGetCoreID();
+
+#define taskENTER_CRITICAL(mux) vPortEnterCritical(mux)
+#define taskEXIT_CRITICAL(mux) vPortExitCritical(mux)
+#define taskENTER_CRITICAL_ISR(mux) vPortEnterCritical(mux)
+#define taskEXIT_CRITICAL_ISR(mux) vPortExitCritical(mux)
+#define portENTER_CRITICAL(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL(mux) vPortExitCritical(mux)
+
+// There are no interrupts to mask on the host
+#define portDISABLE_INTERRUPTS() do {} while (0)
+#define portENABLE_INTERRUPTS() do {} while (0)
+
+#endif //SMART_FOUNTAIN_HOST_FREERTOS_H
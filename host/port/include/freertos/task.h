@@ -0,0 +1,83 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+// Host stand-in for FreeRTOS task.h.
+// Priorities are recorded but not enforced. Core affinity is only used to attribute CPU time to the simulated
+// idle tasks, so TaskStats reports per-core load as if tasks ran where they are pinned.
+
+#ifndef SMART_FOUNTAIN_HOST_FREERTOS_TASK_H
+#define SMART_FOUNTAIN_HOST_FREERTOS_TASK_H
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct tskTaskControlBlock *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+typedef enum {
+    eRunning = 0,
+    eReady,
+    eBlocked,
+    eSuspended,
+    eDeleted,
+    eInvalid,
+} eTaskState;
+
+typedef struct {
+    TaskHandle_t xHandle;
+    const char *pcTaskName;
+    UBaseType_t xTaskNumber;
+    eTaskState eCurrentState;
+    UBaseType_t uxCurrentPriority;
+    UBaseType_t uxBasePriority;
+    configRUN_TIME_COUNTER_TYPE ulRunTimeCounter;
+    void *pxStackBase;
+    uint32_t usStackHighWaterMark;
+    BaseType_t xCoreID;
+} TaskStatus_t;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg,
+                                   UBaseType_t priority, TaskHandle_t *created, BaseType_t core_id);
+
+static inline BaseType_t xTaskCreate(const TaskFunction_t fn, const char *name, const uint32_t stack_depth,
+                                     void *arg, const UBaseType_t priority, TaskHandle_t *created) {
+    return xTaskCreatePinnedToCore(fn, name, stack_depth, arg, priority, created, tskNO_AFFINITY);
+}
+
+/**
+ * @brief Only a task deleting itself (nullptr) is supported
+ */
+void vTaskDelete(TaskHandle_t task);
+
+void vTaskDelay(TickType_t ticks);
+
+BaseType_t xTaskDelayUntil(TickType_t *previous_wake, TickType_t increment);
+
+TickType_t xTaskGetTickCount();
+
+/**
+ * @brief Threads not created through xTaskCreate get a handle on first use, named after the thread.
+ * They are host plumbing and left out of uxTaskGetSystemState.
+ */
+TaskHandle_t xTaskGetCurrentTaskHandle();
+
+char *pcTaskGetName(TaskHandle_t task);
+
+BaseType_t xTaskGetCoreID(TaskHandle_t task);
+
+TaskHandle_t xTaskGetIdleTaskHandleForCore(BaseType_t core_id);
+
+UBaseType_t uxTaskGetNumberOfTasks();
+
+UBaseType_t uxTaskGetSystemState(TaskStatus_t *tasks, UBaseType_t size, configRUN_TIME_COUNTER_TYPE *total_run_time);
+
+/**
+ * @brief Lowest unused stack in bytes, measured by painting the host stack at creation
+ */
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait);
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+
+#endif //SMART_FOUNTAIN_HOST_FREERTOS_TASK_H
@@ -0,0 +1,39 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+// Bit-level HX711 simulation behind the GPIO stand-in, so the unmodified HX711 driver runs on the host.
+// DOUT falls when a conversion is ready, each rising edge of PD_SCK shifts out the next bit MSB first and the
+// 25th to 27th pulses end the read, as described in the datasheet.
+
+#ifndef SMART_FOUNTAIN_HOST_HX711_SIM_H
+#define SMART_FOUNTAIN_HOST_HX711_SIM_H
+
+#include <driver/gpio.h>
+
+struct Hx711SimConfig {
+    float samples_per_second = 80.0f; ///< 10 or 80 depending on the RATE pin
+    float counts_per_gram = 1.0f;
+    int32_t offset_counts = 12000;    ///< Reading of the empty scale
+    float noise_counts = 0.5f;        ///< Standard deviation of the gaussian noise
+    float weight_g = 1500.0f;         ///< Initial load, e.g. a full bowl
+};
+
+/**
+ * @brief Connects a simulated HX711 to the given pins, call before the driver is constructed
+ */
+void hx711_sim_attach(gpio_num_t clk, gpio_num_t dout, const Hx711SimConfig &config = {});
+
+/**
+ * @brief Changes the simulated load, e.g. to emulate drinking or refilling
+ */
+void hx711_sim_set_weight(float grams);
+
+float hx711_sim_weight();
+
+/**
+ * @brief Stops conversions, the driver then times out waiting for DOUT
+ */
+void hx711_sim_set_stalled(bool stalled);
+
+#endif //SMART_FOUNTAIN_HOST_HX711_SIM_H
@@ -0,0 +1,24 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+// Newlib functions the firmware relies on that older glibc lacks, force-included into firmware sources
+
+#ifndef SMART_FOUNTAIN_HOST_NEWLIB_COMPAT_H
+#define SMART_FOUNTAIN_HOST_NEWLIB_COMPAT_H
+
+#include <string.h>
+
+#if defined(__GLIBC__) && !__GLIBC_PREREQ(2, 38)
+static inline size_t strlcpy(char *dst, const char *src, size_t size) {
+    const size_t len = strlen(src);
+    if (size) {
+        const size_t n = len < size - 1 ? len : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return len;
+}
+#endif
+
+#endif //SMART_FOUNTAIN_HOST_NEWLIB_COMPAT_H
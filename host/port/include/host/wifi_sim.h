@@ -0,0 +1,25 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+// Controls the simulated Wi-Fi link of the host build
+
+#ifndef SMART_FOUNTAIN_HOST_WIFI_SIM_H
+#define SMART_FOUNTAIN_HOST_WIFI_SIM_H
+
+/**
+ * @brief Posts WIFI_EVENT_STA_DISCONNECTED as if the access point went away
+ */
+void wifi_sim_drop();
+
+/**
+ * @brief Brings the link back, posting WIFI_EVENT_STA_CONNECTED and IP_EVENT_STA_GOT_IP
+ */
+void wifi_sim_restore();
+
+/**
+ * @brief Remembers the command line so esp_restart() can re-execute the binary
+ */
+void system_sim_init(int argc, char **argv);
+
+#endif //SMART_FOUNTAIN_HOST_WIFI_SIM_H
@@ -0,0 +1,43 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+// Host stand-in for the espressif/led_strip component, pixel changes are logged at debug level
+
+#ifndef SMART_FOUNTAIN_HOST_LED_STRIP_H
+#define SMART_FOUNTAIN_HOST_LED_STRIP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "driver/gpio.h"
+#include "esp_err.h"
+
+typedef struct led_strip_t *led_strip_handle_t;
+
+typedef struct {
+    int strip_gpio_num;
+    uint32_t max_leds;
+} led_strip_config_t;
+
+#define RMT_CLK_SRC_DEFAULT 0
+
+typedef struct {
+    int clk_src;
+    uint32_t resolution_hz;
+    size_t mem_block_symbols;
+    struct {
+        uint32_t with_dma: 1;
+    } flags;
+} led_strip_rmt_config_t;
+
+esp_err_t led_strip_new_rmt_device(const led_strip_config_t *led_config, const led_strip_rmt_config_t *rmt_config,
+                                   led_strip_handle_t *ret_strip);
+
+esp_err_t led_strip_set_pixel(led_strip_handle_t strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue);
+
+esp_err_t led_strip_refresh(led_strip_handle_t strip);
+
+esp_err_t led_strip_clear(led_strip_handle_t strip);
+
+#endif //SMART_FOUNTAIN_HOST_LED_STRIP_H
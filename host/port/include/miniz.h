@@ -0,0 +1,53 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+// Host stand-in for the ROM miniz.h, the tinfl decoder API on top of the system zlib.
+// zlib allocates from an arena inside the decompressor, so like the ROM decoder it can be dropped mid-stream.
+
+#ifndef SMART_FOUNTAIN_HOST_MINIZ_H
+#define SMART_FOUNTAIN_HOST_MINIZ_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zlib.h>
+
+typedef uint8_t mz_uint8;
+typedef uint32_t mz_uint32;
+
+#define TINFL_LZ_DICT_SIZE 32768
+
+enum {
+    TINFL_FLAG_PARSE_ZLIB_HEADER = 1,
+    TINFL_FLAG_HAS_MORE_INPUT = 2,
+    TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF = 4,
+    TINFL_FLAG_COMPUTE_ADLER32 = 8,
+};
+
+typedef enum {
+    TINFL_STATUS_BAD_PARAM = -3,
+    TINFL_STATUS_ADLER32_MISMATCH = -2,
+    TINFL_STATUS_FAILED = -1,
+    TINFL_STATUS_DONE = 0,
+    TINFL_STATUS_NEEDS_MORE_INPUT = 1,
+    TINFL_STATUS_HAS_MORE_OUTPUT = 2,
+} tinfl_status;
+
+typedef struct {
+    mz_uint32 m_state;    ///< 0 before the first call, as set by tinfl_init
+    z_stream stream;
+    size_t arena_used;
+    alignas(16) unsigned char arena[48 * 1024]; ///< inflate state and its 32 KB window
+} tinfl_decompressor;
+
+#define tinfl_init(r) do { (r)->m_state = 0; } while (0)
+
+/**
+ * @brief Same contract as the ROM decoder: output goes to a power of two circular buffer starting at
+ * out_buf_start, sizes are updated to the bytes consumed and produced
+ */
+tinfl_status tinfl_decompress(tinfl_decompressor *r, const mz_uint8 *in_buf_next, size_t *in_buf_size,
+                              mz_uint8 *out_buf_start, mz_uint8 *out_buf_next, size_t *out_buf_size,
+                              mz_uint32 decomp_flags);
+
+#endif //SMART_FOUNTAIN_HOST_MINIZ_H
@@ -0,0 +1,96 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+// Host stand-in for esp-mqtt: a small MQTT 3.1.1 client over TCP (mqtt:// only) with QoS 0/1 publishing,
+// keep-alive and automatic reconnection. Unacknowledged QoS 1 messages are not retransmitted, the firmware's
+// store-and-forward queue already replays them.
+
+#ifndef SMART_FOUNTAIN_HOST_MQTT_CLIENT_H
+#define SMART_FOUNTAIN_HOST_MQTT_CLIENT_H
+
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "esp_event.h"
+
+typedef struct esp_mqtt_client *esp_mqtt_client_handle_t;
+
+typedef enum esp_mqtt_event_id_t {
+    MQTT_EVENT_ANY = -1,
+    MQTT_EVENT_ERROR = 0,
+    MQTT_EVENT_CONNECTED,
+    MQTT_EVENT_DISCONNECTED,
+    MQTT_EVENT_SUBSCRIBED,
+    MQTT_EVENT_UNSUBSCRIBED,
+    MQTT_EVENT_PUBLISHED,
+    MQTT_EVENT_DATA,
+    MQTT_EVENT_BEFORE_CONNECT,
+} esp_mqtt_event_id_t;
+
+typedef struct esp_mqtt_event_t {
+    esp_mqtt_event_id_t event_id;
+    esp_mqtt_client_handle_t client;
+    char *data;
+    int data_len;
+    char *topic;
+    int topic_len;
+    int msg_id;
+    bool session_present;
+    int qos;
+    bool retain;
+} esp_mqtt_event_t;
+
+typedef esp_mqtt_event_t *esp_mqtt_event_handle_t;
+
+typedef struct esp_mqtt_client_config_t {
+    struct {
+        struct {
+            const char *uri;      ///< mqtt://host[:port]
+            const char *hostname; ///< Used with port when uri is not set
+            uint32_t port;
+        } address;
+    } broker;
+    struct {
+        const char *username;
+        const char *client_id;
+        struct {
+            const char *password;
+        } authentication;
+    } credentials;
+    struct {
+        int keepalive;          ///< Seconds, 120 when zero
+        bool disable_clean_session;
+    } session;
+    struct {
+        int reconnect_timeout_ms; ///< 10 s when zero
+        int timeout_ms;           ///< Connect and write timeout, 10 s when zero
+        bool disable_auto_reconnect;
+    } network;
+    struct {
+        int size;     ///< Receive buffer, 1024 when zero
+        int out_size;
+    } buffer;
+    struct {
+        int priority;   ///< 5 when zero
+        int stack_size;
+    } task;
+} esp_mqtt_client_config_t;
+
+esp_mqtt_client_handle_t esp_mqtt_client_init(const esp_mqtt_client_config_t *config);
+
+esp_err_t esp_mqtt_client_register_event(esp_mqtt_client_handle_t client, esp_mqtt_event_id_t event,
+                                         esp_event_handler_t event_handler, void *event_handler_arg);
+
+esp_err_t esp_mqtt_client_start(esp_mqtt_client_handle_t client);
+
+esp_err_t esp_mqtt_client_stop(esp_mqtt_client_handle_t client);
+
+/**
+ * @brief Publishes right away
+ * @return Message id (0 for QoS 0) or -1 when not connected or the write failed
+ */
+int esp_mqtt_client_publish(esp_mqtt_client_handle_t client, const char *topic, const char *data, int len, int qos,
+                            int retain);
+
+#endif //SMART_FOUNTAIN_HOST_MQTT_CLIENT_H
@@ -0,0 +1,19 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+// Host stand-in for nvs_flash.h, the partition is the file named by SMART_FOUNTAIN_NVS_PATH (default nvs.txt)
+
+#ifndef SMART_FOUNTAIN_HOST_NVS_FLASH_H
+#define SMART_FOUNTAIN_HOST_NVS_FLASH_H
+
+#include "esp_err.h"
+#include "nvs.h"
+
+esp_err_t nvs_flash_init();
+
+esp_err_t nvs_flash_erase();
+
+esp_err_t nvs_flash_deinit();
+
+#endif //SMART_FOUNTAIN_HOST_NVS_FLASH_H
@@ -0,0 +1,18 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+// Host stand-in for the generated sdkconfig.h, mirrors sdkconfig.esp32-s3-devkitc-1 where the firmware depends on it
+
+#ifndef SMART_FOUNTAIN_HOST_SDKCONFIG_H
+#define SMART_FOUNTAIN_HOST_SDKCONFIG_H
+
+#define CONFIG_IDF_TARGET "esp32s3"
+#define CONFIG_FREERTOS_HZ 1000
+#define CONFIG_FREERTOS_USE_TRACE_FACILITY 1
+#define CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS 1
+#define CONFIG_FREERTOS_RUN_TIME_STATS_USING_ESP_TIMER 1
+#define CONFIG_FREERTOS_RUN_TIME_COUNTER_TYPE_U32 1
+#define CONFIG_HEAP_USE_HOOKS 1
+
+#endif //SMART_FOUNTAIN_HOST_SDKCONFIG_H
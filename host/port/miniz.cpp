@@ -0,0 +1,68 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#include <miniz.h>
+
+#include <cstring>
+
+static constexpr mz_uint32 STATE_STREAMING = 1;
+static constexpr mz_uint32 STATE_ENDED = 2;
+
+static voidpf arena_alloc(const voidpf opaque, const uInt items, const uInt size) {
+    auto *r = static_cast<tinfl_decompressor *>(opaque);
+    const size_t bytes = (static_cast<size_t>(items) * size + 15) & ~static_cast<size_t>(15);
+    if (bytes > sizeof(r->arena) - r->arena_used) {
+        return Z_NULL;
+    }
+    void *p = r->arena + r->arena_used;
+    r->arena_used += bytes;
+    return p;
+}
+
+static void arena_free(voidpf, voidpf) {}
+
+tinfl_status tinfl_decompress(tinfl_decompressor *r, const mz_uint8 *in_buf_next, size_t *in_buf_size,
+                              mz_uint8 *out_buf_start, mz_uint8 *out_buf_next, size_t *out_buf_size,
+                              const mz_uint32 decomp_flags) {
+    static_cast<void>(out_buf_start);
+    if (r->m_state == 0) {
+        memset(&r->stream, 0, sizeof(r->stream));
+        r->arena_used = 0;
+        r->stream.zalloc = arena_alloc;
+        r->stream.zfree = arena_free;
+        r->stream.opaque = r;
+        if (inflateInit2(&r->stream, decomp_flags & TINFL_FLAG_PARSE_ZLIB_HEADER ? MAX_WBITS : -MAX_WBITS) != Z_OK) {
+            return TINFL_STATUS_BAD_PARAM;
+        }
+        r->m_state = STATE_STREAMING;
+    }
+    if (r->m_state == STATE_ENDED) {
+        *in_buf_size = 0;
+        *out_buf_size = 0;
+        return TINFL_STATUS_DONE;
+    }
+
+    r->stream.next_in = const_cast<Bytef *>(in_buf_next);
+    r->stream.avail_in = static_cast<uInt>(*in_buf_size);
+    r->stream.next_out = out_buf_next;
+    r->stream.avail_out = static_cast<uInt>(*out_buf_size);
+    const int ret = inflate(&r->stream, Z_NO_FLUSH);
+    *in_buf_size -= r->stream.avail_in;
+    *out_buf_size -= r->stream.avail_out;
+
+    if (ret == Z_STREAM_END) {
+        r->m_state = STATE_ENDED;
+        return TINFL_STATUS_DONE;
+    }
+    if (ret != Z_OK && ret != Z_BUF_ERROR) {
+        return ret == Z_DATA_ERROR && r->stream.msg && strstr(r->stream.msg, "check")
+                   ? TINFL_STATUS_ADLER32_MISMATCH
+                   : TINFL_STATUS_FAILED;
+    }
+    if (r->stream.avail_out == 0) {
+        return TINFL_STATUS_HAS_MORE_OUTPUT;
+    }
+    return decomp_flags & TINFL_FLAG_HAS_MORE_INPUT ? TINFL_STATUS_NEEDS_MORE_INPUT : TINFL_STATUS_FAILED;
+}
@@ -0,0 +1,415 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#include <mqtt_client.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/task.h>
+#include <mutex>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static auto TAG = "mqtt_client";
+
+static constexpr size_t MAX_CLIENTS = 2;
+static constexpr size_t MAX_HANDLERS = 4;
+static constexpr size_t RX_BUFFER = 1024;
+
+enum : uint8_t {
+    CONNECT = 0x10,
+    CONNACK = 0x20,
+    PUBLISH = 0x30,
+    PUBACK = 0x40,
+    PINGREQ = 0xC0,
+    PINGRESP = 0xD0,
+};
+
+struct Handler {
+    esp_mqtt_event_id_t event;
+    esp_event_handler_t fn;
+    void *arg;
+};
+
+struct esp_mqtt_client {
+    char host[128];
+    char port[12];
+    char client_id[64];
+    char username[64];
+    char password[64];
+    int keepalive_s;
+    bool clean_session;
+    int reconnect_ms;
+    int timeout_ms;
+    bool auto_reconnect;
+    int priority;
+    Handler handlers[MAX_HANDLERS];
+    size_t handler_count;
+    TaskHandle_t task;
+    std::atomic<bool> running;
+    std::atomic<bool> connected;
+    std::mutex write_lock;
+    int fd;
+    uint16_t next_msg_id;
+    int64_t last_tx_us;
+    uint8_t rx[RX_BUFFER];
+    size_t rx_len;
+};
+
+static esp_mqtt_client clients[MAX_CLIENTS];
+static std::atomic<size_t> client_count{0};
+
+static void copy(char *dst, const size_t size, const char *src) {
+    snprintf(dst, size, "%s", src ? src : "");
+}
+
+static void dispatch(esp_mqtt_client *client, const esp_mqtt_event_id_t id, const int msg_id = 0,
+                     const bool session_present = false) {
+    esp_mqtt_event_t event = {};
+    event.event_id = id;
+    event.client = client;
+    event.msg_id = msg_id;
+    event.session_present = session_present;
+    for (size_t i = 0; i < client->handler_count; ++i) {
+        const Handler &h = client->handlers[i];
+        if (h.event == MQTT_EVENT_ANY || h.event == id) {
+            h.fn(h.arg, "MQTT_EVENTS", id, &event);
+        }
+    }
+}
+
+static size_t put_length(uint8_t *out, size_t len) {
+    size_t n = 0;
+    do {
+        uint8_t byte = len % 128;
+        len /= 128;
+        out[n++] = len ? byte | 0x80 : byte;
+    } while (len);
+    return n;
+}
+
+static size_t put_string(uint8_t *out, const char *str, const size_t len) {
+    out[0] = static_cast<uint8_t>(len >> 8);
+    out[1] = static_cast<uint8_t>(len);
+    memcpy(out + 2, str, len);
+    return len + 2;
+}
+
+static bool send_all(esp_mqtt_client *client, const iovec *iov, const int count) {
+    msghdr msg = {};
+    iovec parts[4];
+    memcpy(parts, iov, sizeof(iovec) * count);
+    msg.msg_iov = parts;
+    msg.msg_iovlen = count;
+    while (msg.msg_iovlen) {
+        const ssize_t sent = sendmsg(client->fd, &msg, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        auto left = static_cast<size_t>(sent);
+        while (msg.msg_iovlen && left >= msg.msg_iov->iov_len) {
+            left -= msg.msg_iov->iov_len;
+            msg.msg_iov++;
+            msg.msg_iovlen--;
+        }
+        if (msg.msg_iovlen) {
+            msg.msg_iov->iov_base = static_cast<uint8_t *>(msg.msg_iov->iov_base) + left;
+            msg.msg_iov->iov_len -= left;
+        }
+    }
+    client->last_tx_us = esp_timer_get_time();
+    return true;
+}
+
+static int open_socket(const esp_mqtt_client *client) {
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *result = nullptr;
+    if (getaddrinfo(client->host, client->port, &hints, &result) != 0) {
+        ESP_LOGE(TAG, "Cannot resolve %s", client->host);
+        return -1;
+    }
+    int fd = -1;
+    for (const addrinfo *ai = result; ai; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+        const timeval tv = {.tv_sec = client->timeout_ms / 1000, .tv_usec = client->timeout_ms % 1000 * 1000};
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        const int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+            break;
+        }
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(result);
+    return fd;
+}
+
+/**
+ * @brief Reads one packet into rx, returns its type or 0 on error. Packets larger than the buffer are dropped.
+ */
+static uint8_t read_packet(esp_mqtt_client *client, size_t *payload_offset, size_t *payload_len) {
+    uint8_t header = 0;
+    if (recv(client->fd, &header, 1, MSG_WAITALL) != 1) {
+        return 0;
+    }
+    size_t len = 0;
+    for (int shift = 0; shift < 28; shift += 7) {
+        uint8_t byte = 0;
+        if (recv(client->fd, &byte, 1, MSG_WAITALL) != 1) {
+            return 0;
+        }
+        len |= static_cast<size_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            break;
+        }
+    }
+    size_t read = 0;
+    while (read < len) {
+        const size_t want = len - read < sizeof(client->rx) ? len - read : sizeof(client->rx);
+        const ssize_t got = recv(client->fd, client->rx, want, MSG_WAITALL);
+        if (got <= 0) {
+            return 0;
+        }
+        read += static_cast<size_t>(got);
+    }
+    if (len > sizeof(client->rx)) {
+        len = 0;
+    }
+    *payload_offset = 0;
+    *payload_len = len;
+    return header;
+}
+
+static bool handshake(esp_mqtt_client *client) {
+    uint8_t packet[512];
+    uint8_t *p = packet + 5; // room for the fixed header
+    p += put_string(p, "MQTT", 4);
+    *p++ = 4; // protocol level 3.1.1
+    const bool has_user = client->username[0];
+    const bool has_pass = client->password[0];
+    *p++ = static_cast<uint8_t>((client->clean_session ? 0x02 : 0) | (has_user ? 0x80 : 0) | (has_pass ? 0x40 : 0));
+    *p++ = static_cast<uint8_t>(client->keepalive_s >> 8);
+    *p++ = static_cast<uint8_t>(client->keepalive_s);
+    p += put_string(p, client->client_id, strlen(client->client_id));
+    if (has_user) {
+        p += put_string(p, client->username, strlen(client->username));
+    }
+    if (has_pass) {
+        p += put_string(p, client->password, strlen(client->password));
+    }
+    const size_t body = p - (packet + 5);
+    uint8_t head[5] = {CONNECT};
+    const size_t head_len = 1 + put_length(head + 1, body);
+    const iovec iov[2] = {{head, head_len}, {packet + 5, body}};
+    if (!send_all(client, iov, 2)) {
+        return false;
+    }
+
+    size_t offset = 0;
+    size_t len = 0;
+    if ((read_packet(client, &offset, &len) & 0xF0) != CONNACK || len < 2) {
+        return false;
+    }
+    if (client->rx[1] != 0) {
+        ESP_LOGE(TAG, "Broker refused connection, code %u", client->rx[1]);
+        return false;
+    }
+    dispatch(client, MQTT_EVENT_CONNECTED, 0, client->rx[0] & 0x01);
+    return true;
+}
+
+static void disconnect(esp_mqtt_client *client) {
+    const bool was_connected = client->connected.exchange(false);
+    {
+        std::lock_guard lock(client->write_lock);
+        if (client->fd >= 0) {
+            close(client->fd);
+            client->fd = -1;
+        }
+    }
+    if (was_connected) {
+        dispatch(client, MQTT_EVENT_DISCONNECTED);
+    }
+}
+
+static void client_task(void *arg) {
+    auto *client = static_cast<esp_mqtt_client *>(arg);
+    while (client->running.load()) {
+        if (!client->connected.load()) {
+            dispatch(client, MQTT_EVENT_BEFORE_CONNECT);
+            const int fd = open_socket(client);
+            if (fd >= 0) {
+                {
+                    std::lock_guard lock(client->write_lock);
+                    client->fd = fd;
+                }
+                if (handshake(client)) {
+                    client->connected.store(true);
+                    continue;
+                }
+                disconnect(client);
+            }
+            dispatch(client, MQTT_EVENT_ERROR);
+            if (!client->auto_reconnect) {
+                break;
+            }
+            vTaskDelay(pdMS_TO_TICKS(client->reconnect_ms));
+            continue;
+        }
+
+        pollfd pfd = {client->fd, POLLIN, 0};
+        const int ready = poll(&pfd, 1, 200);
+        if (ready > 0) {
+            size_t offset = 0;
+            size_t len = 0;
+            const uint8_t type = read_packet(client, &offset, &len);
+            if (type == 0) {
+                ESP_LOGW(TAG, "Connection to %s lost", client->host);
+                disconnect(client);
+                continue;
+            }
+            if ((type & 0xF0) == PUBACK && len >= 2) {
+                dispatch(client, MQTT_EVENT_PUBLISHED, client->rx[0] << 8 | client->rx[1]);
+            }
+        }
+        if (esp_timer_get_time() - client->last_tx_us > client->keepalive_s * 500000LL) {
+            static constexpr uint8_t ping[2] = {PINGREQ, 0};
+            std::lock_guard lock(client->write_lock);
+            const iovec iov = {const_cast<uint8_t *>(ping), sizeof(ping)};
+            send_all(client, &iov, 1);
+        }
+    }
+    disconnect(client);
+    client->task = nullptr;
+    vTaskDelete(nullptr);
+}
+
+esp_mqtt_client_handle_t esp_mqtt_client_init(const esp_mqtt_client_config_t *config) {
+    const size_t index = client_count.fetch_add(1);
+    if (!config || index >= MAX_CLIENTS) {
+        return nullptr;
+    }
+    esp_mqtt_client *client = &clients[index];
+    if (const char *uri = config->broker.address.uri) {
+        if (strncmp(uri, "mqtt://", 7) != 0) {
+            ESP_LOGE(TAG, "Only mqtt:// is supported on the host, got %s", uri);
+            return nullptr;
+        }
+        copy(client->host, sizeof(client->host), uri + 7);
+        if (char *slash = strchr(client->host, '/')) {
+            *slash = '\0';
+        }
+        char *colon = strrchr(client->host, ':');
+        copy(client->port, sizeof(client->port), colon ? colon + 1 : "1883");
+        if (colon) {
+            *colon = '\0';
+        }
+    } else {
+        copy(client->host, sizeof(client->host), config->broker.address.hostname);
+        snprintf(client->port, sizeof(client->port), "%u",
+                 static_cast<unsigned>(config->broker.address.port ? config->broker.address.port : 1883));
+    }
+    copy(client->client_id, sizeof(client->client_id), config->credentials.client_id);
+    copy(client->username, sizeof(client->username), config->credentials.username);
+    copy(client->password, sizeof(client->password), config->credentials.authentication.password);
+    client->keepalive_s = config->session.keepalive ? config->session.keepalive : 120;
+    client->clean_session = !config->session.disable_clean_session;
+    client->reconnect_ms = config->network.reconnect_timeout_ms ? config->network.reconnect_timeout_ms : 10000;
+    client->timeout_ms = config->network.timeout_ms ? config->network.timeout_ms : 10000;
+    client->auto_reconnect = !config->network.disable_auto_reconnect;
+    client->priority = config->task.priority ? config->task.priority : 5;
+    client->fd = -1;
+    client->next_msg_id = 1;
+    return client;
+}
+
+esp_err_t esp_mqtt_client_register_event(esp_mqtt_client_handle_t client, const esp_mqtt_event_id_t event,
+                                         const esp_event_handler_t event_handler, void *event_handler_arg) {
+    if (!client || !event_handler) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (client->handler_count >= MAX_HANDLERS) {
+        return ESP_ERR_NO_MEM;
+    }
+    client->handlers[client->handler_count++] = {event, event_handler, event_handler_arg};
+    return ESP_OK;
+}
+
+esp_err_t esp_mqtt_client_start(esp_mqtt_client_handle_t client) {
+    if (!client) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (client->running.exchange(true)) {
+        return ESP_FAIL;
+    }
+    if (xTaskCreatePinnedToCore(client_task, "mqtt_task", 6144, client, client->priority, &client->task,
+                                tskNO_AFFINITY) != pdPASS) {
+        client->running.store(false);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_mqtt_client_stop(esp_mqtt_client_handle_t client) {
+    if (!client || !client->running.exchange(false)) {
+        return ESP_FAIL;
+    }
+    while (client->task) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    return ESP_OK;
+}
+
+int esp_mqtt_client_publish(esp_mqtt_client_handle_t client, const char *topic, const char *data, int len,
+                            const int qos, const int retain) {
+    if (!client || !topic || qos < 0 || qos > 1) {
+        return -1;
+    }
+    if (len <= 0) {
+        len = data ? static_cast<int>(strlen(data)) : 0;
+    }
+    std::lock_guard lock(client->write_lock);
+    if (!client->connected.load() || client->fd < 0) {
+        return -1;
+    }
+    int msg_id = 0;
+    uint8_t variable[2 + 256 + 2];
+    const size_t topic_len = strnlen(topic, 256);
+    size_t var_len = put_string(variable, topic, topic_len);
+    if (qos > 0) {
+        msg_id = client->next_msg_id;
+        client->next_msg_id = client->next_msg_id == 0xFFFF ? 1 : client->next_msg_id + 1;
+        variable[var_len++] = static_cast<uint8_t>(msg_id >> 8);
+        variable[var_len++] = static_cast<uint8_t>(msg_id);
+    }
+    uint8_t head[5] = {static_cast<uint8_t>(PUBLISH | qos << 1 | (retain ? 1 : 0))};
+    const size_t head_len = 1 + put_length(head + 1, var_len + len);
+    const iovec iov[3] = {{head, head_len}, {variable, var_len}, {const_cast<char *>(data), static_cast<size_t>(len)}};
+    if (!send_all(client, iov, 3)) {
+        // The receive loop notices the broken socket and reconnects
+        shutdown(client->fd, SHUT_RDWR);
+        return -1;
+    }
+    return msg_id;
+}
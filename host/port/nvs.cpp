@@ -0,0 +1,296 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#include <nvs.h>
+#include <nvs_flash.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <esp_log.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+static auto TAG = "nvs";
+
+static constexpr size_t MAX_HANDLES = 16;
+
+enum class Type : uint8_t { U8, U32, I32, STR, BLOB };
+
+struct Entry {
+    Type type;
+    std::vector<uint8_t> value;
+};
+
+struct Handle {
+    bool open;
+    bool writable;
+    std::string ns;
+};
+
+static std::mutex lock;
+static bool initialized = false;
+static std::string path;
+static std::map<std::string, Entry> entries; ///< Keyed by "<namespace>/<key>"
+static Handle handles[MAX_HANDLES];
+
+static const char *type_name(const Type type) {
+    switch (type) {
+        case Type::U8: return "u8";
+        case Type::U32: return "u32";
+        case Type::I32: return "i32";
+        case Type::STR: return "str";
+        default: return "blob";
+    }
+}
+
+// One entry per line: <namespace>/<key> <type> <hex bytes>
+static void save() {
+    const std::string tmp = path + ".tmp";
+    FILE *f = fopen(tmp.c_str(), "w");
+    if (!f) {
+        ESP_LOGE(TAG, "Cannot write %s", tmp.c_str());
+        return;
+    }
+    for (const auto &[key, entry] : entries) {
+        fprintf(f, "%s %s ", key.c_str(), type_name(entry.type));
+        for (const uint8_t b : entry.value) {
+            fprintf(f, "%02x", b);
+        }
+        fputs(entry.value.empty() ? "-\n" : "\n", f);
+    }
+    fclose(f);
+    rename(tmp.c_str(), path.c_str());
+}
+
+static void load() {
+    entries.clear();
+    FILE *f = fopen(path.c_str(), "r");
+    if (!f) {
+        return;
+    }
+    char key[64], type[8];
+    static char hex[16384];
+    while (fscanf(f, "%63s %7s %16383s", key, type, hex) == 3) {
+        Entry entry{};
+        for (const Type t : {Type::U8, Type::U32, Type::I32, Type::STR, Type::BLOB}) {
+            if (strcmp(type, type_name(t)) == 0) {
+                entry.type = t;
+            }
+        }
+        for (size_t i = 0; hex[0] != '-' && hex[i] && hex[i + 1]; i += 2) {
+            const char byte[3] = {hex[i], hex[i + 1], 0};
+            entry.value.push_back(static_cast<uint8_t>(strtoul(byte, nullptr, 16)));
+        }
+        entries[key] = std::move(entry);
+    }
+    fclose(f);
+}
+
+esp_err_t nvs_flash_init() {
+    std::lock_guard guard(lock);
+    const char *env = getenv("SMART_FOUNTAIN_NVS_PATH");
+    path = env ? env : "nvs.txt";
+    load();
+    initialized = true;
+    ESP_LOGI(TAG, "Loaded %zu entries from %s", entries.size(), path.c_str());
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase() {
+    std::lock_guard guard(lock);
+    entries.clear();
+    if (!path.empty()) {
+        save();
+    }
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_deinit() {
+    std::lock_guard guard(lock);
+    initialized = false;
+    return ESP_OK;
+}
+
+esp_err_t nvs_open(const char *namespace_name, const nvs_open_mode_t open_mode, nvs_handle_t *out_handle) {
+    std::lock_guard guard(lock);
+    if (!initialized) {
+        return ESP_ERR_NVS_NOT_INITIALIZED;
+    }
+    if (!namespace_name || strlen(namespace_name) >= NVS_KEY_NAME_MAX_SIZE) {
+        return ESP_ERR_NVS_INVALID_NAME;
+    }
+    if (open_mode == NVS_READONLY) {
+        const std::string prefix = std::string(namespace_name) + "/";
+        const auto it = entries.lower_bound(prefix);
+        if (it == entries.end() || it->first.compare(0, prefix.size(), prefix) != 0) {
+            return ESP_ERR_NVS_NOT_FOUND;
+        }
+    }
+    for (size_t i = 0; i < MAX_HANDLES; ++i) {
+        if (!handles[i].open) {
+            handles[i] = {true, open_mode == NVS_READWRITE, namespace_name};
+            *out_handle = static_cast<nvs_handle_t>(i + 1);
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+}
+
+static Handle *get_handle(const nvs_handle_t handle) {
+    return handle >= 1 && handle <= MAX_HANDLES && handles[handle - 1].open ? &handles[handle - 1] : nullptr;
+}
+
+void nvs_close(const nvs_handle_t handle) {
+    std::lock_guard guard(lock);
+    if (Handle *h = get_handle(handle)) {
+        h->open = false;
+    }
+}
+
+esp_err_t nvs_commit(const nvs_handle_t handle) {
+    std::lock_guard guard(lock);
+    return get_handle(handle) ? ESP_OK : ESP_ERR_NVS_INVALID_HANDLE;
+}
+
+static esp_err_t set(const nvs_handle_t handle, const char *key, const Type type, const void *data,
+                     const size_t length) {
+    std::lock_guard guard(lock);
+    const Handle *h = get_handle(handle);
+    if (!h) {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    if (!h->writable) {
+        return ESP_ERR_NVS_READ_ONLY;
+    }
+    if (!key || strlen(key) >= NVS_KEY_NAME_MAX_SIZE) {
+        return ESP_ERR_NVS_KEY_TOO_LONG;
+    }
+    const auto *bytes = static_cast<const uint8_t *>(data);
+    entries[h->ns + "/" + key] = {type, std::vector<uint8_t>(bytes, bytes + length)};
+    save();
+    return ESP_OK;
+}
+
+static esp_err_t get(const nvs_handle_t handle, const char *key, const Type type, const Entry **out) {
+    const Handle *h = get_handle(handle);
+    if (!h) {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    const auto it = entries.find(h->ns + "/" + key);
+    if (it == entries.end()) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    if (it->second.type != type) {
+        return ESP_ERR_NVS_TYPE_MISMATCH;
+    }
+    *out = &it->second;
+    return ESP_OK;
+}
+
+template<typename T>
+static esp_err_t get_scalar(const nvs_handle_t handle, const char *key, const Type type, T *out_value) {
+    std::lock_guard guard(lock);
+    const Entry *entry = nullptr;
+    const esp_err_t err = get(handle, key, type, &entry);
+    if (err == ESP_OK) {
+        memcpy(out_value, entry->value.data(), sizeof(T));
+    }
+    return err;
+}
+
+static esp_err_t get_bytes(const nvs_handle_t handle, const char *key, const Type type, void *out_value,
+                           size_t *length) {
+    std::lock_guard guard(lock);
+    const Entry *entry = nullptr;
+    if (const esp_err_t err = get(handle, key, type, &entry); err != ESP_OK) {
+        return err;
+    }
+    if (!out_value) {
+        *length = entry->value.size();
+        return ESP_OK;
+    }
+    if (*length < entry->value.size()) {
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    memcpy(out_value, entry->value.data(), entry->value.size());
+    *length = entry->value.size();
+    return ESP_OK;
+}
+
+esp_err_t nvs_erase_key(const nvs_handle_t handle, const char *key) {
+    std::lock_guard guard(lock);
+    const Handle *h = get_handle(handle);
+    if (!h) {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    if (!h->writable) {
+        return ESP_ERR_NVS_READ_ONLY;
+    }
+    if (entries.erase(h->ns + "/" + key) == 0) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    save();
+    return ESP_OK;
+}
+
+esp_err_t nvs_erase_all(const nvs_handle_t handle) {
+    std::lock_guard guard(lock);
+    const Handle *h = get_handle(handle);
+    if (!h) {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    if (!h->writable) {
+        return ESP_ERR_NVS_READ_ONLY;
+    }
+    const std::string prefix = h->ns + "/";
+    for (auto it = entries.lower_bound(prefix); it != entries.end() && it->first.compare(0, prefix.size(), prefix) == 0;) {
+        it = entries.erase(it);
+    }
+    save();
+    return ESP_OK;
+}
+
+esp_err_t nvs_set_u8(const nvs_handle_t handle, const char *key, const uint8_t value) {
+    return set(handle, key, Type::U8, &value, sizeof(value));
+}
+
+esp_err_t nvs_set_u32(const nvs_handle_t handle, const char *key, const uint32_t value) {
+    return set(handle, key, Type::U32, &value, sizeof(value));
+}
+
+esp_err_t nvs_set_i32(const nvs_handle_t handle, const char *key, const int32_t value) {
+    return set(handle, key, Type::I32, &value, sizeof(value));
+}
+
+esp_err_t nvs_set_str(const nvs_handle_t handle, const char *key, const char *value) {
+    return set(handle, key, Type::STR, value, strlen(value) + 1);
+}
+
+esp_err_t nvs_set_blob(const nvs_handle_t handle, const char *key, const void *value, const size_t length) {
+    return set(handle, key, Type::BLOB, value, length);
+}
+
+esp_err_t nvs_get_u8(const nvs_handle_t handle, const char *key, uint8_t *out_value) {
+    return get_scalar(handle, key, Type::U8, out_value);
+}
+
+esp_err_t nvs_get_u32(const nvs_handle_t handle, const char *key, uint32_t *out_value) {
+    return get_scalar(handle, key, Type::U32, out_value);
+}
+
+esp_err_t nvs_get_i32(const nvs_handle_t handle, const char *key, int32_t *out_value) {
+    return get_scalar(handle, key, Type::I32, out_value);
+}
+
+esp_err_t nvs_get_str(const nvs_handle_t handle, const char *key, char *out_value, size_t *length) {
+    return get_bytes(handle, key, Type::STR, out_value, length);
+}
+
+esp_err_t nvs_get_blob(const nvs_handle_t handle, const char *key, void *out_value, size_t *length) {
+    return get_bytes(handle, key, Type::BLOB, out_value, length);
+}
@@ -0,0 +1,281 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#include <esp_ota_ops.h>
+#include <esp_partition.h>
+#include <esp_system.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <esp_log.h>
+#include <mutex>
+#include <openssl/sha.h>
+#include <string>
+#include <vector>
+
+static auto TAG = "ota";
+
+static constexpr uint32_t SLOT_SIZE = 0x400000;
+static constexpr esp_ota_handle_t HANDLE = 1;
+
+static const esp_partition_t slots[2] = {
+    {nullptr, ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_APP_OTA_0, 0x20000, SLOT_SIZE, 0x1000, "ota_0", false, false},
+    {nullptr, ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_APP_OTA_1, 0x420000, SLOT_SIZE, 0x1000, "ota_1", false, false},
+};
+
+static std::mutex lock;
+static bool loaded = false;
+static std::string dir;
+static int boot = 0;
+static int running = 0;
+static esp_ota_img_states_t states[2] = {ESP_OTA_IMG_UNDEFINED, ESP_OTA_IMG_UNDEFINED};
+
+// Update in progress
+static const esp_partition_t *writing = nullptr;
+static std::vector<uint8_t> image;
+
+static std::string slot_path(const int slot) {
+    return dir + "/" + slots[slot].label + ".bin";
+}
+
+static int slot_of(const esp_partition_t *partition) {
+    return partition == &slots[1] ? 1 : partition == &slots[0] ? 0 : -1;
+}
+
+static void save() {
+    const std::string path = dir + "/otadata.txt";
+    const std::string tmp = path + ".tmp";
+    FILE *f = fopen(tmp.c_str(), "w");
+    if (!f) {
+        ESP_LOGE(TAG, "Cannot write %s", tmp.c_str());
+        return;
+    }
+    fprintf(f, "%d %u %u\n", boot, static_cast<unsigned>(states[0]), static_cast<unsigned>(states[1]));
+    fclose(f);
+    rename(tmp.c_str(), path.c_str());
+}
+
+/**
+ * @brief Loads otadata and plays the bootloader's rollback step, once per process
+ */
+static void load() {
+    if (loaded) {
+        return;
+    }
+    loaded = true;
+    const char *env = getenv("SMART_FOUNTAIN_OTA_DIR");
+    dir = env ? env : ".";
+    if (FILE *f = fopen((dir + "/otadata.txt").c_str(), "r")) {
+        unsigned state0, state1;
+        if (fscanf(f, "%d %u %u", &boot, &state0, &state1) == 3 && (boot == 0 || boot == 1)) {
+            states[0] = static_cast<esp_ota_img_states_t>(state0);
+            states[1] = static_cast<esp_ota_img_states_t>(state1);
+        } else {
+            boot = 0;
+        }
+        fclose(f);
+    }
+    if (states[boot] == ESP_OTA_IMG_NEW) {
+        states[boot] = ESP_OTA_IMG_PENDING_VERIFY;
+        save();
+    } else if (states[boot] == ESP_OTA_IMG_PENDING_VERIFY) {
+        ESP_LOGW(TAG, "%s was not confirmed before the restart, rolling back", slots[boot].label);
+        states[boot] = ESP_OTA_IMG_ABORTED;
+        boot = 1 - boot;
+        save();
+    }
+    running = boot;
+    ESP_LOGI(TAG, "Running %s from %s", slots[running].label, dir.c_str());
+}
+
+static std::vector<uint8_t> read_slot(const int slot) {
+    std::vector<uint8_t> data;
+    if (FILE *f = fopen(slot_path(slot).c_str(), "rb")) {
+        uint8_t buf[65536];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+            data.insert(data.end(), buf, buf + n);
+        }
+        fclose(f);
+    }
+    return data;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *partition, const size_t src_offset, void *dst,
+                             const size_t size) {
+    std::lock_guard guard(lock);
+    load();
+    const int slot = slot_of(partition);
+    if (slot < 0 || src_offset + size > partition->size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(dst, 0xFF, size);
+    FILE *f = fopen(slot_path(slot).c_str(), "rb");
+    if (!f) {
+        return ESP_OK;
+    }
+    if (fseek(f, static_cast<long>(src_offset), SEEK_SET) == 0) {
+        const size_t n = fread(dst, 1, size, f);
+        static_cast<void>(n);
+    }
+    fclose(f);
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_get_sha256(const esp_partition_t *partition, uint8_t *sha_256) {
+    std::lock_guard guard(lock);
+    load();
+    const int slot = slot_of(partition);
+    if (slot < 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const std::vector<uint8_t> data = read_slot(slot);
+    size_t len = data.size();
+    // esptool image (magic 0xE9) with hash_appended set in its extended header
+    if (len > 24 + SHA256_DIGEST_LENGTH && data[0] == 0xE9 && data[23] == 1) {
+        len -= SHA256_DIGEST_LENGTH;
+    }
+    SHA256(data.data(), len, sha_256);
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_begin(const esp_partition_t *partition, const size_t image_size, esp_ota_handle_t *out_handle) {
+    std::lock_guard guard(lock);
+    load();
+    const int slot = slot_of(partition);
+    if (slot < 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (slot == running) {
+        return ESP_ERR_OTA_PARTITION_CONFLICT;
+    }
+    if (writing) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (image_size != OTA_SIZE_UNKNOWN && image_size != OTA_WITH_SEQUENTIAL_WRITES && image_size > SLOT_SIZE) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    writing = partition;
+    image.clear();
+    *out_handle = HANDLE;
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_write(const esp_ota_handle_t handle, const void *data, const size_t size) {
+    std::lock_guard guard(lock);
+    if (handle != HANDLE || !writing) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (image.size() + size > SLOT_SIZE) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    const auto *bytes = static_cast<const uint8_t *>(data);
+    image.insert(image.end(), bytes, bytes + size);
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_end(const esp_ota_handle_t handle) {
+    std::lock_guard guard(lock);
+    if (handle != HANDLE || !writing) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const int slot = slot_of(writing);
+    writing = nullptr;
+    if (image.empty()) {
+        return ESP_ERR_OTA_VALIDATE_FAILED;
+    }
+    const std::string path = slot_path(slot);
+    const std::string tmp = path + ".tmp";
+    FILE *f = fopen(tmp.c_str(), "wb");
+    if (!f) {
+        ESP_LOGE(TAG, "Cannot write %s", tmp.c_str());
+        return ESP_FAIL;
+    }
+    const bool written = fwrite(image.data(), 1, image.size(), f) == image.size();
+    fclose(f);
+    if (!written || rename(tmp.c_str(), path.c_str()) != 0) {
+        return ESP_FAIL;
+    }
+    states[slot] = ESP_OTA_IMG_UNDEFINED;
+    save();
+    image.clear();
+    image.shrink_to_fit();
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_abort(const esp_ota_handle_t handle) {
+    std::lock_guard guard(lock);
+    if (handle != HANDLE || !writing) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    writing = nullptr;
+    image.clear();
+    image.shrink_to_fit();
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_set_boot_partition(const esp_partition_t *partition) {
+    std::lock_guard guard(lock);
+    load();
+    const int slot = slot_of(partition);
+    if (slot < 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    boot = slot;
+    states[slot] = ESP_OTA_IMG_NEW;
+    save();
+    return ESP_OK;
+}
+
+const esp_partition_t *esp_ota_get_boot_partition() {
+    std::lock_guard guard(lock);
+    load();
+    return &slots[boot];
+}
+
+const esp_partition_t *esp_ota_get_running_partition() {
+    std::lock_guard guard(lock);
+    load();
+    return &slots[running];
+}
+
+const esp_partition_t *esp_ota_get_next_update_partition(const esp_partition_t *start_from) {
+    std::lock_guard guard(lock);
+    load();
+    const int from = start_from ? slot_of(start_from) : running;
+    return from < 0 ? nullptr : &slots[1 - from];
+}
+
+esp_err_t esp_ota_get_state_partition(const esp_partition_t *partition, esp_ota_img_states_t *ota_state) {
+    std::lock_guard guard(lock);
+    load();
+    const int slot = slot_of(partition);
+    if (slot < 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *ota_state = states[slot];
+    return states[slot] == ESP_OTA_IMG_UNDEFINED ? ESP_ERR_NOT_FOUND : ESP_OK;
+}
+
+esp_err_t esp_ota_mark_app_valid_cancel_rollback() {
+    std::lock_guard guard(lock);
+    load();
+    states[running] = ESP_OTA_IMG_VALID;
+    save();
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_mark_app_invalid_rollback_and_reboot() {
+    {
+        std::lock_guard guard(lock);
+        load();
+        states[running] = ESP_OTA_IMG_INVALID;
+        boot = 1 - running;
+        save();
+    }
+    esp_restart();
+}
@@ -0,0 +1,85 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#include <driver/ledc.h>
+#include <led_strip.h>
+
+#include <atomic>
+#include <esp_log.h>
+
+static auto TAG = "periph";
+
+static std::atomic<uint32_t> pending_duty[LEDC_CHANNEL_MAX];
+static std::atomic<uint32_t> duty[LEDC_CHANNEL_MAX];
+
+esp_err_t ledc_timer_config(const ledc_timer_config_t *config) {
+    if (!config || config->timer_num >= LEDC_TIMER_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    ESP_LOGI(TAG, "LEDC timer %d at %u Hz, %d bits", config->timer_num, static_cast<unsigned>(config->freq_hz),
+             config->duty_resolution);
+    return ESP_OK;
+}
+
+esp_err_t ledc_channel_config(const ledc_channel_config_t *config) {
+    if (!config || config->channel >= LEDC_CHANNEL_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pending_duty[config->channel].store(config->duty);
+    duty[config->channel].store(config->duty);
+    return ESP_OK;
+}
+
+esp_err_t ledc_set_duty([[maybe_unused]] ledc_mode_t speed_mode, const ledc_channel_t channel, const uint32_t value) {
+    if (channel >= LEDC_CHANNEL_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pending_duty[channel].store(value);
+    return ESP_OK;
+}
+
+esp_err_t ledc_update_duty([[maybe_unused]] ledc_mode_t speed_mode, const ledc_channel_t channel) {
+    if (channel >= LEDC_CHANNEL_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    duty[channel].store(pending_duty[channel].load());
+    return ESP_OK;
+}
+
+uint32_t ledc_get_duty([[maybe_unused]] ledc_mode_t speed_mode, const ledc_channel_t channel) {
+    return channel < LEDC_CHANNEL_MAX ? duty[channel].load() : 0;
+}
+
+struct led_strip_t {
+    uint32_t pending;
+    uint32_t shown;
+};
+
+esp_err_t led_strip_new_rmt_device([[maybe_unused]] const led_strip_config_t *led_config,
+                                   [[maybe_unused]] const led_strip_rmt_config_t *rmt_config,
+                                   led_strip_handle_t *ret_strip) {
+    static led_strip_t strip;
+    *ret_strip = &strip;
+    return ESP_OK;
+}
+
+esp_err_t led_strip_set_pixel(led_strip_handle_t strip, [[maybe_unused]] uint32_t index, const uint32_t red,
+                              const uint32_t green, const uint32_t blue) {
+    strip->pending = (red & 0xFF) << 16 | (green & 0xFF) << 8 | (blue & 0xFF);
+    return ESP_OK;
+}
+
+esp_err_t led_strip_refresh(led_strip_handle_t strip) {
+    if (strip->pending != strip->shown) {
+        ESP_LOGD(TAG, "LED #%06x", static_cast<unsigned>(strip->pending));
+        strip->shown = strip->pending;
+    }
+    return ESP_OK;
+}
+
+esp_err_t led_strip_clear(led_strip_handle_t strip) {
+    strip->pending = 0;
+    return led_strip_refresh(strip);
+}
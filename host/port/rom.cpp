@@ -0,0 +1,12 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#include <esp_rom_crc.h>
+
+#include <zlib.h>
+
+uint32_t esp_rom_crc32_le(const uint32_t crc, const uint8_t *buf, const uint32_t len) {
+    return static_cast<uint32_t>(crc32(crc, buf, len));
+}
@@ -0,0 +1,163 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#include <esp_mac.h>
+#include <esp_netif.h>
+#include <esp_system.h>
+#include <esp_timer.h>
+#include <esp_wifi.h>
+#include <host/wifi_sim.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <esp_log.h>
+#include <unistd.h>
+
+static auto TAG = "wifi";
+
+ESP_EVENT_DEFINE_BASE(WIFI_EVENT);
+ESP_EVENT_DEFINE_BASE(IP_EVENT);
+
+struct esp_netif_obj {
+    const char *name;
+};
+
+static esp_netif_obj sta_netif = {"sta"};
+static esp_netif_obj ap_netif = {"ap"};
+static wifi_mode_t mode = WIFI_MODE_NULL;
+static std::atomic<bool> link_up{false};
+static esp_timer_handle_t connect_timer = nullptr;
+static char **saved_argv = nullptr;
+
+// Association and DHCP take a moment on the device, keep the events asynchronous
+static constexpr uint64_t CONNECT_DELAY_US = 100 * 1000;
+
+static void on_connected([[maybe_unused]] void *arg) {
+    if (link_up.exchange(true)) {
+        return;
+    }
+    esp_event_post(WIFI_EVENT, WIFI_EVENT_STA_CONNECTED, nullptr, 0, portMAX_DELAY);
+    ip_event_got_ip_t got_ip = {};
+    got_ip.esp_netif = &sta_netif;
+    got_ip.ip_info.ip.addr = 0x0100007F; // 127.0.0.1
+    got_ip.ip_info.netmask.addr = 0x000000FF;
+    got_ip.ip_info.gw.addr = 0x0100007F;
+    got_ip.ip_changed = true;
+    esp_event_post(IP_EVENT, IP_EVENT_STA_GOT_IP, &got_ip, sizeof(got_ip), portMAX_DELAY);
+    ESP_LOGI(TAG, "Connected, got ip " IPSTR, IP2STR(&got_ip.ip_info.ip));
+}
+
+esp_err_t esp_netif_init() {
+    return ESP_OK;
+}
+
+esp_netif_t *esp_netif_create_default_wifi_ap() {
+    return &ap_netif;
+}
+
+esp_netif_t *esp_netif_create_default_wifi_sta() {
+    return &sta_netif;
+}
+
+esp_err_t esp_wifi_init([[maybe_unused]] const wifi_init_config_t *config) {
+    if (connect_timer) {
+        return ESP_OK;
+    }
+    const esp_timer_create_args_t args = {
+        .callback = on_connected,
+        .arg = nullptr,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "wifi_connect",
+        .skip_unhandled_events = false,
+    };
+    return esp_timer_create(&args, &connect_timer);
+}
+
+esp_err_t esp_wifi_set_mode(const wifi_mode_t new_mode) {
+    mode = new_mode;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_config(const wifi_interface_t interface, wifi_config_t *conf) {
+    if (!conf) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    ESP_LOGI(TAG, "%s configured for SSID %.32s", interface == WIFI_IF_AP ? "AP" : "STA",
+             reinterpret_cast<const char *>(interface == WIFI_IF_AP ? conf->ap.ssid : conf->sta.ssid));
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_start() {
+    if (mode == WIFI_MODE_AP || mode == WIFI_MODE_APSTA) {
+        esp_event_post(WIFI_EVENT, WIFI_EVENT_AP_START, nullptr, 0, portMAX_DELAY);
+    }
+    if (mode == WIFI_MODE_STA || mode == WIFI_MODE_APSTA) {
+        esp_event_post(WIFI_EVENT, WIFI_EVENT_STA_START, nullptr, 0, portMAX_DELAY);
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_stop() {
+    esp_wifi_disconnect();
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_connect() {
+    if (!connect_timer) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_timer_stop(connect_timer);
+    return esp_timer_start_once(connect_timer, CONNECT_DELAY_US);
+}
+
+esp_err_t esp_wifi_disconnect() {
+    if (!link_up.exchange(false)) {
+        return ESP_OK;
+    }
+    wifi_event_sta_disconnected_t event = {};
+    event.reason = 8; // WIFI_REASON_ASSOC_LEAVE
+    esp_event_post(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, &event, sizeof(event), portMAX_DELAY);
+    return ESP_OK;
+}
+
+void wifi_sim_drop() {
+    ESP_LOGW(TAG, "Simulating link loss");
+    esp_wifi_disconnect();
+}
+
+void wifi_sim_restore() {
+    ESP_LOGI(TAG, "Simulating link recovery");
+    esp_wifi_connect();
+}
+
+esp_err_t esp_read_mac(uint8_t *mac, const esp_mac_type_t type) {
+    char host[64] = {};
+    gethostname(host, sizeof(host) - 1);
+    uint32_t hash = 2166136261u;
+    for (const char *p = host; *p; ++p) {
+        hash = (hash ^ static_cast<uint8_t>(*p)) * 16777619u;
+    }
+    // Espressif OUI, then the host hash; derived MACs differ in the last byte like on the device
+    mac[0] = 0x24;
+    mac[1] = 0x58;
+    mac[2] = 0x7c;
+    mac[3] = static_cast<uint8_t>(hash >> 16);
+    mac[4] = static_cast<uint8_t>(hash >> 8);
+    mac[5] = static_cast<uint8_t>(hash + static_cast<uint32_t>(type));
+    return ESP_OK;
+}
+
+void system_sim_init([[maybe_unused]] int argc, char **argv) {
+    saved_argv = argv;
+}
+
+void esp_restart() {
+    ESP_LOGW(TAG, "Restarting");
+    fflush(nullptr);
+    if (saved_argv) {
+        execv("/proc/self/exe", saved_argv);
+    }
+    _exit(0);
+}
@@ -0,0 +1,142 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+// Checks the ULP sampling decisions (include/scale/UlpSampling.h) for every reason to wake the main CPU and for a
+// conversion that never becomes ready. Run by ctest, the exit code is 1 if any check fails.
+
+#include <cstdio>
+
+#include "scale/UlpSampling.h"
+
+static int failures = 0;
+
+#define CHECK_EQ(actual, expected)                                                                  \
+    do {                                                                                            \
+        const long long a_ = static_cast<long long>(actual);                                        \
+        const long long e_ = static_cast<long long>(expected);                                      \
+        if (a_ != e_) {                                                                             \
+            fprintf(stderr, "%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, a_, e_); \
+            ++failures;                                                                             \
+        }                                                                                           \
+    } while (0)
+
+namespace {
+    // Offset binary like HX711::read_once, zero load at mid-scale
+    constexpr int32_t ZERO = 0x800000;
+
+    constexpr ulp_sampling_config_t CONFIG = {
+        .clk_gpio = 1,
+        .data_gpio = 2,
+        .gain_pulses = 1,
+        .sample_runs = 3,
+        .ready_runs = 2,
+        .wake_delta = 100,
+        .wake_confirm = 2,
+        .record_delta = 10,
+        .report_samples = 0,
+    };
+
+    struct Armed {
+        ulp_sampling_state_t state;
+
+        Armed() { ulp_sampling_reset(&state); }
+    };
+}
+
+static void wakes_on_change() {
+    Armed ulp;
+    CHECK_EQ(ulp_sampling_on_sample(&CONFIG, &ulp.state, ZERO), ULP_WAKE_NONE);
+    CHECK_EQ(ulp_sampling_on_sample(&CONFIG, &ulp.state, ZERO + 150), ULP_WAKE_NONE);
+    CHECK_EQ(ulp_sampling_on_sample(&CONFIG, &ulp.state, ZERO + 150), ULP_WAKE_CHANGE);
+    CHECK_EQ(ulp.state.wake_reason, ULP_WAKE_CHANGE);
+    CHECK_EQ(ulp.state.reference, ZERO);
+    // A moving weight is recorded once per record_delta step
+    CHECK_EQ(ulp.state.count, 2);
+    // Nothing runs until the main CPU re-arms the program
+    CHECK_EQ(ulp_sampling_run(&CONFIG, &ulp.state, true), ULP_ACTION_NONE);
+}
+
+static void rejects_spike() {
+    Armed ulp;
+    CHECK_EQ(ulp_sampling_on_sample(&CONFIG, &ulp.state, ZERO), ULP_WAKE_NONE);
+    CHECK_EQ(ulp_sampling_on_sample(&CONFIG, &ulp.state, ZERO - 300), ULP_WAKE_NONE);
+    CHECK_EQ(ulp.state.beyond, 1);
+    CHECK_EQ(ulp_sampling_on_sample(&CONFIG, &ulp.state, ZERO + 5), ULP_WAKE_NONE);
+    CHECK_EQ(ulp.state.beyond, 0);
+    CHECK_EQ(ulp_sampling_on_sample(&CONFIG, &ulp.state, ZERO - 300), ULP_WAKE_NONE);
+    CHECK_EQ(ulp_sampling_on_sample(&CONFIG, &ulp.state, ZERO), ULP_WAKE_NONE);
+    CHECK_EQ(ulp.state.wake_reason, ULP_WAKE_NONE);
+}
+
+static void wakes_on_full_history() {
+    ulp_sampling_config_t config = CONFIG;
+    config.wake_delta = 1000000;
+    Armed ulp;
+    for (int32_t i = 0; i < ULP_HISTORY_CAPACITY - 1; ++i) {
+        CHECK_EQ(ulp_sampling_on_sample(&config, &ulp.state, ZERO + i * 20), ULP_WAKE_NONE);
+        // Within record_delta of the last recorded reading, not recorded
+        CHECK_EQ(ulp_sampling_on_sample(&config, &ulp.state, ZERO + i * 20 + 5), ULP_WAKE_NONE);
+    }
+    CHECK_EQ(ulp.state.count, ULP_HISTORY_CAPACITY - 1);
+    CHECK_EQ(ulp_sampling_on_sample(&config, &ulp.state, ZERO + ULP_HISTORY_CAPACITY * 20), ULP_WAKE_FULL);
+    CHECK_EQ(ulp.state.count, ULP_HISTORY_CAPACITY);
+}
+
+static void change_takes_precedence_over_full() {
+    ulp_sampling_config_t config = CONFIG;
+    config.wake_delta = 1000;
+    config.wake_confirm = 1;
+    Armed ulp;
+    for (int32_t i = 0; i < ULP_HISTORY_CAPACITY - 1; ++i) {
+        CHECK_EQ(ulp_sampling_on_sample(&config, &ulp.state, ZERO + i * 20), ULP_WAKE_NONE);
+    }
+    // Fills the history and moves beyond wake_delta at once
+    CHECK_EQ(ulp_sampling_on_sample(&config, &ulp.state, ZERO + 5000), ULP_WAKE_CHANGE);
+    CHECK_EQ(ulp.state.count, ULP_HISTORY_CAPACITY);
+}
+
+static void wakes_when_report_due() {
+    ulp_sampling_config_t config = CONFIG;
+    config.report_samples = 5;
+    Armed ulp;
+    for (int i = 0; i < 4; ++i) {
+        CHECK_EQ(ulp_sampling_on_sample(&config, &ulp.state, ZERO + 1), ULP_WAKE_NONE);
+    }
+    CHECK_EQ(ulp_sampling_on_sample(&config, &ulp.state, ZERO + 1), ULP_WAKE_REPORT);
+    CHECK_EQ(ulp.state.count, 1);
+}
+
+static void powers_down_on_ready_timeout() {
+    Armed ulp;
+    // Powered down for sample_runs runs, then SCK goes low
+    CHECK_EQ(ulp_sampling_run(&CONFIG, &ulp.state, false), ULP_ACTION_NONE);
+    CHECK_EQ(ulp_sampling_run(&CONFIG, &ulp.state, false), ULP_ACTION_NONE);
+    CHECK_EQ(ulp_sampling_run(&CONFIG, &ulp.state, false), ULP_ACTION_POWER_UP);
+    // DOUT stays high for ready_runs runs, the conversion is given up without waking
+    CHECK_EQ(ulp_sampling_run(&CONFIG, &ulp.state, false), ULP_ACTION_NONE);
+    CHECK_EQ(ulp_sampling_run(&CONFIG, &ulp.state, false), ULP_ACTION_POWER_DOWN);
+    CHECK_EQ(ulp.state.timeouts, 1);
+    CHECK_EQ(ulp.state.powered, 0);
+    CHECK_EQ(ulp.state.wake_reason, ULP_WAKE_NONE);
+    // The wait counted towards the interval, the next cycle starts one run later and reads
+    CHECK_EQ(ulp_sampling_run(&CONFIG, &ulp.state, false), ULP_ACTION_POWER_UP);
+    CHECK_EQ(ulp_sampling_run(&CONFIG, &ulp.state, true), ULP_ACTION_READ);
+    CHECK_EQ(ulp.state.timeouts, 1);
+    CHECK_EQ(ulp.state.ticks, 7);
+}
+
+int main() {
+    wakes_on_change();
+    rejects_spike();
+    wakes_on_full_history();
+    change_takes_precedence_over_full();
+    wakes_when_report_due();
+    powers_down_on_ready_timeout();
+    if (failures) {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
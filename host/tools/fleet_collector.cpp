@@ -0,0 +1,820 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+// Scrapes /scale and /metrics from many fountains and serves them as one Prometheus exposition, so a single scrape
+// job covers the whole fleet and offline devices cannot stall it. One thread drives every device through epoll: a
+// scrape connects without blocking, fetches both routes over one keep-alive connection and must finish within
+// --timeout. Failed devices are retried with exponential backoff up to --max-backoff and reported with fleet_up 0.
+//
+//   fleet_collector [--listen 9100] [--interval 15] [--timeout 2] [--max-backoff 300] [--concurrency 64]
+//                   [--targets devices.txt] [--scan 192.168.1.0/24[:80] ...] [--rescan 300] [--once]
+//                   [[name=]host[:port] ...]
+//
+// Targets come from the arguments and from --targets, one per line with # comments; the port defaults to 80.
+// --scan discovers devices by probing every address of a subnet for the firmware's /health response, addresses
+// that did not answer are probed again every --rescan seconds. Device metrics get a device="<name>" label, the
+// name defaults to host:port, and numeric /scale fields become fleet_scale_<field> gauges. The exposition is served
+// on GET /metrics of --listen; --once scrapes every device once instead, prints the exposition and exits with 1 if
+// no device answered. The exit code is 2 on usage errors.
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <random>
+#include <string>
+#include <string_view>
+#include <strings.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+    struct Options {
+        std::string listen = "9100";
+        double interval_s = 15;
+        double timeout_s = 2;
+        double max_backoff_s = 300;
+        double rescan_s = 300;
+        int concurrency = 64;
+        bool once = false;
+        std::vector<std::string> targets;
+        std::vector<std::string> scans;
+    };
+
+    struct Device {
+        std::string name;
+        sockaddr_storage addr{};
+        socklen_t addr_len = 0;
+        std::string host_header;
+        bool confirmed = true;  ///< Listed, or found by a scan and answered /health
+        bool done = false;      ///< --once: nothing more to do for this device
+
+        int fd = -1;
+        bool connected = false;
+        size_t step = 0;        ///< Index into the routes of the current scrape
+        std::string request;
+        size_t written = 0;
+        std::string response;
+        std::vector<std::string> bodies;
+        Clock::time_point started;
+        Clock::time_point deadline;
+        Clock::time_point next_scrape;
+
+        bool up = false;
+        uint32_t failures = 0;  ///< Consecutive, drives the backoff
+        uint64_t failures_total = 0;
+        double duration_s = 0;
+        std::string scale;      ///< Bodies of the last successful scrape, cleared when it fails
+        std::string metrics;
+    };
+
+    struct Client {
+        int fd = -1;
+        std::string request;
+        std::string response;
+        size_t written = 0;
+    };
+
+    struct Family {
+        std::string help;
+        std::string type;
+        std::string samples;
+    };
+}
+
+static const std::vector<std::string> SCRAPE_ROUTES = {"/scale", "/metrics"};
+static const std::vector<std::string> PROBE_ROUTES = {"/health"};
+
+// epoll data of the listener and the exposition clients, device events carry the device index
+static constexpr uint64_t LISTENER_ID = ~0ULL;
+static constexpr uint64_t CLIENT_BIT = 1ULL << 62;
+
+static const std::vector<std::string> &routes(const Device &d) {
+    return d.confirmed ? SCRAPE_ROUTES : PROBE_ROUTES;
+}
+
+static double seconds(const Clock::duration d) {
+    return std::chrono::duration<double>(d).count();
+}
+
+static Clock::duration from_seconds(const double s) {
+    return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(s));
+}
+
+/**
+ * @brief Resolves "[name=]host[:port]", once at startup
+ */
+static bool add_target(const std::string &spec, std::vector<Device> &devices) {
+    std::string name;
+    std::string target = spec;
+    if (const size_t eq = spec.find('='); eq != std::string::npos) {
+        name = spec.substr(0, eq);
+        target = spec.substr(eq + 1);
+    }
+    std::string host = target;
+    std::string port = "80";
+    if (const size_t colon = target.rfind(':'); colon != std::string::npos && target.find(':') == colon) {
+        host = target.substr(0, colon);
+        port = target.substr(colon + 1);
+    }
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *result = nullptr;
+    if (host.empty() || getaddrinfo(host.c_str(), port.c_str(), &hints, &result) != 0) {
+        fprintf(stderr, "cannot resolve %s\n", target.c_str());
+        return false;
+    }
+    Device d;
+    d.name = name.empty() ? host + ":" + port : name;
+    memcpy(&d.addr, result->ai_addr, result->ai_addrlen);
+    d.addr_len = result->ai_addrlen;
+    d.host_header = host;
+    freeaddrinfo(result);
+    devices.push_back(std::move(d));
+    return true;
+}
+
+static bool read_targets(const std::string &path, std::vector<std::string> &targets) {
+    std::ifstream in(path);
+    if (!in) {
+        fprintf(stderr, "cannot read %s: %s\n", path.c_str(), strerror(errno));
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        line = line.substr(0, line.find('#'));
+        const size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos) {
+            continue;
+        }
+        targets.push_back(line.substr(first, line.find_last_not_of(" \t\r") + 1 - first));
+    }
+    return true;
+}
+
+/**
+ * @brief Adds one unconfirmed device per host address of "a.b.c.d/prefix[:port]"
+ */
+static bool add_scan(const std::string &spec, std::vector<Device> &devices) {
+    const size_t slash = spec.find('/');
+    const size_t colon = spec.find(':', slash == std::string::npos ? 0 : slash);
+    const std::string network = spec.substr(0, std::min(slash, colon));
+    const int prefix = slash == std::string::npos ? 32 : atoi(spec.c_str() + slash + 1);
+    const auto port = static_cast<uint16_t>(colon == std::string::npos ? 80 : atoi(spec.c_str() + colon + 1));
+    in_addr base{};
+    if (inet_pton(AF_INET, network.c_str(), &base) != 1 || prefix < 16 || prefix > 32 || port == 0) {
+        fprintf(stderr, "invalid scan %s, expected an IPv4 subnet of at most /16 like 192.168.1.0/24:80\n",
+                spec.c_str());
+        return false;
+    }
+    const uint32_t mask = prefix == 32 ? ~0U : ~(~0U >> prefix);
+    uint32_t first = ntohl(base.s_addr) & mask;
+    uint32_t last = first | ~mask;
+    if (prefix < 31) {
+        // Skip the network and broadcast addresses
+        ++first;
+        --last;
+    }
+    for (uint32_t ip = first; ip <= last && ip >= first; ++ip) {
+        Device d;
+        auto *sin = reinterpret_cast<sockaddr_in *>(&d.addr);
+        sin->sin_family = AF_INET;
+        sin->sin_port = htons(port);
+        sin->sin_addr.s_addr = htonl(ip);
+        d.addr_len = sizeof(sockaddr_in);
+        char text[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &sin->sin_addr, text, sizeof(text));
+        d.host_header = text;
+        d.name = d.host_header + ":" + std::to_string(port);
+        d.confirmed = false;
+        devices.push_back(std::move(d));
+    }
+    return true;
+}
+
+/**
+ * @brief Returns the length of the complete response at the start of buf, 0 if more bytes are needed
+ * or -1 if it cannot be parsed. Sets status, whether the server closes the connection and the decoded body.
+ */
+static ssize_t response_length(const std::string &buf, int &status, bool &close_after, std::string &body) {
+    const size_t head_end = buf.find("\r\n\r\n");
+    if (head_end == std::string::npos) {
+        return 0;
+    }
+    if (buf.compare(0, 9, "HTTP/1.1 ") != 0 && buf.compare(0, 9, "HTTP/1.0 ") != 0) {
+        return -1;
+    }
+    status = atoi(buf.c_str() + 9);
+    close_after = buf.compare(0, 9, "HTTP/1.0 ") == 0;
+    const size_t start = head_end + 4;
+
+    ssize_t content_length = -1;
+    bool chunked = false;
+    for (size_t line = buf.find("\r\n") + 2; line < head_end;) {
+        const size_t eol = buf.find("\r\n", line);
+        const std::string_view header(buf.data() + line, eol - line);
+        const size_t colon = header.find(':');
+        if (colon != std::string_view::npos) {
+            const std::string_view name = header.substr(0, colon);
+            std::string_view value = header.substr(colon + 1);
+            while (!value.empty() && value.front() == ' ') {
+                value.remove_prefix(1);
+            }
+            auto is = [&](const char *expected) {
+                return name.size() == strlen(expected) && strncasecmp(name.data(), expected, name.size()) == 0;
+            };
+            if (is("Content-Length")) {
+                content_length = strtol(std::string(value).c_str(), nullptr, 10);
+            } else if (is("Transfer-Encoding")) {
+                chunked = value.find("chunked") != std::string_view::npos;
+            } else if (is("Connection")) {
+                close_after = strncasecmp(value.data(), "close", 5) == 0;
+            }
+        }
+        line = eol + 2;
+    }
+
+    if (!chunked) {
+        if (content_length < 0) {
+            return -1;
+        }
+        if (buf.size() < start + content_length) {
+            return 0;
+        }
+        body.assign(buf, start, content_length);
+        return static_cast<ssize_t>(start + content_length);
+    }
+    body.clear();
+    size_t pos = start;
+    for (;;) {
+        const size_t eol = buf.find("\r\n", pos);
+        if (eol == std::string::npos) {
+            return 0;
+        }
+        const size_t size = strtoul(buf.c_str() + pos, nullptr, 16);
+        if (size == 0) {
+            // No trailers are sent, the last chunk ends with an empty line
+            return buf.size() >= eol + 4 ? static_cast<ssize_t>(eol + 4) : 0;
+        }
+        if (buf.size() < eol + 2 + size + 2) {
+            return 0;
+        }
+        body.append(buf, eol + 2, size);
+        pos = eol + 2 + size + 2;
+    }
+}
+
+static void append_label(std::string &out, const std::string &name) {
+    out += "device=\"";
+    for (const char c: name) {
+        if (c == '\\' || c == '"') {
+            out += '\\';
+        } else if (c == '\n') {
+            out += "\\n";
+            continue;
+        }
+        out += c;
+    }
+    out += '"';
+}
+
+/**
+ * @brief Copies one exposition sample with the device label added as the first label
+ */
+static void append_sample(std::string &out, const std::string_view line, const std::string &device) {
+    const size_t name_end = line.find_first_of("{ ");
+    if (name_end == std::string_view::npos) {
+        return;
+    }
+    out.append(line.substr(0, name_end));
+    out += '{';
+    append_label(out, device);
+    if (line[name_end] == '{') {
+        if (line.size() > name_end + 1 && line[name_end + 1] != '}') {
+            out += ',';
+        }
+        out.append(line.substr(name_end + 1));
+    } else {
+        out += '}';
+        out.append(line.substr(name_end));
+    }
+    out += '\n';
+}
+
+/**
+ * @brief Splits a device's /metrics into families, so samples of all devices end up under one HELP and TYPE
+ */
+static void merge_metrics(const Device &d, std::vector<Family> &families,
+                          std::unordered_map<std::string, size_t> &index) {
+    auto family = [&](const std::string_view name) -> Family & {
+        const auto [it, added] = index.try_emplace(std::string(name), families.size());
+        if (added) {
+            families.emplace_back();
+        }
+        return families[it->second];
+    };
+    std::string current;
+    std::string_view text = d.metrics;
+    while (!text.empty()) {
+        const size_t eol = text.find('\n');
+        const std::string_view line = text.substr(0, eol);
+        text.remove_prefix(eol == std::string_view::npos ? text.size() : eol + 1);
+        if (line.starts_with("# HELP ") || line.starts_with("# TYPE ")) {
+            const std::string_view rest = line.substr(7);
+            current = std::string(rest.substr(0, rest.find(' ')));
+            Family &f = family(current);
+            std::string &header = line[2] == 'H' ? f.help : f.type;
+            if (header.empty()) {
+                header = std::string(line) + "\n";
+            }
+            continue;
+        }
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        // Histogram _bucket, _sum and _count samples belong to the family declared before them
+        const std::string_view name = line.substr(0, line.find_first_of("{ "));
+        append_sample(family(!current.empty() && name.starts_with(current) ? std::string_view(current) : name).samples,
+                      line, d.name);
+    }
+}
+
+/**
+ * @brief Appends a sample per numeric top-level field of a /scale body
+ */
+static void merge_scale(const Device &d, std::vector<Family> &families,
+                        std::unordered_map<std::string, size_t> &index) {
+    const std::string &json = d.scale;
+    int depth = 0;
+    for (size_t i = 0; i < json.size(); ++i) {
+        const char c = json[i];
+        if (c == '{' || c == '[') {
+            ++depth;
+        } else if (c == '}' || c == ']') {
+            --depth;
+        } else if (c == '"') {
+            const size_t end = json.find('"', i + 1);
+            if (end == std::string::npos) {
+                return;
+            }
+            const size_t colon = json.find_first_not_of(' ', end + 1);
+            if (depth == 1 && colon != std::string::npos && json[colon] == ':') {
+                const char *value = json.c_str() + colon + 1;
+                char *value_end = nullptr;
+                strtod(value, &value_end);
+                if (value_end != value) {
+                    std::string name = "fleet_scale_" + json.substr(i + 1, end - i - 1);
+                    std::replace_if(name.begin(), name.end(), [](const char ch) { return !isalnum(ch) && ch != '_'; },
+                                    '_');
+                    const auto [it, added] = index.try_emplace(name, families.size());
+                    if (added) {
+                        families.push_back({"# HELP " + name + " Field of the device's /scale response\n",
+                                            "# TYPE " + name + " gauge\n", ""});
+                    }
+                    std::string &out = families[it->second].samples;
+                    out += name + "{";
+                    append_label(out, d.name);
+                    // The number as the device wrote it
+                    out += "} ";
+                    out.append(value, value_end - value);
+                    out += '\n';
+                }
+            }
+            i = end;
+        }
+    }
+}
+
+static std::string exposition(const std::vector<Device> &devices) {
+    std::vector<Family> families;
+    std::unordered_map<std::string, size_t> index;
+    static constexpr const char *OWN[][3] = {
+        {"fleet_up", "1 if the last scrape of the device succeeded", "gauge"},
+        {"fleet_scrape_duration_seconds", "Duration of the last scrape of the device", "gauge"},
+        {"fleet_scrape_failures_total", "Failed scrapes of the device", "counter"},
+    };
+    for (const auto &[name, help, type]: OWN) {
+        index.emplace(name, families.size());
+        families.push_back({std::string("# HELP ") + name + " " + help + "\n",
+                            std::string("# TYPE ") + name + " " + type + "\n", ""});
+    }
+
+    size_t count = 0;
+    char number[64];
+    for (const Device &d: devices) {
+        if (!d.confirmed) {
+            continue;
+        }
+        ++count;
+        const std::pair<size_t, double> own_samples[] = {
+            {0, d.up ? 1.0 : 0.0}, {1, d.duration_s}, {2, static_cast<double>(d.failures_total)},
+        };
+        for (const auto &[family, value]: own_samples) {
+            std::string &out = families[family].samples;
+            out += OWN[family][0];
+            out += '{';
+            append_label(out, d.name);
+            snprintf(number, sizeof(number), "} %.6g\n", value);
+            out += number;
+        }
+        if (d.up) {
+            merge_scale(d, families, index);
+            merge_metrics(d, families, index);
+        }
+    }
+
+    snprintf(number, sizeof(number), "%zu", count);
+    std::string out = std::string("# HELP fleet_devices Devices listed or discovered\n# TYPE fleet_devices gauge\n"
+                                  "fleet_devices ") + number + "\n";
+    for (const Family &f: families) {
+        out += f.help;
+        out += f.type;
+        out += f.samples;
+    }
+    return out;
+}
+
+static int open_listener(const std::string &port) {
+    const int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    const int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(atoi(port.c_str())));
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 || listen(fd, 16) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int main(const int argc, char **argv) {
+    Options opt;
+    std::string targets_file;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (!arg.starts_with("--")) {
+            opt.targets.push_back(arg);
+            continue;
+        }
+        if (arg == "--once") {
+            opt.once = true;
+            continue;
+        }
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            fprintf(stderr, "missing value for %s\n", arg.c_str());
+            return 2;
+        }
+        ++i;
+        if (arg == "--listen") {
+            opt.listen = value;
+        } else if (arg == "--interval") {
+            opt.interval_s = strtod(value, nullptr);
+        } else if (arg == "--timeout") {
+            opt.timeout_s = strtod(value, nullptr);
+        } else if (arg == "--max-backoff") {
+            opt.max_backoff_s = strtod(value, nullptr);
+        } else if (arg == "--rescan") {
+            opt.rescan_s = strtod(value, nullptr);
+        } else if (arg == "--concurrency") {
+            opt.concurrency = atoi(value);
+        } else if (arg == "--targets") {
+            targets_file = value;
+        } else if (arg == "--scan") {
+            opt.scans.emplace_back(value);
+        } else {
+            fprintf(stderr, "unknown option %s\n", arg.c_str());
+            return 2;
+        }
+    }
+    if (!targets_file.empty() && !read_targets(targets_file, opt.targets)) {
+        return 2;
+    }
+    if (opt.interval_s <= 0 || opt.timeout_s <= 0 || opt.concurrency < 1) {
+        fprintf(stderr, "--interval, --timeout and --concurrency must be positive\n");
+        return 2;
+    }
+
+    std::vector<Device> devices;
+    for (const std::string &target: opt.targets) {
+        if (!add_target(target, devices)) {
+            return 2;
+        }
+    }
+    for (const std::string &scan: opt.scans) {
+        if (!add_scan(scan, devices)) {
+            return 2;
+        }
+    }
+    if (devices.empty()) {
+        fprintf(stderr, "no targets, pass host[:port] arguments, --targets or --scan\n");
+        return 2;
+    }
+
+    const int ep = epoll_create1(EPOLL_CLOEXEC);
+    int listener = -1;
+    if (!opt.once) {
+        listener = open_listener(opt.listen);
+        if (listener < 0) {
+            fprintf(stderr, "cannot listen on port %s: %s\n", opt.listen.c_str(), strerror(errno));
+            return 2;
+        }
+        epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.u64 = LISTENER_ID;
+        epoll_ctl(ep, EPOLL_CTL_ADD, listener, &ev);
+        fprintf(stderr, "collecting %zu devices, serving the exposition on :%s/metrics\n", devices.size(),
+                opt.listen.c_str());
+    }
+
+    // Spread the first scrapes over one interval, so a large fleet is not scraped in bursts
+    std::minstd_rand rng(static_cast<unsigned>(getpid()));
+    Clock::time_point now = Clock::now();
+    for (size_t i = 0; i < devices.size(); ++i) {
+        devices[i].next_scrape = opt.once ? now : now + from_seconds(opt.interval_s * i / devices.size());
+    }
+    auto jittered = [&](const double s) {
+        return from_seconds(s * std::uniform_real_distribution(0.9, 1.1)(rng));
+    };
+
+    int active = 0;
+    std::vector<Client> clients;
+    std::vector<size_t> due;
+    char buf[16384];
+
+    auto watch = [&](const int fd, const uint32_t events, const uint64_t id, const int op) {
+        epoll_event ev = {};
+        ev.events = events;
+        ev.data.u64 = id;
+        epoll_ctl(ep, op, fd, &ev);
+    };
+    auto next_request = [&](Device &d, const size_t index) {
+        d.request = "GET " + routes(d)[d.step] + " HTTP/1.1\r\nHost: " + d.host_header + "\r\n\r\n";
+        d.written = 0;
+        d.response.clear();
+        watch(d.fd, EPOLLOUT, index, EPOLL_CTL_MOD);
+    };
+    auto connect_device = [&](Device &d, const size_t index) {
+        d.fd = socket(d.addr.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        const int one = 1;
+        setsockopt(d.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        d.connected = false;
+        if (connect(d.fd, reinterpret_cast<sockaddr *>(&d.addr), d.addr_len) != 0 && errno != EINPROGRESS) {
+            return false;
+        }
+        watch(d.fd, EPOLLOUT, index, EPOLL_CTL_ADD);
+        return true;
+    };
+    auto finish = [&](Device &d, const bool ok, const char *error) {
+        if (d.fd >= 0) {
+            epoll_ctl(ep, EPOLL_CTL_DEL, d.fd, nullptr);
+            close(d.fd);
+            d.fd = -1;
+        }
+        --active;
+        now = Clock::now();
+        if (!d.confirmed) {
+            // A discovery probe, only devices answering like the firmware's /health are scraped
+            if (ok && d.bodies[0].find("\"status\"") != std::string::npos) {
+                d.confirmed = true;
+                d.next_scrape = now;
+                fprintf(stderr, "discovered %s\n", d.name.c_str());
+            } else {
+                d.next_scrape = now + jittered(opt.rescan_s);
+                d.done = opt.once;
+            }
+            return;
+        }
+        d.duration_s = seconds(now - d.started);
+        d.done = opt.once;
+        if (ok) {
+            if (!d.up) {
+                fprintf(stderr, "%s up\n", d.name.c_str());
+            }
+            d.up = true;
+            d.failures = 0;
+            d.scale = std::move(d.bodies[0]);
+            d.metrics = std::move(d.bodies[1]);
+            // Scheduled from the start of the scrape, so the interval does not drift by the scrape duration
+            d.next_scrape = d.started + jittered(opt.interval_s);
+            return;
+        }
+        if (d.up || d.failures == 0) {
+            fprintf(stderr, "%s down: %s\n", d.name.c_str(), error);
+        }
+        d.up = false;
+        d.scale.clear();
+        d.metrics.clear();
+        ++d.failures_total;
+        // The first retry comes after one interval, then the delay doubles up to --max-backoff
+        const double backoff = std::min(opt.interval_s * std::pow(2.0, std::min<uint32_t>(d.failures, 16)),
+                                        std::max(opt.max_backoff_s, opt.interval_s));
+        ++d.failures;
+        d.next_scrape = now + jittered(backoff);
+    };
+    auto start = [&](Device &d, const size_t index) {
+        ++active;
+        d.started = now;
+        d.deadline = now + from_seconds(opt.timeout_s);
+        d.step = 0;
+        d.bodies.assign(routes(d).size(), {});
+        if (!connect_device(d, index)) {
+            finish(d, false, strerror(errno));
+            return;
+        }
+        next_request(d, index);
+    };
+    auto on_device = [&](const size_t index) {
+        Device &d = devices[index];
+        if (d.fd < 0) {
+            return;
+        }
+        if (!d.connected) {
+            int err = 0;
+            socklen_t len = sizeof(err);
+            getsockopt(d.fd, SOL_SOCKET, SO_ERROR, &err, &len);
+            if (err != 0) {
+                finish(d, false, strerror(err));
+                return;
+            }
+            d.connected = true;
+        }
+        if (d.written < d.request.size()) {
+            const ssize_t sent = send(d.fd, d.request.data() + d.written, d.request.size() - d.written, MSG_NOSIGNAL);
+            if (sent < 0 && errno != EAGAIN) {
+                finish(d, false, strerror(errno));
+                return;
+            }
+            d.written += sent > 0 ? static_cast<size_t>(sent) : 0;
+            if (d.written == d.request.size()) {
+                watch(d.fd, EPOLLIN, index, EPOLL_CTL_MOD);
+            }
+            return;
+        }
+        const ssize_t got = recv(d.fd, buf, sizeof(buf), 0);
+        if (got <= 0) {
+            if (got < 0 && errno == EAGAIN) {
+                return;
+            }
+            finish(d, false, got == 0 ? "connection closed" : strerror(errno));
+            return;
+        }
+        d.response.append(buf, got);
+        int status = 0;
+        bool close_after = false;
+        const ssize_t len = response_length(d.response, status, close_after, d.bodies[d.step]);
+        if (len == 0) {
+            return;
+        }
+        if (len < 0 || status != 200) {
+            char error[64];
+            if (len < 0) {
+                snprintf(error, sizeof(error), "invalid response to %s", routes(d)[d.step].c_str());
+            } else {
+                snprintf(error, sizeof(error), "HTTP %d from %s", status, routes(d)[d.step].c_str());
+            }
+            finish(d, false, error);
+            return;
+        }
+        if (++d.step == routes(d).size()) {
+            finish(d, true, nullptr);
+            return;
+        }
+        if (close_after) {
+            epoll_ctl(ep, EPOLL_CTL_DEL, d.fd, nullptr);
+            close(d.fd);
+            if (!connect_device(d, index)) {
+                finish(d, false, strerror(errno));
+                return;
+            }
+        }
+        next_request(d, index);
+    };
+    auto close_client = [&](const size_t slot) {
+        close(clients[slot].fd);
+        clients[slot] = {};
+    };
+    auto on_client = [&](const size_t slot) {
+        Client &c = clients[slot];
+        if (c.response.empty()) {
+            const ssize_t got = recv(c.fd, buf, sizeof(buf), 0);
+            if (got <= 0) {
+                if (got == 0 || errno != EAGAIN) {
+                    close_client(slot);
+                }
+                return;
+            }
+            c.request.append(buf, got);
+            if (c.request.find("\r\n\r\n") == std::string::npos) {
+                if (c.request.size() > 8192) {
+                    close_client(slot);
+                }
+                return;
+            }
+            const bool metrics = c.request.starts_with("GET /metrics ") || c.request.starts_with("GET / ");
+            const std::string body = metrics ? exposition(devices) : "Not Found\n";
+            c.response = std::string(metrics ? "HTTP/1.1 200 OK\r\n" : "HTTP/1.1 404 Not Found\r\n") +
+                         "Content-Type: text/plain; version=0.0.4\r\nContent-Length: " +
+                         std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+            watch(c.fd, EPOLLOUT, CLIENT_BIT | slot, EPOLL_CTL_MOD);
+        }
+        const ssize_t sent = send(c.fd, c.response.data() + c.written, c.response.size() - c.written, MSG_NOSIGNAL);
+        if (sent < 0 && errno != EAGAIN) {
+            close_client(slot);
+            return;
+        }
+        c.written += sent > 0 ? static_cast<size_t>(sent) : 0;
+        if (c.written == c.response.size()) {
+            close_client(slot);
+        }
+    };
+    auto on_accept = [&] {
+        int fd;
+        while ((fd = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+            auto free_slot = std::find_if(clients.begin(), clients.end(), [](const Client &c) { return c.fd < 0; });
+            if (free_slot == clients.end()) {
+                free_slot = clients.emplace(clients.end());
+            }
+            free_slot->fd = fd;
+            watch(fd, EPOLLIN, CLIENT_BIT | (free_slot - clients.begin()), EPOLL_CTL_ADD);
+        }
+    };
+
+    epoll_event events[256];
+    for (;;) {
+        now = Clock::now();
+        Clock::time_point wake = now + std::chrono::seconds(1);
+        due.clear();
+        bool pending = false;
+        for (size_t i = 0; i < devices.size(); ++i) {
+            Device &d = devices[i];
+            if (d.fd >= 0) {
+                if (now >= d.deadline) {
+                    finish(d, false, "timeout");
+                } else {
+                    wake = std::min(wake, d.deadline);
+                    pending = true;
+                    continue;
+                }
+            }
+            if (d.done) {
+                continue;
+            }
+            pending = true;
+            if (d.next_scrape <= now) {
+                due.push_back(i);
+            } else {
+                wake = std::min(wake, d.next_scrape);
+            }
+        }
+        if (opt.once && !pending) {
+            break;
+        }
+        // The most overdue devices go first when more are due than --concurrency allows
+        const size_t slots = static_cast<size_t>(std::max(opt.concurrency - active, 0));
+        if (due.size() > slots) {
+            std::partial_sort(due.begin(), due.begin() + slots, due.end(), [&](const size_t a, const size_t b) {
+                return devices[a].next_scrape < devices[b].next_scrape;
+            });
+            due.resize(slots);
+        }
+        for (const size_t i: due) {
+            start(devices[i], i);
+        }
+
+        const auto wait_ms = std::chrono::ceil<std::chrono::milliseconds>(wake - Clock::now()).count();
+        const int n = epoll_wait(ep, events, 256, due.empty() ? static_cast<int>(std::max<int64_t>(wait_ms, 0)) : 0);
+        for (int e = 0; e < n; ++e) {
+            const uint64_t id = events[e].data.u64;
+            if (id == LISTENER_ID) {
+                on_accept();
+            } else if (id & CLIENT_BIT) {
+                on_client(id & ~CLIENT_BIT);
+            } else {
+                on_device(id);
+            }
+        }
+    }
+
+    const std::string out = exposition(devices);
+    fwrite(out.data(), 1, out.size(), stdout);
+    close(ep);
+    return std::ranges::any_of(devices, [](const Device &d) { return d.up; }) ? 0 : 1;
+}
@@ -0,0 +1,378 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+// Builds update packages for POST /api/ota from a firmware image (.pio/build/<env>/firmware.bin).
+//
+//   ota_package [--format raw|zlib|delta] [--base running.bin] [--level 9] <image> <package>
+//
+// zlib packages carry the compressed image. delta packages carry a compressed stream of ops that rebuild the
+// image from the one running on the device (--base, the image it was last updated with): COPY of base ranges,
+// ADD of small byte differences over a base range, the way bsdiff absorbs code that moved by a few bytes, and
+// INSERT of new bytes. The delta is applied back to the base and compared to the image before it is written.
+// The format defaults to delta when a base is given, zlib otherwise. Upload with
+//
+//   curl --data-binary @package.bin http://<device>/api/ota
+//
+// The exit code is 1 on failure, 2 on usage errors.
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <openssl/sha.h>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+#include "ota/Ota.hpp"
+
+namespace {
+    enum class Op : uint8_t {
+        COPY = 1,
+        INSERT = 2,
+        ADD = 3,
+    };
+
+    struct Options {
+        std::string image_path;
+        std::string package_path;
+        std::string base_path;
+        std::string format;
+        int level = 9;
+    };
+
+    struct OpStats {
+        size_t count = 0;
+        size_t bytes = 0;
+    };
+
+    struct Delta {
+        std::vector<uint8_t> ops;
+        OpStats copy;
+        OpStats add;
+        OpStats insert;
+    };
+
+    // Matches start from SEED_LEN equal bytes and are kept from MIN_MATCH on, shorter ones cost more than an INSERT
+    constexpr size_t SEED_LEN = 16;
+    constexpr size_t MIN_MATCH = 32;
+    constexpr size_t MAX_CHAIN = 64;
+    constexpr int HASH_BITS = 22;
+    // An approximate extension stops once it trails its best score by this many mismatches
+    constexpr int EXTEND_SLACK = 64;
+}
+
+static bool read_file(const std::string &path, std::vector<uint8_t> &out) {
+    FILE *f = fopen(path.c_str(), "rb");
+    if (!f) {
+        fprintf(stderr, "cannot read %s: %s\n", path.c_str(), strerror(errno));
+        return false;
+    }
+    uint8_t buf[65536];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+        out.insert(out.end(), buf, buf + n);
+    }
+    fclose(f);
+    return true;
+}
+
+/**
+ * @brief Digest the device reports for an image, see esp_partition_get_sha256
+ */
+static void image_digest(const std::vector<uint8_t> &image, uint8_t out[32]) {
+    size_t len = image.size();
+    // esptool images with hash_appended end with the SHA-256 of what precedes it
+    if (len > 24 + SHA256_DIGEST_LENGTH && image[0] == 0xE9 && image[23] == 1) {
+        len -= SHA256_DIGEST_LENGTH;
+    }
+    SHA256(image.data(), len, out);
+}
+
+static void put_le32(std::vector<uint8_t> &out, const uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        out.push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+static uint32_t get_le32(const uint8_t *p) {
+    return p[0] | p[1] << 8 | p[2] << 16 | static_cast<uint32_t>(p[3]) << 24;
+}
+
+static uint32_t seed_hash(const uint8_t *p) {
+    uint64_t a, b;
+    memcpy(&a, p, 8);
+    memcpy(&b, p + 8, 8);
+    return static_cast<uint32_t>((a * 0x9E3779B97F4A7C15ULL ^ b * 0xC2B2AE3D27D4EB4FULL) >> (64 - HASH_BITS));
+}
+
+static void emit_insert(Delta &delta, const uint8_t *data, const size_t len) {
+    if (!len) {
+        return;
+    }
+    delta.ops.push_back(static_cast<uint8_t>(Op::INSERT));
+    put_le32(delta.ops, static_cast<uint32_t>(len));
+    delta.ops.insert(delta.ops.end(), data, data + len);
+    delta.insert.count++;
+    delta.insert.bytes += len;
+}
+
+static Delta make_delta(const std::vector<uint8_t> &base, const std::vector<uint8_t> &image) {
+    Delta delta;
+    const size_t n = image.size();
+    const size_t base_n = base.size();
+
+    // Chains of base offsets by seed hash, most recent first
+    std::vector<int32_t> head(1u << HASH_BITS, -1);
+    std::vector<int32_t> prev(base_n, -1);
+    for (size_t j = 0; j + SEED_LEN <= base_n; ++j) {
+        const uint32_t h = seed_hash(&base[j]);
+        prev[j] = head[h];
+        head[h] = static_cast<int32_t>(j);
+    }
+
+    size_t literal_start = 0;
+    size_t i = 0;
+    while (i + SEED_LEN <= n) {
+        size_t best_len = 0;
+        size_t best_j = 0;
+        size_t chain = 0;
+        for (int32_t j = head[seed_hash(&image[i])]; j >= 0 && chain < MAX_CHAIN; j = prev[j], ++chain) {
+            size_t len = 0;
+            const size_t max = std::min(n - i, base_n - j);
+            while (len < max && image[i + len] == base[j + len]) {
+                ++len;
+            }
+            if (len > best_len) {
+                best_len = len;
+                best_j = static_cast<size_t>(j);
+            }
+        }
+        if (best_len < MIN_MATCH) {
+            ++i;
+            continue;
+        }
+        // Take back literal bytes that also match
+        while (i > literal_start && best_j > 0 && image[i - 1] == base[best_j - 1]) {
+            --i;
+            --best_j;
+            ++best_len;
+        }
+        emit_insert(delta, &image[literal_start], i - literal_start);
+
+        // Extend over bytes that mostly match, their differences compress to almost nothing
+        const size_t end = i + best_len;
+        const size_t base_end = best_j + best_len;
+        int score = 0;
+        int best_score = 0;
+        size_t extension = 0;
+        for (size_t k = 0; end + k < n && base_end + k < base_n; ++k) {
+            score += image[end + k] == base[base_end + k] ? 1 : -1;
+            if (score > best_score) {
+                best_score = score;
+                extension = k + 1;
+            } else if (score < best_score - EXTEND_SLACK) {
+                break;
+            }
+        }
+        const size_t total = best_len + extension;
+        if (extension == 0) {
+            delta.ops.push_back(static_cast<uint8_t>(Op::COPY));
+            put_le32(delta.ops, static_cast<uint32_t>(best_j));
+            put_le32(delta.ops, static_cast<uint32_t>(total));
+            delta.copy.count++;
+            delta.copy.bytes += total;
+        } else {
+            delta.ops.push_back(static_cast<uint8_t>(Op::ADD));
+            put_le32(delta.ops, static_cast<uint32_t>(best_j));
+            put_le32(delta.ops, static_cast<uint32_t>(total));
+            for (size_t k = 0; k < total; ++k) {
+                delta.ops.push_back(static_cast<uint8_t>(image[i + k] - base[best_j + k]));
+            }
+            delta.add.count++;
+            delta.add.bytes += total;
+        }
+        i += total;
+        literal_start = i;
+    }
+    emit_insert(delta, &image[literal_start], n - literal_start);
+    return delta;
+}
+
+/**
+ * @brief Rebuilds the image from the ops as the device does, returns false on a malformed stream
+ */
+static bool apply_delta(const std::vector<uint8_t> &base, const std::vector<uint8_t> &ops, std::vector<uint8_t> &out) {
+    size_t p = 0;
+    while (p < ops.size()) {
+        const auto op = static_cast<Op>(ops[p++]);
+        const size_t operands = op == Op::INSERT ? 4 : 8;
+        if (p + operands > ops.size()) {
+            return false;
+        }
+        if (op == Op::INSERT) {
+            const uint32_t len = get_le32(&ops[p]);
+            p += 4;
+            if (p + len > ops.size()) {
+                return false;
+            }
+            out.insert(out.end(), ops.begin() + p, ops.begin() + p + len);
+            p += len;
+            continue;
+        }
+        if (op != Op::COPY && op != Op::ADD) {
+            return false;
+        }
+        const uint32_t src = get_le32(&ops[p]);
+        const uint32_t len = get_le32(&ops[p + 4]);
+        p += 8;
+        if (static_cast<uint64_t>(src) + len > base.size() || (op == Op::ADD && p + len > ops.size())) {
+            return false;
+        }
+        for (uint32_t k = 0; k < len; ++k) {
+            out.push_back(static_cast<uint8_t>(base[src + k] + (op == Op::ADD ? ops[p + k] : 0)));
+        }
+        if (op == Op::ADD) {
+            p += len;
+        }
+    }
+    return true;
+}
+
+static bool deflate_all(const std::vector<uint8_t> &in, const int level, std::vector<uint8_t> &out) {
+    uLongf len = compressBound(in.size());
+    out.resize(len);
+    if (compress2(out.data(), &len, in.data(), in.size(), level) != Z_OK) {
+        fprintf(stderr, "compression failed\n");
+        return false;
+    }
+    out.resize(len);
+    return true;
+}
+
+static bool write_package(const std::string &path, const OtaPackageHeader &header, const std::vector<uint8_t> &payload) {
+    FILE *f = fopen(path.c_str(), "wb");
+    if (!f) {
+        fprintf(stderr, "cannot write %s: %s\n", path.c_str(), strerror(errno));
+        return false;
+    }
+    // The header is declared in little-endian field order without padding, as on the device
+    const bool ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+                    fwrite(payload.data(), 1, payload.size(), f) == payload.size();
+    if (fclose(f) != 0 || !ok) {
+        fprintf(stderr, "cannot write %s\n", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+static void print_ops(const char *name, const OpStats &stats) {
+    printf("  %-6s %8zu ops %10zu bytes\n", name, stats.count, stats.bytes);
+}
+
+int main(const int argc, char **argv) {
+    Options opt;
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg.rfind("--", 0) != 0) {
+            positional.push_back(arg);
+            continue;
+        }
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            fprintf(stderr, "missing value for %s\n", arg.c_str());
+            return 2;
+        }
+        ++i;
+        if (arg == "--format") {
+            opt.format = value;
+        } else if (arg == "--base") {
+            opt.base_path = value;
+        } else if (arg == "--level") {
+            opt.level = std::clamp(atoi(value), 0, 9);
+        } else {
+            fprintf(stderr, "unknown option %s\n", arg.c_str());
+            return 2;
+        }
+    }
+    if (positional.size() != 2) {
+        fprintf(stderr, "usage: ota_package [--format raw|zlib|delta] [--base running.bin] [--level 9] "
+                        "<image> <package>\n");
+        return 2;
+    }
+    opt.image_path = positional[0];
+    opt.package_path = positional[1];
+    if (opt.format.empty()) {
+        opt.format = opt.base_path.empty() ? "zlib" : "delta";
+    }
+
+    OtaPackageHeader header{};
+    header.magic = Ota::PACKAGE_MAGIC;
+    header.version = Ota::PACKAGE_VERSION;
+    if (opt.format == "raw") {
+        header.format = OtaFormat::RAW;
+    } else if (opt.format == "zlib") {
+        header.format = OtaFormat::ZLIB;
+    } else if (opt.format == "delta") {
+        header.format = OtaFormat::DELTA;
+        if (opt.base_path.empty()) {
+            fprintf(stderr, "delta packages need --base\n");
+            return 2;
+        }
+    } else {
+        fprintf(stderr, "unknown format %s\n", opt.format.c_str());
+        return 2;
+    }
+
+    std::vector<uint8_t> image;
+    if (!read_file(opt.image_path, image)) {
+        return 1;
+    }
+    if (image.empty() || image.size() > UINT32_MAX) {
+        fprintf(stderr, "%s is not a usable image\n", opt.image_path.c_str());
+        return 1;
+    }
+    header.image_size = static_cast<uint32_t>(image.size());
+    image_digest(image, header.image_sha256);
+
+    std::vector<uint8_t> payload;
+    if (header.format == OtaFormat::RAW) {
+        payload = image;
+    } else if (header.format == OtaFormat::ZLIB) {
+        if (!deflate_all(image, opt.level, payload)) {
+            return 1;
+        }
+    } else {
+        std::vector<uint8_t> base;
+        if (!read_file(opt.base_path, base)) {
+            return 1;
+        }
+        image_digest(base, header.base_sha256);
+        const Delta delta = make_delta(base, image);
+        std::vector<uint8_t> rebuilt;
+        if (!apply_delta(base, delta.ops, rebuilt) || rebuilt != image) {
+            fprintf(stderr, "delta does not rebuild the image\n");
+            return 1;
+        }
+        if (!deflate_all(delta.ops, opt.level, payload)) {
+            return 1;
+        }
+        printf("delta against %s (%zu bytes), %zu bytes of ops:\n", opt.base_path.c_str(), base.size(),
+               delta.ops.size());
+        print_ops("copy", delta.copy);
+        print_ops("add", delta.add);
+        print_ops("insert", delta.insert);
+    }
+    header.payload_size = static_cast<uint32_t>(payload.size());
+
+    if (!write_package(opt.package_path, header, payload)) {
+        return 1;
+    }
+    printf("%s: %s package, image %u bytes, payload %u bytes (%.1f%%)\n", opt.package_path.c_str(),
+           opt.format.c_str(), header.image_size, header.payload_size,
+           100.0 * header.payload_size / header.image_size);
+    return 0;
+}
@@ -0,0 +1,109 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+// Runs the deep sleep sampling decisions of the ULP program (include/scale/UlpSampling.h) over a recorded weight
+// trace, to see when a battery-backed unit would wake up with a given LowPower::Config.
+//
+//   ulp_replay [--scale 100] [--interval-ms 10000] [--wake 20] [--confirm 2] [--record 2] [--report-s 3600] < trace
+//
+// The trace has one weight per line, in scale units, one line per sample interval (e.g. the "w" of the MQTT
+// samples topic). Weights are turned into raw counts with --scale like HX711::set_scale, and every ULP run finds
+// the conversion ready. Each wakeup is printed with its reason and the recorded history, then the ULP is re-armed
+// the way LowPower::sleep does. The exit code is 2 on usage errors.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "power/LowPower.hpp"
+
+namespace {
+    struct Options {
+        float scale = 100.0f;
+        LowPower::Config config = LowPower::DEFAULT_CONFIG;
+    };
+}
+
+int main(const int argc, char **argv) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            fprintf(stderr, "usage: ulp_replay [--scale 100] [--interval-ms 10000] [--wake 20] [--confirm 2] "
+                            "[--record 2] [--report-s 3600] < trace\n");
+            return 2;
+        }
+        ++i;
+        if (arg == "--scale") {
+            opt.scale = strtof(value, nullptr);
+        } else if (arg == "--interval-ms") {
+            opt.config.sample_interval_ms = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+        } else if (arg == "--wake") {
+            opt.config.wake_delta = strtof(value, nullptr);
+        } else if (arg == "--confirm") {
+            opt.config.wake_confirm = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+        } else if (arg == "--record") {
+            opt.config.record_delta = strtof(value, nullptr);
+        } else if (arg == "--report-s") {
+            opt.config.report_interval_s = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+        } else {
+            fprintf(stderr, "unknown option %s\n", arg.c_str());
+            return 2;
+        }
+    }
+    if (opt.scale == 0.0f) {
+        fprintf(stderr, "--scale must not be 0\n");
+        return 2;
+    }
+
+    const ulp_sampling_config_t config = LowPower::ulp_config(opt.config, opt.scale);
+    ulp_sampling_state_t state;
+    ulp_sampling_reset(&state);
+
+    uint64_t runs = 0;
+    uint64_t readings = 0;
+    uint32_t wakes[4] = {};
+    char line[64];
+    while (fgets(line, sizeof(line), stdin)) {
+        char *end = nullptr;
+        const float weight = strtof(line, &end);
+        if (end == line) {
+            continue;
+        }
+        // Offset binary like HX711::read_once, zero load at mid-scale
+        const auto raw = static_cast<int32_t>(std::lround(weight * opt.scale)) + 0x800000;
+        ulp_action_t action;
+        do {
+            action = ulp_sampling_run(&config, &state, true);
+            ++runs;
+        } while (action != ULP_ACTION_READ);
+        ++readings;
+
+        if (const ulp_wake_reason_t reason = ulp_sampling_on_sample(&config, &state, raw); reason != ULP_WAKE_NONE) {
+            ++wakes[reason];
+            const double t_s = static_cast<double>(runs * LowPower::ULP_PERIOD_MS) / 1000.0;
+            printf("%10.1f s  wake=%-6s readings=%-5u recorded=%-3u", t_s, LowPower::reason_name(reason),
+                   static_cast<unsigned>(state.samples), static_cast<unsigned>(state.count));
+            for (uint32_t i = 0; i < state.count; ++i) {
+                printf(" %.1f", static_cast<double>(state.history[i].raw - 0x800000) / opt.scale);
+            }
+            printf("\n");
+            ulp_sampling_reset(&state);
+        }
+    }
+
+    const uint32_t total = wakes[ULP_WAKE_CHANGE] + wakes[ULP_WAKE_FULL] + wakes[ULP_WAKE_REPORT];
+    printf("%llu readings over %.1f h, %u wakeups (change %u, full %u, report %u)",
+           static_cast<unsigned long long>(readings),
+           static_cast<double>(runs * LowPower::ULP_PERIOD_MS) / 3600000.0, static_cast<unsigned>(total),
+           static_cast<unsigned>(wakes[ULP_WAKE_CHANGE]), static_cast<unsigned>(wakes[ULP_WAKE_FULL]),
+           static_cast<unsigned>(wakes[ULP_WAKE_REPORT]));
+    if (total > 0) {
+        printf(", one every %.1f readings", static_cast<double>(readings) / total);
+    }
+    printf("\n");
+    return 0;
+}
@@ -0,0 +1,121 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#ifndef SMART_FOUNTAIN_CONFIGSTORE_HPP
+#define SMART_FOUNTAIN_CONFIGSTORE_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <type_traits>
+
+#include "mem/ResponseBuffer.hpp"
+#include "pump/Pump.hpp"
+
+struct WifiConfig {
+    char ssid[33];     ///< Empty until provisioned
+    char password[65]; ///< As submitted by the setup form, form-encoded
+};
+
+struct CalibrationConfig {
+    float scale;        ///< Raw counts per unit, see HX711::set_scale
+    float filter_alpha; ///< EMA coefficient of the Sampler
+};
+
+struct PumpConfig {
+    PumpMode mode;
+    uint8_t duty;
+    uint32_t ramp_ms;
+    uint32_t schedule_on_s;
+    uint32_t schedule_off_s;
+    float dry_threshold;
+    float dry_hysteresis;
+};
+
+/**
+ * @brief Everything the device persists, stored as one blob.
+ *
+ * The blob is read back over the defaults up to its own size, so new settings must be appended at the end of this
+ * struct (a new section, or fields after the last one) and VERSION bumped when a change needs a migration step.
+ */
+struct DeviceConfig {
+    WifiConfig wifi;
+    CalibrationConfig calibration;
+    PumpConfig pump;
+};
+
+static_assert(std::is_trivially_copyable_v<DeviceConfig>, "DeviceConfig is stored as raw bytes");
+
+/**
+ * @brief Typed configuration held in RAM and persisted to NVS as a single versioned, CRC-checked blob.
+ *
+ * load() reads the blob once at boot and migrates it to VERSION; a missing or corrupt blob falls back to defaults.
+ * Reads are a copy from RAM under a spinlock, cheap enough for hot paths. Writes update RAM immediately and arm a
+ * COMMIT_DELAY_MS timer, so a burst of changes costs one nvs_set_blob and one nvs_commit.
+ */
+class ConfigStore {
+public:
+    static constexpr uint16_t VERSION = 1;
+    static constexpr uint32_t COMMIT_DELAY_MS = 2000;
+
+    /**
+     * @brief Loads and migrates the blob, requires nvs_flash to be started
+     */
+    static void load();
+
+    /**
+     * @brief Returns a copy of a section, e.g. ConfigStore::get(&DeviceConfig::pump)
+     */
+    template<typename T>
+    static T get(T DeviceConfig::*section) {
+        taskENTER_CRITICAL(&lock);
+        const T value = config.*section;
+        taskEXIT_CRITICAL(&lock);
+        return value;
+    }
+
+    /**
+     * @brief Replaces a section and schedules a commit, unchanged values are not written. Does not allocate.
+     */
+    template<typename T>
+    static void set(T DeviceConfig::*section, const T &value) {
+        taskENTER_CRITICAL(&lock);
+        const bool changed = memcmp(&(config.*section), &value, sizeof(T)) != 0;
+        if (changed) {
+            config.*section = value;
+            dirty = true;
+            ++writes;
+        }
+        taskEXIT_CRITICAL(&lock);
+        if (changed) {
+            schedule_commit();
+        }
+    }
+
+    /**
+     * @brief Commits pending changes now, call before a restart
+     */
+    static void flush();
+
+    /**
+     * @brief Appends write and commit counters in Prometheus format
+     */
+    static void render_metrics(ResponseBuffer &out);
+
+private:
+    static DeviceConfig config;
+    static portMUX_TYPE lock;
+    static bool dirty;
+    static uint32_t writes;
+    static esp_timer_handle_t timer;
+
+    static void schedule_commit();
+
+    static void commit(void *arg);
+};
+
+
+#endif //SMART_FOUNTAIN_CONFIGSTORE_HPP
@@ -0,0 +1,272 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#ifndef SMART_FOUNTAIN_JSONWRITER_HPP
+#define SMART_FOUNTAIN_JSONWRITER_HPP
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+#include "mem/ResponseBuffer.hpp"
+
+/**
+ * @brief Fixed-point number, formatted with integer arithmetic only
+ */
+struct JsonFixed {
+    static constexpr int64_t NONE = INT64_MIN;   ///< Written as null
+
+    int64_t scaled;   ///< value * 10^decimals, or NONE
+    uint8_t decimals;
+};
+
+/**
+ * @brief Rounds a float to the given number of decimals (at most 6).
+ * NaN, infinities and values out of the int64 range become NONE, JSON has no literal for them.
+ */
+inline JsonFixed json_fixed(const double value, const uint8_t decimals) {
+    static constexpr int64_t POW10[] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+    const uint8_t d = decimals > 6 ? 6 : decimals;
+    const double scaled = value * static_cast<double>(POW10[d]);
+    // 2^63 is exact as a double, llround is undefined at and beyond it
+    if (!std::isfinite(scaled) || std::fabs(scaled) >= 9223372036854775808.0) {
+        return {JsonFixed::NONE, d};
+    }
+    return {std::llround(scaled), d};
+}
+
+/**
+ * @brief Schema entry mapping a JSON key to a struct member.
+ * Floating point members are written as fixed-point with `decimals` digits.
+ */
+template<typename T, typename M>
+struct JsonField {
+    std::string_view name;
+    M T::*member;
+    uint8_t decimals;
+};
+
+/**
+ * @brief Schema entry for a member written through a converter, e.g. an enum to its name
+ */
+template<typename T, typename M, typename R>
+struct JsonMapped {
+    std::string_view name;
+    M T::*member;
+    R (*convert)(M);
+};
+
+template<typename T, typename M>
+constexpr JsonField<T, M> json_field(const std::string_view name, M T::*member, const uint8_t decimals = 2) {
+    return {name, member, decimals};
+}
+
+template<typename T, typename M, typename R>
+constexpr JsonMapped<T, M, R> json_field(const std::string_view name, M T::*member, R (*convert)(M)) {
+    return {name, member, convert};
+}
+
+/**
+ * @brief Specialize with `static constexpr auto fields = std::make_tuple(json_field(...), ...);`
+ * to make a struct writable with JsonWriter::object().
+ */
+template<typename T>
+struct JsonSchema;
+
+/**
+ * @brief Streaming JSON writer over a ResponseBuffer.
+ *
+ * Nothing is allocated: keys and values are appended straight into the pooled block, which is flushed as an
+ * HTTP chunk when full, so the response size is not bounded by the buffer.
+ * Commas are inserted automatically between members and array items.
+ */
+class JsonWriter {
+public:
+    explicit JsonWriter(ResponseBuffer &out) : m_out(out) {}
+
+    JsonWriter &begin_object() {
+        separate();
+        m_out.append("{", 1);
+        m_first = true;
+        return *this;
+    }
+
+    JsonWriter &end_object() {
+        m_out.append("}", 1);
+        m_first = false;
+        return *this;
+    }
+
+    JsonWriter &begin_array() {
+        separate();
+        m_out.append("[", 1);
+        m_first = true;
+        return *this;
+    }
+
+    JsonWriter &end_array() {
+        m_out.append("]", 1);
+        m_first = false;
+        return *this;
+    }
+
+    /**
+     * @brief Writes a key, the next call must write its value. Keys are not escaped.
+     */
+    JsonWriter &key(const std::string_view name) {
+        separate();
+        m_out.append("\"", 1);
+        m_out.append(name.data(), name.size());
+        m_out.append("\":", 2);
+        m_first = true;
+        return *this;
+    }
+
+    JsonWriter &value(const std::string_view str) {
+        separate();
+        m_out.append("\"", 1);
+        size_t run = 0;
+        for (size_t i = 0; i < str.size(); ++i) {
+            const auto c = static_cast<unsigned char>(str[i]);
+            if (c >= 0x20 && c != '"' && c != '\\') {
+                continue;
+            }
+            m_out.append(str.data() + run, i - run);
+            run = i + 1;
+            char escaped[6] = {'\\', static_cast<char>(c), 0, 0, 0, 0};
+            size_t len = 2;
+            if (c < 0x20) {
+                static constexpr char HEX[] = "0123456789abcdef";
+                escaped[1] = 'u';
+                escaped[2] = '0';
+                escaped[3] = '0';
+                escaped[4] = HEX[c >> 4];
+                escaped[5] = HEX[c & 0x0F];
+                len = 6;
+            }
+            m_out.append(escaped, len);
+        }
+        m_out.append(str.data() + run, str.size() - run);
+        m_out.append("\"", 1);
+        return *this;
+    }
+
+    JsonWriter &value(const char *str) {
+        return str ? value(std::string_view(str)) : null();
+    }
+
+    JsonWriter &value(const bool b) {
+        separate();
+        m_out.append(b ? "true" : "false", b ? 4 : 5);
+        return *this;
+    }
+
+    template<typename I> requires (std::is_integral_v<I> && !std::is_same_v<I, bool>)
+    JsonWriter &value(const I number) {
+        separate();
+        char buf[24];
+        const auto result = std::to_chars(buf, buf + sizeof(buf), number);
+        m_out.append(buf, result.ptr - buf);
+        return *this;
+    }
+
+    JsonWriter &value(const JsonFixed fixed) {
+        if (fixed.scaled == JsonFixed::NONE) {
+            return null();
+        }
+        separate();
+        static constexpr int64_t POW10[] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+        char buf[32];
+        char *p = buf;
+        uint64_t magnitude = fixed.scaled < 0 ? -static_cast<uint64_t>(fixed.scaled) : fixed.scaled;
+        if (fixed.scaled < 0) {
+            *p++ = '-';
+        }
+        const auto divisor = static_cast<uint64_t>(POW10[fixed.decimals]);
+        p = std::to_chars(p, buf + sizeof(buf), magnitude / divisor).ptr;
+        if (fixed.decimals > 0) {
+            *p++ = '.';
+            uint64_t fraction = magnitude % divisor;
+            for (int i = fixed.decimals - 1; i >= 0; --i) {
+                p[i] = static_cast<char>('0' + fraction % 10);
+                fraction /= 10;
+            }
+            p += fixed.decimals;
+        }
+        m_out.append(buf, p - buf);
+        return *this;
+    }
+
+    JsonWriter &null() {
+        separate();
+        m_out.append("null", 4);
+        return *this;
+    }
+
+    template<typename V>
+    JsonWriter &field(const std::string_view name, const V &v) {
+        key(name);
+        return value(v);
+    }
+
+    /**
+     * @brief Writes a struct as an object following its JsonSchema
+     */
+    template<typename T>
+    JsonWriter &object(const T &obj) {
+        begin_object();
+        std::apply([&](const auto &... fields) { (write_field(obj, fields), ...); }, JsonSchema<T>::fields);
+        return end_object();
+    }
+
+    /**
+     * @brief Writes an array of structs following their JsonSchema
+     */
+    template<typename T>
+    JsonWriter &array(const T *items, const size_t count) {
+        begin_array();
+        for (size_t i = 0; i < count; ++i) {
+            object(items[i]);
+        }
+        return end_array();
+    }
+
+private:
+    ResponseBuffer &m_out;
+    bool m_first = true;
+
+    void separate() {
+        if (!m_first) {
+            m_out.append(",", 1);
+        }
+        m_first = false;
+    }
+
+    template<typename T, typename M>
+    void write_field(const T &obj, const JsonField<T, M> &f) {
+        key(f.name);
+        if constexpr (std::is_floating_point_v<M>) {
+            value(json_fixed(obj.*f.member, f.decimals));
+        } else if constexpr (std::is_enum_v<M>) {
+            value(static_cast<std::underlying_type_t<M>>(obj.*f.member));
+        } else if constexpr (std::is_array_v<M>) {
+            value(static_cast<const char *>(obj.*f.member));
+        } else {
+            value(obj.*f.member);
+        }
+    }
+
+    template<typename T, typename M, typename R>
+    void write_field(const T &obj, const JsonMapped<T, M, R> &f) {
+        key(f.name);
+        value(f.convert(obj.*f.member));
+    }
+};
+
+
+#endif //SMART_FOUNTAIN_JSONWRITER_HPP
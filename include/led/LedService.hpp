@@ -0,0 +1,75 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#ifndef SMART_FOUNTAIN_LEDSERVICE_HPP
+#define SMART_FOUNTAIN_LEDSERVICE_HPP
+
+#include <atomic>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <led_strip.h>
+
+#include "colors.hpp"
+
+enum class LedPattern : uint8_t {
+    NONE = 0,    ///< No request, the slot is empty
+    SOLID = 1,
+    BLINK = 2,   ///< 250 ms on, 250 ms off
+    BREATHE = 3, ///< 2 s fade in and out
+    CODE = 4,    ///< `code` short flashes followed by a pause, for error codes
+};
+
+/**
+ * @brief Owns the status LED and plays declarative patterns on a small "led" task paced by an esp_timer.
+ *
+ * Each subsystem posts its state to its own mailbox slot with post(), which is a single atomic store:
+ * it never blocks, never touches the strip and is safe from any task or ISR.
+ * The timer callback only notifies the task, so the blocking RMT refresh never runs on the shared esp_timer task.
+ * The task picks the slot with the highest precedence and renders its pattern.
+ */
+class LedService {
+public:
+    /**
+     * @brief Status sources, earlier sources take precedence over later ones
+     */
+    enum class Source : uint8_t {
+        SCALE,
+        PUMP,
+        WIFI,
+        SYSTEM,
+        COUNT,
+    };
+
+    static constexpr uint32_t FRAME_PERIOD_MS = 20;
+
+    /**
+     * @brief Configures the strip (see configure_led) and starts the frame timer
+     */
+    static void start();
+
+    /**
+     * @param code Number of flashes for LedPattern::CODE, 1 to 15
+     */
+    static void post(Source source, LedPattern pattern, COLOR color, uint8_t code = 0);
+
+    static void clear(Source source);
+
+private:
+    static led_strip_handle_t strip;
+    static esp_timer_handle_t timer;
+    static TaskHandle_t task;
+    static std::atomic<uint32_t> mailbox[static_cast<size_t>(Source::COUNT)];
+    static uint32_t shown;
+
+    static void tick(void *arg);
+
+    [[noreturn]] static void run(void *arg);
+
+    static void frame();
+};
+
+
+#endif //SMART_FOUNTAIN_LEDSERVICE_HPP
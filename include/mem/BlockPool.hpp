@@ -0,0 +1,67 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#ifndef SMART_FOUNTAIN_BLOCKPOOL_HPP
+#define SMART_FOUNTAIN_BLOCKPOOL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Fixed pool of equally sized blocks, reserved statically.
+ * Acquire and release are lock-free (a CAS on an occupancy bitmap) and never touch the heap,
+ * so request-scoped buffers do not fragment it over long uptimes.
+ * @tparam BlockSize Size of each block in bytes
+ * @tparam Count Number of blocks, at most 32
+ */
+template<size_t BlockSize, size_t Count>
+class BlockPool {
+    static_assert(Count > 0 && Count <= 32, "BlockPool supports 1 to 32 blocks");
+
+public:
+    static constexpr size_t block_size = BlockSize;
+
+    /**
+     * @return A free block, or nullptr if the pool is exhausted
+     */
+    char *acquire() {
+        uint32_t used = m_used.load(std::memory_order_relaxed);
+        for (;;) {
+            const uint32_t free = ~used & ALL;
+            if (free == 0) {
+                m_exhausted.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            const uint32_t bit = free & (~free + 1);
+            if (m_used.compare_exchange_weak(used, used | bit, std::memory_order_acquire)) {
+                return m_blocks[__builtin_ctz(bit)];
+            }
+        }
+    }
+
+    void release(const char *block) {
+        const size_t index = (block - m_blocks[0]) / BlockSize;
+        m_used.fetch_and(~(1u << index), std::memory_order_release);
+    }
+
+    [[nodiscard]] size_t in_use() const {
+        return __builtin_popcount(m_used.load(std::memory_order_relaxed));
+    }
+
+    [[nodiscard]] uint32_t exhausted() const {
+        return m_exhausted.load(std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr uint32_t ALL = Count == 32 ? 0xFFFFFFFFu : (1u << Count) - 1;
+
+    alignas(4) char m_blocks[Count][BlockSize] = {};
+    std::atomic<uint32_t> m_used{0};
+    std::atomic<uint32_t> m_exhausted{0};
+};
+
+
+#endif //SMART_FOUNTAIN_BLOCKPOOL_HPP
@@ -0,0 +1,108 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#ifndef SMART_FOUNTAIN_HEAPGUARD_HPP
+#define SMART_FOUNTAIN_HEAPGUARD_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include "mem/ResponseBuffer.hpp"
+
+/**
+ * @brief Counts heap allocations through the CONFIG_HEAP_USE_HOOKS hooks and enforces
+ * the steady-state no-malloc rule once boot is over.
+ *
+ * Wi-Fi and lwIP allocate by design, so the rule only applies to tasks registered with watch()
+ * and to code run inside a Scope (the WebServer wraps every handler in one).
+ */
+class HeapGuard {
+public:
+    static constexpr size_t MAX_WATCHED = 8;
+    static constexpr size_t MAX_SCOPES = 4;
+
+    /**
+     * @brief Counts the allocations made by the current task while the scope is alive,
+     * e.g. `HeapGuard::Scope scope; handler(req); assert(scope.count() == 0);`
+     *
+     * Only MAX_SCOPES scopes can be open at once. A further one is not tracked: it logs a warning, bumps
+     * heap_untracked_scopes_total and its count() stays 0.
+     */
+    class Scope {
+    public:
+        Scope();
+
+        ~Scope();
+
+        Scope(const Scope &) = delete;
+
+        Scope &operator=(const Scope &) = delete;
+
+        [[nodiscard]] bool tracked() const;
+
+        [[nodiscard]] uint32_t count() const;
+
+    private:
+        int m_slot;
+    };
+
+    /**
+     * @brief Allocations the current task makes while the exemption is alive are not counted against a Scope or a
+     * watched task. Only for library calls that allocate by design, e.g. httpd_req_async_handler_begin.
+     *
+     * Only MAX_SCOPES exemptions can be open at once. A further one has no effect: it logs a warning and bumps
+     * heap_unexempted_total, so the violations it causes can be told apart.
+     */
+    class Exempt {
+    public:
+        Exempt();
+
+        ~Exempt();
+
+        Exempt(const Exempt &) = delete;
+
+        Exempt &operator=(const Exempt &) = delete;
+
+    private:
+        int m_slot;
+    };
+
+    /**
+     * @brief Adds a task to the steady-state set: once sealed, any allocation it makes is a violation
+     */
+    static void watch(TaskHandle_t task);
+
+    /**
+     * @brief Marks the end of boot, allocations from watched tasks and reported scopes are violations from now on
+     */
+    static void seal();
+
+    [[nodiscard]] static bool sealed();
+
+    /**
+     * @brief Records allocations observed by a Scope, counted as violations once sealed
+     * @param what Label for the log, e.g. the request URI
+     */
+    static void report(const char *what, uint32_t allocations);
+
+    [[nodiscard]] static uint32_t allocations();
+
+    [[nodiscard]] static uint32_t violations();
+
+    /**
+     * @brief Appends heap free/largest-block/fragmentation gauges and allocation counters
+     */
+    static void render_metrics(ResponseBuffer &out);
+
+    // Called from the heap hooks, must stay IRAM-safe and must not allocate
+    static void on_alloc();
+
+    static void on_free();
+};
+
+
+#endif //SMART_FOUNTAIN_HEAPGUARD_HPP
@@ -0,0 +1,87 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#ifndef SMART_FOUNTAIN_RESPONSEBUFFER_HPP
+#define SMART_FOUNTAIN_RESPONSEBUFFER_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <esp_http_server.h>
+
+/**
+ * @brief Request-scoped output buffer borrowed from a static block pool.
+ *
+ * When bound to a request, a full buffer is flushed with httpd_resp_send_chunk so a response of any size
+ * fits in one block. Small responses that never overflow are sent in one piece with a Content-Length.
+ * When not bound to a request, appends past the block size are dropped and truncated() is set.
+ */
+class ResponseBuffer {
+public:
+    static constexpr size_t BLOCK_SIZE = 2048;
+    static constexpr size_t BLOCK_COUNT = 4;
+
+    explicit ResponseBuffer(httpd_req_t *req = nullptr);
+
+    ~ResponseBuffer();
+
+    ResponseBuffer(const ResponseBuffer &) = delete;
+
+    ResponseBuffer &operator=(const ResponseBuffer &) = delete;
+
+    /**
+     * @return False if the pool was exhausted, the buffer then silently drops everything
+     */
+    [[nodiscard]] bool ok() const { return m_data != nullptr; }
+
+    void append(const char *data, const size_t len) {
+        // Inline fast path, the JSON writer appends many short tokens
+        if (m_data && len <= BLOCK_SIZE - m_len) {
+            memcpy(m_data + m_len, data, len);
+            m_len += len;
+            return;
+        }
+        append_slow(data, len);
+    }
+
+    void append(const char *str);
+
+    void appendf(const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+    [[nodiscard]] const char *data() const { return m_data; }
+
+    [[nodiscard]] size_t size() const { return m_len; }
+
+    [[nodiscard]] bool truncated() const { return m_truncated; }
+
+    /**
+     * @brief Sends what is left in the buffer and terminates the response.
+     * Replies 503 if no block could be borrowed.
+     */
+    esp_err_t send();
+
+    /**
+     * @return Number of blocks currently borrowed
+     */
+    static size_t in_use();
+
+    /**
+     * @return Number of times a buffer could not be borrowed
+     */
+    static uint32_t exhausted();
+
+private:
+    httpd_req_t *m_req;
+    char *m_data;
+    size_t m_len = 0;
+    bool m_chunked = false;
+    bool m_truncated = false;
+
+    bool flush();
+
+    void append_slow(const char *data, size_t len);
+};
+
+
+#endif //SMART_FOUNTAIN_RESPONSEBUFFER_HPP
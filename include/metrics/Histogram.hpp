@@ -0,0 +1,78 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#ifndef SMART_FOUNTAIN_HISTOGRAM_HPP
+#define SMART_FOUNTAIN_HISTOGRAM_HPP
+
+#include <array>
+#include <atomic>
+#include <cinttypes>
+#include <cstdint>
+#include <freertos/FreeRTOS.h>
+
+#include "mem/ResponseBuffer.hpp"
+
+/**
+ * @brief Fixed-bucket latency histogram in microseconds, rendered in Prometheus format (in seconds).
+ * Bucket counts are 32-bit atomics. The Xtensa cores have no 64-bit atomics, so the sum is guarded by a
+ * spinlock held for one addition, short enough to observe from a real-time task while /metrics reads it.
+ * @tparam N Number of finite buckets, an implicit +Inf bucket is always added
+ */
+template<size_t N>
+class Histogram {
+public:
+    explicit constexpr Histogram(const std::array<uint32_t, N> &bounds_us) : m_bounds_us{bounds_us} {}
+
+    void observe(const uint32_t value_us) {
+        size_t i = 0;
+        while (i < N && value_us > m_bounds_us[i]) {
+            ++i;
+        }
+        m_counts[i].fetch_add(1, std::memory_order_relaxed);
+        taskENTER_CRITICAL(&m_lock);
+        m_sum_us += value_us;
+        taskEXIT_CRITICAL(&m_lock);
+    }
+
+    [[nodiscard]] uint32_t count() const {
+        uint32_t total = 0;
+        for (const auto &c : m_counts) {
+            total += c.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    /**
+     * @brief Appends the histogram in Prometheus text exposition format
+     * @param out Destination buffer
+     * @param name Metric name, should end with _seconds
+     * @param help HELP line text
+     */
+    void render(ResponseBuffer &out, const char *name, const char *help) const {
+        out.appendf("# HELP %s %s\n# TYPE %s histogram\n", name, help, name);
+        uint32_t cumulative = 0;
+        for (size_t i = 0; i < N; ++i) {
+            cumulative += m_counts[i].load(std::memory_order_relaxed);
+            out.appendf("%s_bucket{le=\"%.6f\"} %" PRIu32 "\n",
+                        name, static_cast<double>(m_bounds_us[i]) / 1e6, cumulative);
+        }
+        cumulative += m_counts[N].load(std::memory_order_relaxed);
+        taskENTER_CRITICAL(&m_lock);
+        const uint64_t sum_us = m_sum_us;
+        taskEXIT_CRITICAL(&m_lock);
+        out.appendf("%s_bucket{le=\"+Inf\"} %" PRIu32 "\n", name, cumulative);
+        out.appendf("%s_sum %.6f\n%s_count %" PRIu32 "\n",
+                    name, static_cast<double>(sum_us) / 1e6, name, cumulative);
+    }
+
+private:
+    std::array<uint32_t, N> m_bounds_us;
+    std::array<std::atomic<uint32_t>, N + 1> m_counts{};
+    mutable portMUX_TYPE m_lock = portMUX_INITIALIZER_UNLOCKED;
+    uint64_t m_sum_us = 0;
+};
+
+
+#endif //SMART_FOUNTAIN_HISTOGRAM_HPP
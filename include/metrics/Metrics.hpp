@@ -0,0 +1,43 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#ifndef SMART_FOUNTAIN_METRICS_HPP
+#define SMART_FOUNTAIN_METRICS_HPP
+
+#include <array>
+#include <esp_http_server.h>
+
+#include "mem/ResponseBuffer.hpp"
+
+/**
+ * @brief Registry of Prometheus collectors.
+ * Each subsystem registers a collector that appends its series to the exposition,
+ * the /metrics route then renders all of them in registration order.
+ */
+class Metrics {
+public:
+    using Collector = void (*)(ResponseBuffer &);
+
+    static constexpr size_t MAX_COLLECTORS = 16;
+
+    static void register_collector(Collector collector);
+
+    /**
+     * @brief Renders every registered collector in Prometheus text format
+     */
+    static void render(ResponseBuffer &out);
+
+    /**
+     * @brief Handler for GET /metrics
+     */
+    static esp_err_t handler(httpd_req_t *req);
+
+private:
+    static std::array<Collector, MAX_COLLECTORS> collectors;
+    static size_t collector_count;
+};
+
+
+#endif //SMART_FOUNTAIN_METRICS_HPP
@@ -0,0 +1,76 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#ifndef SMART_FOUNTAIN_TASKSTATS_HPP
+#define SMART_FOUNTAIN_TASKSTATS_HPP
+
+#include <array>
+#include <esp_http_server.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include "mem/ResponseBuffer.hpp"
+
+/**
+ * @brief Per-task CPU usage and stack headroom over the last sampling window
+ */
+struct TaskSample {
+    char name[configMAX_TASK_NAME_LEN];
+    int core;                 ///< Core the task is pinned to, -1 if it can run on both
+    UBaseType_t priority;
+    eTaskState state;
+    float cpu_percent;        ///< Share of one core over the window
+    uint32_t stack_free;      ///< Lowest stack headroom since the task started, in bytes
+};
+
+/**
+ * @brief Samples FreeRTOS run-time stats periodically and diffs consecutive
+ * uxTaskGetSystemState() snapshots into per-task and per-core CPU percentages.
+ *
+ * Requires CONFIG_FREERTOS_USE_TRACE_FACILITY and CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS.
+ * All buffers are static, sampling does not allocate.
+ */
+class TaskStats {
+public:
+    static constexpr size_t MAX_TASKS = 32;
+
+    /**
+     * @brief Starts periodic sampling
+     * @param period_ms Length of the sampling window
+     */
+    static void start(uint32_t period_ms = 2000);
+
+    /**
+     * @brief Appends task_cpu_ratio, task_stack_free_bytes and cpu_core_load_ratio gauges
+     */
+    static void render_metrics(ResponseBuffer &out);
+
+    /**
+     * @brief Handler for GET /api/tasks
+     */
+    static esp_err_t handler(httpd_req_t *req);
+
+private:
+    struct Snapshot {
+        std::array<TaskStatus_t, MAX_TASKS> tasks;
+        UBaseType_t count;
+        configRUN_TIME_COUNTER_TYPE total;
+    };
+
+    static Snapshot snapshots[2];
+    static size_t current;
+    static std::array<TaskSample, MAX_TASKS> samples;
+    static size_t sample_count;
+    static float core_load[portNUM_PROCESSORS];
+    static uint32_t window_us;
+    static portMUX_TYPE lock;
+    static esp_timer_handle_t timer;
+
+    static void sample(void *arg);
+};
+
+
+#endif //SMART_FOUNTAIN_TASKSTATS_HPP
@@ -0,0 +1,161 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#ifndef SMART_FOUNTAIN_MQTTPUBLISHER_HPP
+#define SMART_FOUNTAIN_MQTTPUBLISHER_HPP
+
+#include <array>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <mqtt_client.h>
+
+#include "mem/ResponseBuffer.hpp"
+#include "pump/Pump.hpp"
+#include "scale/Sampler.hpp"
+
+// Override with e.g. build_flags = -DSMART_FOUNTAIN_MQTT_BROKER_URI=\"mqtt://192.168.1.10:1883\"
+#ifndef SMART_FOUNTAIN_MQTT_BROKER_URI
+#define SMART_FOUNTAIN_MQTT_BROKER_URI "mqtt://homeassistant.local:1883"
+#endif
+
+enum class MqttTopic : uint8_t {
+    SAMPLES = 0,
+    EVENTS = 1,
+    METRICS = 2,
+    COUNT,
+};
+
+/**
+ * @brief Pushes telemetry to an MQTT broker in batches, with store-and-forward through outages.
+ *
+ * Samples, events and metric snapshots are appended as small JSON records to a bounded ring in static memory.
+ * A publisher task drains the ring in order: consecutive records of the same topic are sent as one JSON array
+ * once the batch reaches BATCH_BYTES or its oldest record is older than the batch interval.
+ * While the broker is unreachable records stay queued and are replayed in order after reconnection; when the ring
+ * is full the oldest records are dropped and counted. With QoS 1 a batch leaves the ring only once acknowledged.
+ */
+class MqttPublisher {
+public:
+    static constexpr size_t QUEUE_CAPACITY = 128;
+    static constexpr size_t RECORD_SIZE = 96;
+    static constexpr size_t BATCH_BYTES = 1024;
+
+    struct Config {
+        const char *broker_uri;          ///< e.g. mqtt://192.168.1.10:1883
+        const char *base_topic;          ///< Topics are <base>/<device id>/{samples,events,metrics}
+        uint32_t sample_interval_ms;     ///< Minimum time between two queued samples
+        uint32_t batch_interval_ms;      ///< Maximum age of the oldest record before its batch is sent
+        uint32_t metrics_interval_ms;    ///< Period of metric snapshots
+        std::array<uint8_t, static_cast<size_t>(MqttTopic::COUNT)> qos; ///< QoS per topic, 0 or 1
+    };
+
+    static constexpr Config DEFAULT_CONFIG = {
+        .broker_uri = SMART_FOUNTAIN_MQTT_BROKER_URI,
+        .base_topic = "smart-fountain",
+        .sample_interval_ms = 1000,
+        .batch_interval_ms = 10000,
+        .metrics_interval_ms = 60000,
+        .qos = {0, 1, 0},
+    };
+
+    MqttPublisher(Sampler &sampler, const Pump &pump, const Config &config = DEFAULT_CONFIG);
+
+    /**
+     * @brief Starts the MQTT client (it reconnects on its own) and the publisher task
+     */
+    void start();
+
+    /**
+     * @brief Queues an event, safe from any task
+     * @param name Short event name, e.g. "dry_run"
+     * @param detail Optional JSON value (number, string with quotes, object...), nullptr to omit
+     */
+    void event(const char *name, const char *detail = nullptr);
+
+    /**
+     * @brief Queues a reading taken outside the Sampler, e.g. recorded during deep sleep
+     */
+    void sample(const Reading &reading);
+
+    /**
+     * @brief Records queued or in flight, 0 once everything was delivered
+     */
+    [[nodiscard]] size_t pending() const;
+
+    /**
+     * @brief Sends queued records without waiting for their batch interval, e.g. before deep sleep
+     * @return Records still undelivered after timeout_ms, 0 if the queue drained
+     */
+    size_t flush(uint32_t timeout_ms);
+
+    /**
+     * @brief Appends queue depth, publish counters and rate in Prometheus format
+     */
+    void render_metrics(ResponseBuffer &out) const;
+
+private:
+    struct Record {
+        MqttTopic topic;
+        uint8_t len;
+        int64_t timestamp_us;
+        char payload[RECORD_SIZE];
+    };
+
+    Sampler &m_sampler;
+    const Pump &m_pump;
+    Config m_config;
+    char m_topics[static_cast<size_t>(MqttTopic::COUNT)][64] = {};
+    esp_mqtt_client_handle_t m_client = nullptr;
+    TaskHandle_t m_task = nullptr;
+
+    // Ring of queued records, guarded by m_lock
+    mutable portMUX_TYPE m_lock = portMUX_INITIALIZER_UNLOCKED;
+    std::array<Record, QUEUE_CAPACITY> m_queue{};
+    size_t m_head = 0;
+    size_t m_count = 0;
+    uint32_t m_head_abs = 0; ///< Number of records ever removed from the head, identifies records across drops
+
+    // Batch being sent, only touched by the publisher task
+    char m_batch[BATCH_BYTES + 2] = {};
+    int m_inflight_msg_id = -1;
+    size_t m_inflight_records = 0;
+    uint32_t m_inflight_end_abs = 0;
+    int64_t m_inflight_since_us = 0;
+
+    std::atomic<bool> m_connected{false};
+    std::atomic<bool> m_flushing{false};
+    std::atomic<int> m_acked_msg_id{-1};
+    std::atomic<uint32_t> m_published{0};
+    std::atomic<uint32_t> m_batches{0};
+    std::atomic<uint32_t> m_dropped{0};
+    std::atomic<uint32_t> m_failures{0};
+    std::atomic<float> m_rate{0.0f};
+
+    static void task_entry(void *arg);
+
+    [[noreturn]] void run();
+
+    static void on_mqtt_event(void *arg, esp_event_base_t base, int32_t event_id, void *event_data);
+
+    void enqueue(MqttTopic topic, int64_t timestamp_us, const char *payload, size_t len);
+
+    /**
+     * @brief Sends the batch at the head of the queue if it is due, or completes the one in flight
+     */
+    void pump_queue(int64_t now_us);
+
+    /**
+     * @brief Removes queued records up to (excluding) the given absolute index
+     */
+    void pop_through(uint32_t end_abs);
+
+    void enqueue_sample(const Reading &reading);
+
+    void enqueue_metrics(int64_t now_us);
+};
+
+
+#endif //SMART_FOUNTAIN_MQTTPUBLISHER_HPP
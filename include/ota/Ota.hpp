@@ -0,0 +1,91 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#ifndef SMART_FOUNTAIN_OTA_HPP
+#define SMART_FOUNTAIN_OTA_HPP
+
+#include <cstdint>
+#include <esp_http_server.h>
+
+#include "mem/ResponseBuffer.hpp"
+
+enum class OtaFormat : uint8_t {
+    RAW = 0,   ///< Payload is the image
+    ZLIB = 1,  ///< Payload is the zlib-compressed image
+    DELTA = 2, ///< Payload is a zlib-compressed stream of delta ops against the running image
+};
+
+/**
+ * @brief Header of an update package, as built by host/tools/ota_package.cpp. Little endian, followed by the payload.
+ *
+ * Digests are those of esp_partition_get_sha256, i.e. the SHA-256 appended to the app image by esptool.
+ */
+struct OtaPackageHeader {
+    uint32_t magic;           ///< Ota::PACKAGE_MAGIC
+    uint16_t version;         ///< Ota::PACKAGE_VERSION
+    OtaFormat format;
+    uint8_t flags;            ///< Reserved, 0
+    uint32_t image_size;      ///< Bytes written to the OTA slot
+    uint32_t payload_size;    ///< Bytes following the header
+    uint8_t image_sha256[32]; ///< Digest of the new image
+    uint8_t base_sha256[32];  ///< Digest of the running image a delta applies to, zeros otherwise
+};
+
+static_assert(sizeof(OtaPackageHeader) == 80, "OtaPackageHeader is a wire format");
+
+/**
+ * @brief Streaming updates into the inactive slot of a dual-slot partition table, with rollback.
+ *
+ * POST /api/ota receives the package in the httpd task and hands BLOCK_SIZE blocks to an update task through a
+ * small ring, so the network receive of the next blocks overlaps inflating and writing the current one. The update
+ * task inflates with the ROM tinfl decoder, applies delta ops by reading the running slot, and writes the image to
+ * flash a sector at a time. The new slot is made bootable only once its digest matches the package.
+ *
+ * An updated image boots pending verification: it is confirmed once the health check passes and rolled back by the
+ * bootloader if it has not within HEALTH_WINDOW_MS, or if the device resets before that.
+ */
+class Ota {
+public:
+    static constexpr uint32_t PACKAGE_MAGIC = 0x544F4653; ///< "SFOT"
+    static constexpr uint16_t PACKAGE_VERSION = 1;
+    static constexpr size_t BLOCK_SIZE = 4096;
+    static constexpr size_t BLOCK_COUNT = 4;
+    static constexpr uint32_t HEALTH_WINDOW_MS = 60000;
+    static constexpr uint32_t RESTART_DELAY_MS = 500;
+
+    /**
+     * @brief Returns true once the firmware is fully operational, polled every second from the esp_timer task
+     */
+    using HealthCheck = bool (*)();
+
+    /**
+     * @brief Starts the update task and, if the running image is pending verification, the health check
+     */
+    static void start(HealthCheck health_check);
+
+    /**
+     * @brief Handler for POST /api/ota, the body is a package. Restarts into the new image after responding.
+     */
+    static esp_err_t handler(httpd_req_t *req);
+
+    /**
+     * @brief Handler for GET /api/ota, reports the slots and the progress of the current update
+     */
+    static esp_err_t status_handler(httpd_req_t *req);
+
+    /**
+     * @brief Appends update counters and the state of the running image
+     */
+    static void render_metrics(ResponseBuffer &out);
+
+    /**
+     * @brief Returns false during an update and while the running image awaits confirmation, a reset then would
+     * abort the update or roll the image back
+     */
+    static bool idle();
+};
+
+
+#endif //SMART_FOUNTAIN_OTA_HPP
@@ -0,0 +1,153 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#ifndef SMART_FOUNTAIN_LOWPOWER_HPP
+#define SMART_FOUNTAIN_LOWPOWER_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <driver/gpio.h>
+#include <HX711.hpp>
+
+#include "mem/ResponseBuffer.hpp"
+#include "scale/Sampler.hpp"
+#include "scale/UlpSampling.h"
+
+// Build with -DSMART_FOUNTAIN_LOW_POWER=1 for battery-backed units, the device then spends idle time in deep sleep
+#ifndef SMART_FOUNTAIN_LOW_POWER
+#define SMART_FOUNTAIN_LOW_POWER 0
+#endif
+
+/**
+ * @brief Deep sleep with the ULP RISC-V coprocessor watching the scale.
+ *
+ * Once the device has been idle for awake_ms it hands the HX711 pins to the ULP program (ulp/main.c) and enters
+ * deep sleep. Every sample_interval_ms the ULP powers the HX711 up, reads one conversion and powers it down again,
+ * recording readings that moved by record_delta in a small history in RTC memory. It wakes the main CPU when the
+ * weight moved by wake_delta from the weight at sleep, when the history is full, or after report_interval_s.
+ * The main CPU then boots as usual, restores the tare instead of taking a new one, and replays the history.
+ *
+ * The pump output is off during deep sleep, so the device only sleeps while the pump mode is off. Telemetry does not
+ * keep the device awake: the before_sleep hook gets a chance to deliver it, what it could not is counted as lost.
+ */
+class LowPower {
+public:
+    static constexpr uint32_t ULP_PERIOD_MS = 500;
+    /// The HX711 settles within 400 ms of powering up at 10 SPS, so the conversion is normally read on the next run
+    static constexpr uint32_t READY_TIMEOUT_MS = 2000;
+    /// Time the before_sleep hook may take to deliver telemetry, bounds the cost of an unreachable broker
+    static constexpr uint32_t FLUSH_TIMEOUT_MS = 5000;
+
+    struct Config {
+        gpio_num_t clk;
+        gpio_num_t data;
+        uint32_t sample_interval_ms;  ///< Between two conversions while asleep, a multiple of ULP_PERIOD_MS
+        float wake_delta;             ///< Weight change that wakes the device, in scale units
+        uint32_t wake_confirm;        ///< Consecutive readings past wake_delta, filters bumps
+        float record_delta;           ///< Weight change that is recorded in the history, in scale units
+        uint32_t report_interval_s;   ///< Wake at least this often, 0 to only wake on a change or a full history
+        uint32_t awake_ms;            ///< Idle time before sleeping, lets telemetry and requests through
+    };
+
+    static constexpr Config DEFAULT_CONFIG = {
+        .clk = GPIO_NUM_1,
+        .data = GPIO_NUM_2,
+        .sample_interval_ms = 10000,
+        .wake_delta = 20.0f,
+        .wake_confirm = 2,
+        .record_delta = 2.0f,
+        .report_interval_s = 3600,
+        .awake_ms = 30000,
+    };
+
+    /**
+     * @brief Returns true while the device may go to sleep, polled every second from the low power task
+     */
+    using SleepCheck = bool (*)();
+
+    /**
+     * @brief Called by the low power task right before deep sleep
+     * @return Records that could not be delivered and are lost with the RAM
+     */
+    using SleepHook = uint32_t (*)();
+
+    using SampleSink = void (*)(const Reading &reading);
+
+    /**
+     * @brief Stops the ULP and collects its history when it woke the CPU, call first in app_main
+     */
+    static void boot();
+
+    /**
+     * @brief Why the ULP woke the CPU, ULP_WAKE_NONE on any other boot
+     */
+    static ulp_wake_reason_t wake_reason();
+
+    static constexpr const char *reason_name(const ulp_wake_reason_t reason) {
+        switch (reason) {
+            case ULP_WAKE_CHANGE: return "change";
+            case ULP_WAKE_FULL: return "full";
+            case ULP_WAKE_REPORT: return "report";
+            default: return "none";
+        }
+    }
+
+    /**
+     * @brief Converts a config to the raw counts and run counts the ULP works with
+     * @param scale HX711 scale, counts per unit
+     */
+    static ulp_sampling_config_t ulp_config(const Config &config, const float scale) {
+        auto counts = [scale](const float units) {
+            return static_cast<uint32_t>(std::max(1L, std::lround(units * std::fabs(scale))));
+        };
+        return {
+            .clk_gpio = static_cast<uint32_t>(config.clk),
+            .data_gpio = static_cast<uint32_t>(config.data),
+            .gain_pulses = GAIN_128,
+            .sample_runs = std::max<uint32_t>(1, config.sample_interval_ms / ULP_PERIOD_MS),
+            .ready_runs = READY_TIMEOUT_MS / ULP_PERIOD_MS,
+            .wake_delta = counts(config.wake_delta),
+            .wake_confirm = std::max<uint32_t>(1, config.wake_confirm),
+            // A wake on change must leave the new weight in the history
+            .record_delta = std::min(counts(config.record_delta), counts(config.wake_delta)),
+            .report_samples = static_cast<uint32_t>(static_cast<uint64_t>(config.report_interval_s) * 1000 /
+                                                    std::max<uint32_t>(1, config.sample_interval_ms)),
+        };
+    }
+
+    /**
+     * @brief Restores the zero reference and scale in use before deep sleep
+     * @return False unless woken by the ULP, the scale must then be tared
+     */
+    static bool restore_tare(HX711 &scale);
+
+    /**
+     * @brief Passes the readings recorded during deep sleep to the sink, oldest first.
+     * Timestamps are esp_timer time, negative for readings taken before this boot. seq is 0.
+     */
+    static void replay(SampleSink sink);
+
+    /**
+     * @brief Starts the task that enters deep sleep once can_sleep() held for awake_ms
+     * @param scale Scale whose tare and pins are handed to the ULP
+     * @param before_sleep Flushes telemetry, nullptr if there is none
+     */
+    static void start(HX711 &scale, SleepCheck can_sleep, SleepHook before_sleep = nullptr,
+                      const Config &config = DEFAULT_CONFIG);
+
+    /**
+     * @brief Appends wake, sleep and HX711 timeout counters in Prometheus format, kept across deep sleep
+     */
+    static void render_metrics(ResponseBuffer &out);
+
+private:
+    static void task_entry(void *arg);
+
+    [[noreturn]] static void sleep();
+};
+
+
+#endif //SMART_FOUNTAIN_LOWPOWER_HPP
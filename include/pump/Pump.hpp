@@ -0,0 +1,143 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#ifndef SMART_FOUNTAIN_PUMP_HPP
+#define SMART_FOUNTAIN_PUMP_HPP
+
+#include <atomic>
+#include <driver/gpio.h>
+#include <driver/ledc.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "metrics/Histogram.hpp"
+#include "scale/Sampler.hpp"
+
+enum class PumpMode : uint8_t {
+    OFF = 0,
+    ON = 1,
+    SCHEDULE = 2,
+};
+
+/**
+ * @brief Snapshot of the pump state, as reported by GET /api/pump
+ */
+struct PumpStatus {
+    PumpMode mode;
+    uint8_t target_duty;   ///< Requested duty, in percent
+    uint8_t output_duty;   ///< Duty currently applied to the output, in percent
+    bool dry;              ///< Dry-run protection tripped
+    bool stale;            ///< Dry-run protection has no recent reading, the pump is cut
+    float dry_threshold;
+    float dry_hysteresis;
+    uint32_t ramp_ms;
+    uint32_t schedule_on_s;
+    uint32_t schedule_off_s;
+    uint32_t dry_trips;
+    uint32_t deadline_misses;
+};
+
+/**
+ * @brief PWM driven water pump with soft-start, on/off schedule and dry-run protection.
+ *
+ * A control task pinned to core 1 runs every CONTROL_PERIOD_US to apply ramps and schedules,
+ * and is also woken by the Sampler for every new reading so that crossing the dry threshold
+ * cuts the output immediately instead of waiting for the next control period.
+ * The time from the conversion to the cut-off is measured against DRY_DEADLINE_US.
+ * While protection is enabled the pump is also cut when the latest reading is older than STALE_READING_US, so a
+ * stalled Sampler fails safe instead of leaving the pump running unwatched.
+ */
+class Pump {
+public:
+    static constexpr int64_t CONTROL_PERIOD_US = 10'000;
+    static constexpr int64_t DRY_DEADLINE_US = 50'000;
+    /// Ten conversions at 10 SPS, the Sampler logs HX711 timeouts well before
+    static constexpr int64_t STALE_READING_US = 1'000'000;
+
+    /**
+     * @param gpio Pin driving the pump MOSFET gate
+     * @param sampler Source of the filtered water weight
+     */
+    Pump(gpio_num_t gpio, Sampler &sampler);
+
+    /**
+     * @brief Configures LEDC and starts the control task on core 1
+     */
+    void start(UBaseType_t priority = 10);
+
+    void set_mode(PumpMode mode);
+
+    /**
+     * @param percent Duty cycle in percent, clamped to 100
+     */
+    void set_duty(uint8_t percent);
+
+    /**
+     * @param ramp_ms Time for a soft-start from 0 to 100%, 0 to switch instantly
+     */
+    void set_ramp(uint32_t ramp_ms);
+
+    /**
+     * @brief Cycle used in SCHEDULE mode: run for on_s seconds then rest for off_s seconds
+     */
+    void set_schedule(uint32_t on_s, uint32_t off_s);
+
+    /**
+     * @brief The pump is cut when the weight drops below threshold, and re-armed above threshold + hysteresis.
+     * A threshold <= 0 disables dry-run protection.
+     */
+    void set_dry_threshold(float threshold, float hysteresis);
+
+    [[nodiscard]] PumpStatus status() const;
+
+    /**
+     * @brief Appends pump state and control loop histograms in Prometheus format
+     */
+    void render_metrics(ResponseBuffer &out) const;
+
+private:
+    gpio_num_t m_gpio;
+    Sampler &m_sampler;
+    TaskHandle_t m_task = nullptr;
+
+    // Commands, written by any task and applied by the control task
+    std::atomic<PumpMode> m_mode{PumpMode::OFF};
+    std::atomic<uint8_t> m_target_duty{100};
+    std::atomic<uint32_t> m_ramp_ms{2000};
+    std::atomic<uint32_t> m_schedule_on_s{60};
+    std::atomic<uint32_t> m_schedule_off_s{0};
+    std::atomic<float> m_dry_threshold{0.0f};
+    std::atomic<float> m_dry_hysteresis{0.0f};
+    std::atomic<int64_t> m_schedule_start_us{0};
+
+    // State, written by the control task only
+    std::atomic<uint32_t> m_output_duty{0}; ///< Raw LEDC duty
+    std::atomic<bool> m_dry{false};
+    std::atomic<bool> m_stale{false};
+    std::atomic<uint32_t> m_dry_trips{0};
+    std::atomic<uint32_t> m_deadline_misses{0};
+    uint32_t m_last_seq = 0;
+
+    Histogram<8> m_jitter{{50, 100, 250, 500, 1000, 2500, 5000, 10000}};
+    Histogram<8> m_reaction{{1000, 2000, 5000, 10000, 20000, 30000, 50000, 100000}};
+
+    static void task_entry(void *arg);
+
+    [[noreturn]] void run();
+
+    /**
+     * @brief Evaluates dry-run protection against a new reading, cutting the output if needed
+     */
+    void on_reading(const Reading &reading);
+
+    /**
+     * @brief Computes the duty requested by mode and schedule, and ramps the output towards it
+     */
+    void on_tick(int64_t now_us);
+
+    void apply_duty(uint32_t duty);
+};
+
+
+#endif //SMART_FOUNTAIN_PUMP_HPP
@@ -0,0 +1,27 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#ifndef SMART_FOUNTAIN_PUMPAPI_HPP
+#define SMART_FOUNTAIN_PUMPAPI_HPP
+
+#include "pump/Pump.hpp"
+#include "server/WebServer.hpp"
+
+/**
+ * @brief Registers GET /api/pump (status) and POST /api/pump (control).
+ *
+ * POST accepts a flat JSON object, every field is optional:
+ * {"mode": "off"|"on"|"schedule", "duty": 0-100, "ramp_ms": 2000,
+ *  "schedule_on_s": 60, "schedule_off_s": 240, "dry_threshold": 150.0, "dry_hysteresis": 20.0}
+ * Accepted settings are persisted in the ConfigStore and survive a restart.
+ */
+void register_pump_routes(WebServer &server, Pump &pump);
+
+/**
+ * @brief Applies the settings last accepted by POST /api/pump, requires ConfigStore::load()
+ */
+void restore_pump_config(Pump &pump);
+
+#endif //SMART_FOUNTAIN_PUMPAPI_HPP
@@ -0,0 +1,107 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#ifndef SMART_FOUNTAIN_SAMPLER_HPP
+#define SMART_FOUNTAIN_SAMPLER_HPP
+
+#include <array>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <HX711.hpp>
+
+#include "mem/ResponseBuffer.hpp"
+#include "metrics/Histogram.hpp"
+
+/**
+ * @brief A filtered weight reading published by the Sampler
+ */
+struct Reading {
+    float weight;          ///< Exponentially filtered weight, in scale units
+    float raw_weight;      ///< Unfiltered weight of the last conversion
+    int64_t timestamp_us;  ///< esp_timer time at which the conversion completed
+    uint32_t seq;          ///< Incremented for every published reading, 0 means no reading yet
+    uint32_t version;      ///< Incremented when the filtered weight moved beyond the deadband, see Sampler::current()
+};
+
+/**
+ * @brief Owns the HX711 once tared: reads it continuously in a dedicated task,
+ * filters the readings and publishes the latest one.
+ *
+ * Consumers either poll latest() or register their task to get a notification for every new reading.
+ * Clients that only care about the weight use current(): it changes when the filtered weight moved by at least the
+ * deadband from the last version, at most every MIN_VERSION_INTERVAL_MS, so noise does not make every reading new.
+ */
+class Sampler {
+public:
+    static constexpr size_t MAX_LISTENERS = 4;
+    static constexpr float DEFAULT_DEADBAND = 1.0f;
+    static constexpr uint32_t MIN_VERSION_INTERVAL_MS = 100;
+
+    /**
+     * @param scale Tared scale, must not be read by anyone else once start() is called
+     * @param alpha EMA coefficient in (0, 1], 1 disables filtering
+     * @param deadband Change of the filtered weight, in scale units, that makes a new version
+     */
+    explicit Sampler(HX711 &scale, float alpha = 0.3f, float deadband = DEFAULT_DEADBAND);
+
+    /**
+     * @brief Starts the sampling task
+     * @param priority FreeRTOS priority of the sampling task
+     * @param core Core to pin the task to
+     */
+    void start(UBaseType_t priority = 6, BaseType_t core = 1);
+
+    /**
+     * @brief Returns the latest published reading, safe to call from any task
+     */
+    [[nodiscard]] Reading latest() const;
+
+    /**
+     * @brief Returns the reading that started the current version, safe to call from any task
+     */
+    [[nodiscard]] Reading current() const;
+
+    /**
+     * @brief Registers a task to be notified (xTaskNotifyGive) after each new reading
+     * @param versions_only Notify only when the version changes
+     * @return False if the listener table is full
+     */
+    bool add_listener(TaskHandle_t task, bool versions_only = false);
+
+    /**
+     * @brief Appends the conversion read time histogram in Prometheus format
+     */
+    void render_metrics(ResponseBuffer &out) const;
+
+private:
+    struct Listener {
+        TaskHandle_t task;
+        bool versions_only;
+    };
+
+    HX711 &m_scale;
+    float m_alpha;
+    float m_deadband;
+    mutable portMUX_TYPE m_lock = portMUX_INITIALIZER_UNLOCKED;
+    Reading m_latest{};
+    Reading m_current{};
+    TaskHandle_t m_task = nullptr;
+    std::array<Listener, MAX_LISTENERS> m_listeners{};
+    size_t m_listener_count = 0;
+    uint32_t m_timeouts = 0;
+    // Clocking 24 bits out takes ~50 µs of pulses, the rest is GPIO call and cache overhead
+    Histogram<8> m_read{{50, 75, 100, 150, 200, 300, 500, 1000}};
+
+    static void task_entry(void *arg);
+
+    void run();
+
+    void on_timeout();
+
+    void publish(float raw_weight, int64_t timestamp_us);
+};
+
+
+#endif //SMART_FOUNTAIN_SAMPLER_HPP
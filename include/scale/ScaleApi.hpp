@@ -0,0 +1,48 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#ifndef SMART_FOUNTAIN_SCALEAPI_HPP
+#define SMART_FOUNTAIN_SCALEAPI_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include "mem/ResponseBuffer.hpp"
+#include "scale/Sampler.hpp"
+#include "server/WebServer.hpp"
+
+/**
+ * @brief GET /scale: the current version of the weight (Sampler::current()) as {"value", "version", "timestamp_ms"},
+ * with conditional and long-poll reads.
+ *
+ * The ETag is "<version>-<timestamp_us>", a request whose If-None-Match matches it gets 304 Not Modified. Noise
+ * within the Sampler deadband keeps the version, so an unchanged weight stays 304.
+ * With ?after=<version>&wait=<ms> and no newer version, the request is parked with httpd_req_async_handler_begin()
+ * so it holds no httpd worker, and answered by the scale_poll task as soon as the Sampler publishes the next version,
+ * or after wait ms (capped at MAX_WAIT_MS) with the current one. Any other version, e.g. from before a restart, is
+ * answered at once.
+ */
+class ScaleApi {
+public:
+    static constexpr size_t MAX_PARKED = 4;       ///< Further long polls get 503 with Retry-After
+    static constexpr uint32_t MAX_WAIT_MS = 30000;
+
+    /**
+     * @brief Registers the route and starts the task answering parked requests
+     */
+    static void start(WebServer &server, Sampler &sampler);
+
+    /**
+     * @brief Answers every parked request with the current reading, call before stopping the server
+     */
+    static void drain();
+
+    /**
+     * @brief Appends conditional read and long-poll counters
+     */
+    static void render_metrics(ResponseBuffer &out);
+};
+
+#endif //SMART_FOUNTAIN_SCALEAPI_HPP
@@ -0,0 +1,146 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+// Decision logic of the ULP sampling program, shared by the ULP RISC-V program (ulp/main.c), the firmware and the
+// host tools. Plain C without library calls so the same code runs on the ULP, the main cores and Linux.
+
+#ifndef SMART_FOUNTAIN_ULPSAMPLING_H
+#define SMART_FOUNTAIN_ULPSAMPLING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define ULP_HISTORY_CAPACITY 32
+
+typedef enum {
+    ULP_WAKE_NONE = 0,
+    ULP_WAKE_CHANGE = 1, ///< The weight moved by at least wake_delta from the first reading since sleep
+    ULP_WAKE_FULL = 2,   ///< The history buffer is full
+    ULP_WAKE_REPORT = 3, ///< report_samples readings were taken without any other reason to wake
+} ulp_wake_reason_t;
+
+/**
+ * @brief What the ULP program must do with the HX711 on this run
+ */
+typedef enum {
+    ULP_ACTION_NONE = 0,
+    ULP_ACTION_POWER_UP,   ///< Pull SCK low, the conversion is read on a later run
+    ULP_ACTION_READ,       ///< Read the conversion, then pull SCK high again
+    ULP_ACTION_POWER_DOWN, ///< Pull SCK high, the HX711 did not become ready
+} ulp_action_t;
+
+/**
+ * @brief Written by the main CPU before sleeping, read-only for the ULP.
+ * Counts are raw HX711 counts (offset binary as returned by HX711::read_once), so no float math runs on the ULP.
+ */
+typedef struct {
+    uint32_t clk_gpio;
+    uint32_t data_gpio;
+    uint32_t gain_pulses;   ///< Pulses after the 24 data bits, 1 for channel A gain 128 (the power-up default)
+    uint32_t sample_runs;   ///< ULP runs between two conversions, the HX711 is powered down in between
+    uint32_t ready_runs;    ///< ULP runs to wait for DOUT after powering up before giving up on a conversion
+    uint32_t wake_delta;    ///< Counts from the reference reading that wake the main CPU
+    uint32_t wake_confirm;  ///< Consecutive readings beyond wake_delta needed, filters single spikes
+    uint32_t record_delta;  ///< Counts from the last recorded reading before a reading is recorded again
+    uint32_t report_samples; ///< Readings before a periodic wake, 0 disables it
+} ulp_sampling_config_t;
+
+typedef struct {
+    int32_t raw;
+    uint32_t tick; ///< ulp_sampling_state_t::ticks when the reading was taken
+} ulp_sample_t;
+
+/**
+ * @brief Owned by the ULP while the main CPU sleeps, read by the main CPU after it woke up.
+ * All zeroes is the armed state, see ulp_sampling_reset().
+ */
+typedef struct {
+    uint32_t wake_reason; ///< ulp_wake_reason_t, the ULP does nothing until the main CPU resets it
+    uint32_t ticks;       ///< ULP runs since armed
+    uint32_t powered;     ///< SCK is low and a conversion is pending
+    uint32_t cycle_runs;  ///< Runs since the HX711 was last powered up
+    uint32_t samples;     ///< Readings taken since armed
+    uint32_t timeouts;    ///< Conversions that never became ready
+    uint32_t has_reference;
+    int32_t reference;    ///< First reading since armed, the weight the main CPU last saw
+    uint32_t beyond;      ///< Consecutive readings at least wake_delta away from the reference
+    uint32_t count;       ///< Readings in history
+    ulp_sample_t history[ULP_HISTORY_CAPACITY];
+} ulp_sampling_state_t;
+
+static inline void ulp_sampling_reset(ulp_sampling_state_t *state) {
+    uint8_t *bytes = (uint8_t *) state;
+    for (uint32_t i = 0; i < sizeof(*state); ++i) {
+        bytes[i] = 0;
+    }
+}
+
+static inline uint32_t ulp_sampling_distance(const int32_t a, const int32_t b) {
+    return a > b ? (uint32_t) (a - b) : (uint32_t) (b - a);
+}
+
+/**
+ * @brief Advances the power/read cycle by one ULP run
+ * @param data_ready DOUT is low
+ */
+static inline ulp_action_t ulp_sampling_run(const ulp_sampling_config_t *config, ulp_sampling_state_t *state,
+                                            const bool data_ready) {
+    if (state->wake_reason != ULP_WAKE_NONE) {
+        return ULP_ACTION_NONE;
+    }
+    ++state->ticks;
+    ++state->cycle_runs;
+    if (!state->powered) {
+        if (state->cycle_runs < config->sample_runs) {
+            return ULP_ACTION_NONE;
+        }
+        state->cycle_runs = 0;
+        state->powered = 1;
+        return ULP_ACTION_POWER_UP;
+    }
+    if (!data_ready) {
+        if (state->cycle_runs < config->ready_runs) {
+            return ULP_ACTION_NONE;
+        }
+        ++state->timeouts;
+        state->powered = 0;
+        return ULP_ACTION_POWER_DOWN;
+    }
+    // Waiting for DOUT counts towards the sample interval, so readings stay sample_runs apart
+    state->powered = 0;
+    return ULP_ACTION_READ;
+}
+
+/**
+ * @brief Records a reading and decides whether to wake the main CPU
+ * @return The wake reason, also stored in state->wake_reason
+ */
+static inline ulp_wake_reason_t ulp_sampling_on_sample(const ulp_sampling_config_t *config,
+                                                       ulp_sampling_state_t *state, const int32_t raw) {
+    ++state->samples;
+    if (!state->has_reference) {
+        state->has_reference = 1;
+        state->reference = raw;
+    }
+    if (state->count == 0 ||
+        ulp_sampling_distance(raw, state->history[state->count - 1].raw) >= config->record_delta) {
+        state->history[state->count].raw = raw;
+        state->history[state->count].tick = state->ticks;
+        ++state->count;
+    }
+    state->beyond = ulp_sampling_distance(raw, state->reference) >= config->wake_delta ? state->beyond + 1 : 0;
+
+    ulp_wake_reason_t reason = ULP_WAKE_NONE;
+    if (state->beyond >= config->wake_confirm) {
+        reason = ULP_WAKE_CHANGE;
+    } else if (state->count == ULP_HISTORY_CAPACITY) {
+        reason = ULP_WAKE_FULL;
+    } else if (config->report_samples > 0 && state->samples >= config->report_samples) {
+        reason = ULP_WAKE_REPORT;
+    }
+    state->wake_reason = (uint32_t) reason;
+    return reason;
+}
+
+#endif //SMART_FOUNTAIN_ULPSAMPLING_H
@@ -5,26 +5,37 @@
 
 #ifndef SMART_FOUNTAIN_WEBSERVER_HPP
 #define SMART_FOUNTAIN_WEBSERVER_HPP
+#include <array>
 #include <esp_http_server.h>
 #include <esp_log.h>
-#include <functional>
-#include <map>
-#include <string>
+
+using Handler = esp_err_t (*)(httpd_req_t *req);
 
 struct HANDLER {
-    std::function<esp_err_t(httpd_req_t *)> fn;
+    const char *uri;
+    Handler fn;
+    void *user_ctx;      ///< Passed to fn as req->user_ctx
     httpd_method_t method;
+    uint16_t trace_id;   ///< Requests are traced as spans named after the URI
 };
 
 class WebServer {
 public:
+    static constexpr uint16_t MAX_URI_HANDLERS = 24;
+
     WebServer();
 
     ~WebServer();
 
+    /**
+     * @brief Registers a handler, intended to be called during boot
+     * @param uri Path without query string, must outlive the server (string literal)
+     * @param user_ctx Set as req->user_ctx before the handler runs, like httpd does
+     */
     WebServer &registerUri(const char *uri,
                            httpd_method_t method,
-                           const std::function<esp_err_t(httpd_req_t *)> &handler);
+                           Handler handler,
+                           void *user_ctx = nullptr);
 
     WebServer &start();
 
@@ -33,10 +44,14 @@ public:
 private:
     httpd_handle_t m_server;
 
-    static std::map<std::string, HANDLER> handlers;
+    // Fixed table, each entry is passed to httpd as user_ctx so dispatch needs no lookup
+    static std::array<HANDLER, MAX_URI_HANDLERS> handlers;
+    static size_t handler_count;
 
     static esp_err_t dispatch_handler(httpd_req_t *req);
+
+    void expose(HANDLER &handler) const;
 };
 
 
-#endif //SMART_FOUNTAIN_WEBSERVER_HPP
\ No newline at end of file
+#endif //SMART_FOUNTAIN_WEBSERVER_HPP
@@ -0,0 +1,133 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#ifndef SMART_FOUNTAIN_TRACE_HPP
+#define SMART_FOUNTAIN_TRACE_HPP
+
+#include <cstdint>
+#include <esp_http_server.h>
+#include <esp_timer.h>
+
+#include "mem/ResponseBuffer.hpp"
+
+// Build with -DSMART_FOUNTAIN_TRACE=0 to compile every trace point and the ring buffers out
+#ifndef SMART_FOUNTAIN_TRACE
+#define SMART_FOUNTAIN_TRACE 1
+#endif
+
+// Records kept per core, a power of two. 16 bytes each.
+#ifndef SMART_FOUNTAIN_TRACE_RING_SIZE
+#define SMART_FOUNTAIN_TRACE_RING_SIZE 1024
+#endif
+
+/**
+ * @brief Event tracing into per-core ring buffers, exported as Chrome/Perfetto trace JSON.
+ *
+ * A record is four 32-bit words: start time, duration, argument, and the event id with the top bits of the
+ * timestamp. Writers claim a slot with an atomic increment of their core's head, so tasks preempting each other
+ * on one core never share a slot and cores never contend. The ring overwrites its oldest records; a reader skips
+ * any record that changes while it is copied.
+ *
+ * Event names are string literals interned once per trace point, use the TRACE_* macros rather than the class.
+ */
+class Trace {
+public:
+    static constexpr size_t RING_SIZE = SMART_FOUNTAIN_TRACE_RING_SIZE;
+    static constexpr size_t MAX_EVENTS = 64;
+
+    static_assert((RING_SIZE & (RING_SIZE - 1)) == 0, "SMART_FOUNTAIN_TRACE_RING_SIZE must be a power of two");
+
+    enum class Kind : uint8_t {
+        COMPLETE = 1, ///< Span with a duration
+        INSTANT,
+    };
+
+    /**
+     * @brief Returns the id of an event name, registering it on first use
+     * @param name String literal, must outlive the trace
+     * @return Id in [1, MAX_EVENTS], 0 if the table is full (the event is then dropped)
+     */
+    static uint16_t intern(const char *name);
+
+    /**
+     * @brief Appends a record to the ring of the calling core, safe from any task or ISR
+     */
+    static void record(uint16_t id, Kind kind, int64_t start_us, uint32_t duration_us, uint32_t arg);
+
+    /**
+     * @brief Records a span from construction to destruction
+     */
+    class Scope {
+    public:
+        Scope(const uint16_t id, const uint32_t arg) : m_id(id), m_arg(arg), m_start(esp_timer_get_time()) {}
+
+        ~Scope() {
+            record(m_id, Kind::COMPLETE, m_start, static_cast<uint32_t>(esp_timer_get_time() - m_start), m_arg);
+        }
+
+        Scope(const Scope &) = delete;
+
+        Scope &operator=(const Scope &) = delete;
+
+        /**
+         * @brief Replaces the argument, e.g. with a result known only at the end of the span
+         */
+        void set_arg(const uint32_t arg) { m_arg = arg; }
+
+    private:
+        uint16_t m_id;
+        uint32_t m_arg;
+        int64_t m_start;
+    };
+
+    /**
+     * @brief Appends trace_events_total per core
+     */
+    static void render_metrics(ResponseBuffer &out);
+
+    /**
+     * @brief Handler for GET /api/trace, streams the rings as Chrome trace JSON (chrome://tracing, ui.perfetto.dev)
+     */
+    static esp_err_t handler(httpd_req_t *req);
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+#if SMART_FOUNTAIN_TRACE
+
+#define TRACE_INTERN(name) Trace::intern(name)
+
+/**
+ * Traces the rest of the enclosing block as a span, `arg` is shown in the event details
+ */
+#define TRACE_SCOPE_ARG(name, arg)                                                                   \
+    static const uint16_t TRACE_CONCAT(trace_id_, __LINE__) = Trace::intern(name);                   \
+    Trace::Scope TRACE_CONCAT(trace_scope_, __LINE__)(TRACE_CONCAT(trace_id_, __LINE__), (arg))
+
+#define TRACE_SCOPE(name) TRACE_SCOPE_ARG(name, 0)
+
+/**
+ * Same as TRACE_SCOPE_ARG for an id interned beforehand, e.g. at registration
+ */
+#define TRACE_SCOPE_ID(id, arg) Trace::Scope TRACE_CONCAT(trace_scope_, __LINE__)((id), (arg))
+
+#define TRACE_INSTANT(name, arg) do {                                                                \
+        static const uint16_t trace_id_ = Trace::intern(name);                                       \
+        Trace::record(trace_id_, Trace::Kind::INSTANT, esp_timer_get_time(), 0, (arg));              \
+    } while (0)
+
+#else
+
+#define TRACE_INTERN(name) static_cast<uint16_t>(0)
+#define TRACE_SCOPE_ARG(name, arg) static_cast<void>(sizeof(arg))
+#define TRACE_SCOPE(name) static_cast<void>(0)
+#define TRACE_SCOPE_ID(id, arg) static_cast<void>(sizeof(id) + sizeof(arg))
+#define TRACE_INSTANT(name, arg) static_cast<void>(sizeof(arg))
+
+#endif
+
+
+#endif //SMART_FOUNTAIN_TRACE_HPP
@@ -4,6 +4,7 @@
 
 #include "HX711.hpp"
 
+#include <esp_attr.h>
 #include <esp_log.h>
 #include <esp_rom_sys.h>
 #include <esp_timer.h>
@@ -11,6 +12,13 @@
 #include <freertos/task.h>
 #include <iostream>
 
+// The driver is also used standalone, trace points only exist when the application provides the tracer
+#if __has_include("trace/Trace.hpp")
+#include "trace/Trace.hpp"
+#else
+#define TRACE_SCOPE(name) static_cast<void>(0)
+#endif
+
 // Sets delay to 1µs clock for robustness
 #define HX711_DELAY esp_rom_delay_us(1);
 
@@ -90,6 +98,14 @@ void HX711::tare(const uint16_t times) {
     ESP_LOGI("HX711", "Tare: %d", m_tare);
 }
 
+void HX711::set_tare(const int32_t tare) {
+    m_tare = tare;
+}
+
+int32_t HX711::get_tare() const {
+    return m_tare;
+}
+
 
 void HX711::set_scale(const float scale) {
     if (scale == 0.0f) {
@@ -99,6 +115,10 @@ void HX711::set_scale(const float scale) {
     }
 }
 
+float HX711::get_scale() const {
+    return m_scale;
+}
+
 float HX711::get_units() {
     return get_units(10);
 }
@@ -109,6 +129,14 @@ float HX711::get_units(uint8_t times) {
     return static_cast<float>(net) / m_scale;
 }
 
+std::optional<float> HX711::try_get_units(const uint16_t timeout_ms) {
+    if (!wait_ready_timeout(timeout_ms)) {
+        return std::nullopt;
+    }
+    const int32_t net = read_once() - m_tare;
+    return static_cast<float>(net) / m_scale;
+}
+
 void HX711::set_gain(uint8_t gain) {
     // After changing m_gain, we need to sync HX711 mode by performing a read
     // (The gain selection is applied on the extra pulses at the end of a read)
@@ -142,14 +170,16 @@ void HX711::power_up() {
     }
 }
 
-int32_t HX711::read_once() {
+// The bit-bang path runs from IRAM, a flash cache miss between two edges would stretch the clock pulse and a
+// pulse over 60 µs powers the HX711 down
+IRAM_ATTR int32_t HX711::read_once() {
+    TRACE_SCOPE("hx711.read");
     // Read 24 bits MSB-first. On the 25th-27th pulse, we set gain/channel.
     uint32_t value = 0;
 
     // Ensure CLK low before starting
     clk_low();
     HX711_DELAY;
-    ESP_LOGD("HX711", "Clock LOW");
 
     portDISABLE_INTERRUPTS();
 
@@ -175,7 +205,7 @@ int32_t HX711::read_once() {
     return static_cast<int32_t>(value);
 }
 
-void HX711::apply_gain_pulses() const {
+IRAM_ATTR void HX711::apply_gain_pulses() const {
     // Pulses after 24th bit select the next conversion's gain/channel:
     // 1 pulse -> Channel A, gain 128
     // 2 pulses -> Channel B, gain 32
@@ -188,11 +218,11 @@ void HX711::apply_gain_pulses() const {
     }
 }
 
-inline void HX711::clk_high() const {
+IRAM_ATTR inline void HX711::clk_high() const {
     gpio_set_level(m_clk, 1);
 }
 
-inline void HX711::clk_low() const {
+IRAM_ATTR inline void HX711::clk_low() const {
     gpio_set_level(m_clk, 0);
 }
 
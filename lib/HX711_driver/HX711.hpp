@@ -6,6 +6,7 @@
 #define HX711_H
 
 #include <driver/gpio.h>
+#include <optional>
 
 enum HX711_GAIN : uint8_t {
     GAIN_128 = 1,
@@ -27,12 +28,35 @@ public:
      */
     void tare(uint16_t times = 10);
 
+    /**
+     * @brief Restores a zero reference taken earlier, e.g. before deep sleep
+     */
+    void set_tare(int32_t tare);
+
+    [[nodiscard]] int32_t get_tare() const;
+
     void set_scale(float scale);
 
+    [[nodiscard]] float get_scale() const;
+
     float get_units();
 
     float get_units(uint8_t times);
 
+    /**
+     * @brief Reads a single conversion and converts it to units.
+     * Unlike get_units(), a timeout is reported instead of being folded into the value as a zero reading.
+     * @param timeout_ms Maximum time to wait for the HX711 to become ready
+     * @return The reading in units, or std::nullopt if the HX711 did not become ready in time
+     */
+    std::optional<float> try_get_units(uint16_t timeout_ms = 1000);
+
+    /**
+     * @brief Waits for a conversion, so the following try_get_units(0) only clocks it out
+     * @return False if the HX711 did not become ready in time
+     */
+    [[nodiscard]] bool wait_ready_timeout(uint16_t timeout_ms = 1000) const;
+
     void set_gain(uint8_t gain);
 
     void power_down();
@@ -49,8 +73,6 @@ private:
 
     [[nodiscard]] bool is_ready() const;
 
-    [[nodiscard]] bool wait_ready_timeout(uint16_t timeout_ms = 1000) const;
-
     int32_t read_once();
 
     void apply_gain_pulses() const;
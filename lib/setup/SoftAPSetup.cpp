@@ -5,6 +5,8 @@
 
 #include "SoftAPSetup.hpp"
 
+#include "config/ConfigStore.hpp"
+
 // Simple in-place URL decoder for application/x-www-form-urlencoded
 // - Converts %HH to the byte value
 // - Converts '+' to ' '
@@ -209,7 +211,7 @@ esp_err_t SoftAPSetup::root_get_handler(httpd_req_t *req) {
 </html>)";
 
     ESP_LOGI(TAG, "Accessed WiFi Setup Page");
-    ESP_LOGI(TAG, "Responding with %d bytes", strlen(resp));
+    ESP_LOGI(TAG, "Responding with %zu bytes", strlen(resp));
     httpd_resp_send(req, resp, HTTPD_RESP_USE_STRLEN);
     return ESP_OK;
 }
@@ -226,13 +228,12 @@ esp_err_t SoftAPSetup::set_wifi_post_handler(httpd_req_t *req) {
 
     ESP_LOGI(TAG, "Got SSID: %s  PASS: %s", ssid, pass);
 
-    // Save to NVS
-    nvs_handle_t nvs;
-    nvs_open("wifi", NVS_READWRITE, &nvs);
-    nvs_set_str(nvs, "ssid", ssid);
-    nvs_set_str(nvs, "pass", pass);
-    nvs_commit(nvs);
-    nvs_close(nvs);
+    // Committed right away, the restart below would drop a debounced write
+    WifiConfig wifi{};
+    memcpy(wifi.ssid, ssid, sizeof(ssid));
+    memcpy(wifi.password, pass, sizeof(pass));
+    ConfigStore::set(&DeviceConfig::wifi, wifi);
+    ConfigStore::flush();
 
     httpd_resp_sendstr(req, "Credentials saved! Rebooting...");
 
@@ -242,33 +243,12 @@ esp_err_t SoftAPSetup::set_wifi_post_handler(httpd_req_t *req) {
 }
 
 bool SoftAPSetup::is_creds_saved() {
-    nvs_handle_t nvs;
-    nvs_open("wifi", NVS_READONLY, &nvs);
-
-    char *ssid = nullptr;
-    char *pass = nullptr;
-
-    // Get size
-    size_t ssid_size;
-    size_t pass_size;
-    nvs_get_str(nvs, "ssid", nullptr, &ssid_size);
-    nvs_get_str(nvs, "pass", nullptr, &pass_size);
-
-    // Allocate memory & read
-    ssid = static_cast<char *>(malloc(ssid_size));
-    pass = static_cast<char *>(malloc(pass_size));
-    nvs_get_str(nvs, "ssid", ssid, &ssid_size);
-    nvs_get_str(nvs, "pass", pass, &pass_size);
-
-    nvs_close(nvs);
-
-    if (ssid && pass) {
-        url_decode_inplace(pass);
-        m_connect_ssid = ssid;
-        m_connect_password = pass;
-        ESP_LOGI(TAG, "SSID: %s PASS: %s", ssid, pass);
-        free(ssid);
-        free(pass);
+    WifiConfig wifi = ConfigStore::get(&DeviceConfig::wifi);
+    if (wifi.ssid[0] != '\0') {
+        url_decode_inplace(wifi.password);
+        m_connect_ssid = wifi.ssid;
+        m_connect_password = wifi.password;
+        ESP_LOGI(TAG, "SSID: %s PASS: %s", wifi.ssid, wifi.password);
         return true;
     }
 
@@ -9,7 +9,6 @@
 #include <esp_http_server.h>
 #include <esp_wifi.h>
 #include <esp_log.h>
-#include <nvs.h>
 #include <string>
 #include <utility>
 
@@ -25,7 +24,7 @@ static const auto TAG = "wifi_setup";
 class SoftAPSetup {
 public:
     /**
-     * @brief Initialize a SoftAPSetup flow, requires nvs_flash to be started
+     * @brief Initialize a SoftAPSetup flow, requires ConfigStore::load()
      * @param ssid SSID of the AP
      * @param password Password of the AP
      */
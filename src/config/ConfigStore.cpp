@@ -0,0 +1,232 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#include "config/ConfigStore.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <esp_log.h>
+#include <esp_rom_crc.h>
+#include <freertos/task.h>
+#include <nvs.h>
+
+static auto TAG = "ConfigStore";
+
+static constexpr auto NAMESPACE = "config";
+static constexpr auto KEY = "blob";
+static constexpr uint32_t MAGIC = 0x47464353; // "SCFG"
+
+namespace {
+    struct BlobHeader {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t size;    ///< Payload bytes, a prefix of DeviceConfig as laid out by that version
+        uint32_t crc;     ///< CRC-32 of the payload
+    };
+
+    /**
+     * @brief Upgrades a config from version `from` to `from + 1`
+     */
+    struct Migration {
+        uint16_t from;
+        void (*apply)(DeviceConfig &config);
+    };
+}
+
+DeviceConfig ConfigStore::config{};
+portMUX_TYPE ConfigStore::lock = portMUX_INITIALIZER_UNLOCKED;
+bool ConfigStore::dirty = false;
+uint32_t ConfigStore::writes = 0;
+esp_timer_handle_t ConfigStore::timer = nullptr;
+
+static std::atomic<bool> committing{false};
+static std::atomic<uint32_t> commits{0};
+static std::atomic<uint32_t> commit_failures{0};
+
+static DeviceConfig defaults() {
+    DeviceConfig config{};
+    config.calibration = {.scale = 1.0f, .filter_alpha = 0.3f};
+    // Initial state of Pump
+    config.pump = {
+        .mode = PumpMode::OFF,
+        .duty = 100,
+        .ramp_ms = 2000,
+        .schedule_on_s = 60,
+        .schedule_off_s = 0,
+        .dry_threshold = 0.0f,
+        .dry_hysteresis = 0.0f,
+    };
+    return config;
+}
+
+// Version 0 is the layout before the store: Wi-Fi credentials as strings in the "wifi" namespace.
+// The namespace is left in place for firmware rolled back to that layout.
+static void import_legacy_wifi(DeviceConfig &config) {
+    nvs_handle_t nvs;
+    if (nvs_open("wifi", NVS_READONLY, &nvs) != ESP_OK) {
+        return;
+    }
+    WifiConfig wifi{};
+    size_t ssid_size = sizeof(wifi.ssid);
+    size_t pass_size = sizeof(wifi.password);
+    if (nvs_get_str(nvs, "ssid", wifi.ssid, &ssid_size) == ESP_OK &&
+        nvs_get_str(nvs, "pass", wifi.password, &pass_size) == ESP_OK) {
+        config.wifi = wifi;
+        ESP_LOGI(TAG, "Imported Wi-Fi credentials for %s", wifi.ssid);
+    }
+    nvs_close(nvs);
+}
+
+static constexpr Migration MIGRATIONS[] = {
+    {0, import_legacy_wifi},
+};
+
+/**
+ * @brief Reads the stored blob over `config`
+ * @return Version of the blob, 0 if there is none or it is corrupt
+ */
+static uint16_t read_blob(DeviceConfig &config) {
+    // Room for blobs written by newer firmware, whose extra settings are ignored
+    static uint8_t blob[1024];
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(NAMESPACE, NVS_READONLY, &nvs);
+    size_t len = sizeof(blob);
+    if (err == ESP_OK) {
+        err = nvs_get_blob(nvs, KEY, blob, &len);
+        nvs_close(nvs);
+    }
+    if (err != ESP_OK) {
+        if (err != ESP_ERR_NVS_NOT_FOUND) {
+            ESP_LOGE(TAG, "Cannot read the config: %s", esp_err_to_name(err));
+        }
+        return 0;
+    }
+
+    BlobHeader header{};
+    if (len >= sizeof(header)) {
+        memcpy(&header, blob, sizeof(header));
+    }
+    const uint8_t *payload = blob + sizeof(header);
+    if (len < sizeof(header) || header.magic != MAGIC || header.version == 0 ||
+        header.size != len - sizeof(header) || esp_rom_crc32_le(0, payload, header.size) != header.crc) {
+        ESP_LOGE(TAG, "Stored config is corrupt, using defaults");
+        return 0;
+    }
+    memcpy(&config, payload, std::min<size_t>(header.size, sizeof(config)));
+    return header.version;
+}
+
+void ConfigStore::load() {
+    DeviceConfig loaded = defaults();
+    const uint16_t version = read_blob(loaded);
+    for (const Migration &migration : MIGRATIONS) {
+        if (migration.from >= version && migration.from < VERSION) {
+            ESP_LOGI(TAG, "Migrating config from version %u", static_cast<unsigned>(migration.from));
+            migration.apply(loaded);
+        }
+    }
+
+    taskENTER_CRITICAL(&lock);
+    config = loaded;
+    // A newer layout is kept until something changes, rewriting it now would drop settings this build ignores
+    dirty = version < VERSION;
+    taskEXIT_CRITICAL(&lock);
+    if (version > VERSION) {
+        ESP_LOGW(TAG, "Config version %u is newer than %u, unknown settings are ignored", static_cast<unsigned>(version),
+                 static_cast<unsigned>(VERSION));
+    }
+
+    const esp_timer_create_args_t args = {
+        .callback = commit,
+        .arg = nullptr,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "config",
+        .skip_unhandled_events = false,
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&args, &timer));
+    // Migrated configs are written once, right away
+    commit(nullptr);
+    ESP_LOGI(TAG, "Config loaded (stored version %u)", static_cast<unsigned>(version));
+}
+
+void ConfigStore::schedule_commit() {
+    if (!timer) {
+        return;
+    }
+    // Every write pushes the commit back, so a burst of changes is committed once
+    esp_timer_stop(timer);
+    esp_timer_start_once(timer, COMMIT_DELAY_MS * 1000);
+}
+
+void ConfigStore::flush() {
+    if (timer) {
+        esp_timer_stop(timer);
+    }
+    commit(nullptr);
+}
+
+void ConfigStore::commit(void *) {
+    // The timer and flush() may commit concurrently, the later snapshot must be written last
+    while (committing.exchange(true)) {
+        vTaskDelay(1);
+    }
+    uint8_t blob[sizeof(BlobHeader) + sizeof(DeviceConfig)];
+    uint8_t *payload = blob + sizeof(BlobHeader);
+    taskENTER_CRITICAL(&lock);
+    const bool pending = dirty;
+    if (pending) {
+        memcpy(payload, &config, sizeof(config));
+        dirty = false;
+    }
+    taskEXIT_CRITICAL(&lock);
+    if (!pending) {
+        committing.store(false);
+        return;
+    }
+
+    const BlobHeader header = {
+        .magic = MAGIC,
+        .version = VERSION,
+        .size = sizeof(DeviceConfig),
+        .crc = esp_rom_crc32_le(0, payload, sizeof(DeviceConfig)),
+    };
+    memcpy(blob, &header, sizeof(header));
+    // NVS writes the new entry before erasing the old one, a power cut leaves either blob intact
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(NAMESPACE, NVS_READWRITE, &nvs);
+    if (err == ESP_OK) {
+        err = nvs_set_blob(nvs, KEY, blob, sizeof(blob));
+        if (err == ESP_OK) {
+            err = nvs_commit(nvs);
+        }
+        nvs_close(nvs);
+    }
+    if (err == ESP_OK) {
+        commits.fetch_add(1);
+        ESP_LOGI(TAG, "Config committed");
+    } else {
+        // Retried with the next change or flush()
+        taskENTER_CRITICAL(&lock);
+        dirty = true;
+        taskEXIT_CRITICAL(&lock);
+        commit_failures.fetch_add(1);
+        ESP_LOGE(TAG, "Cannot write the config: %s", esp_err_to_name(err));
+    }
+    committing.store(false);
+}
+
+void ConfigStore::render_metrics(ResponseBuffer &out) {
+    taskENTER_CRITICAL(&lock);
+    const uint32_t write_count = writes;
+    taskEXIT_CRITICAL(&lock);
+    out.appendf("# HELP config_writes_total Configuration changes\n# TYPE config_writes_total counter\n"
+                "config_writes_total %" PRIu32 "\n"
+                "# HELP config_commits_total NVS commits of the configuration blob\n"
+                "# TYPE config_commits_total counter\nconfig_commits_total %" PRIu32 "\n"
+                "# HELP config_commit_failures_total Failed configuration commits\n"
+                "# TYPE config_commit_failures_total counter\nconfig_commit_failures_total %" PRIu32 "\n",
+                write_count, commits.load(), commit_failures.load());
+}
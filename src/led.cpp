@@ -10,11 +10,14 @@ void configure_led(led_strip_handle_t *ledStrip) {
     led_strip_config_t strip_config = {};
     strip_config.strip_gpio_num = GPIO_NUM_48;
     strip_config.max_leds = 1;
-    led_strip_spi_config_t spi_config = {};
-    spi_config.spi_bus = SPI2_HOST;
-    spi_config.flags.with_dma = false;
+    // RMT with DMA streams the frame without the CPU feeding the RMT memory block
+    led_strip_rmt_config_t rmt_config = {};
+    rmt_config.clk_src = RMT_CLK_SRC_DEFAULT;
+    rmt_config.resolution_hz = 10 * 1000 * 1000;
+    rmt_config.mem_block_symbols = 64;
+    rmt_config.flags.with_dma = true;
 
-    ESP_ERROR_CHECK(led_strip_new_spi_device(&strip_config, &spi_config, ledStrip));
+    ESP_ERROR_CHECK(led_strip_new_rmt_device(&strip_config, &rmt_config, ledStrip));
     led_strip_clear(*ledStrip);
 }
 
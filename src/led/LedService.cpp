@@ -0,0 +1,112 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#include "led/LedService.hpp"
+
+#include <esp_log.h>
+
+#include "led.hpp"
+
+static auto TAG = "LedService";
+
+led_strip_handle_t LedService::strip = nullptr;
+esp_timer_handle_t LedService::timer = nullptr;
+TaskHandle_t LedService::task = nullptr;
+std::atomic<uint32_t> LedService::mailbox[static_cast<size_t>(Source::COUNT)];
+uint32_t LedService::shown = 0;
+
+// Mailbox word: r:8 g:8 b:8 pattern:4 code:4, 0 means empty
+static constexpr uint32_t pack(const LedPattern pattern, const COLOR color, const uint8_t code) {
+    return static_cast<uint32_t>(color.r) << 24 | static_cast<uint32_t>(color.g) << 16 |
+           static_cast<uint32_t>(color.b) << 8 | (static_cast<uint32_t>(pattern) & 0x0F) << 4 | (code & 0x0F);
+}
+
+void LedService::start() {
+    if (timer) {
+        return;
+    }
+    configure_led(&strip);
+    xTaskCreatePinnedToCore(run, "led", 3072, nullptr, 1, &task, 0);
+    const esp_timer_create_args_t args = {
+        .callback = tick,
+        .arg = nullptr,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "led",
+        .skip_unhandled_events = true,
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&args, &timer));
+    ESP_ERROR_CHECK(esp_timer_start_periodic(timer, FRAME_PERIOD_MS * 1000));
+    ESP_LOGI(TAG, "LED service started");
+}
+
+void LedService::post(const Source source, const LedPattern pattern, const COLOR color, const uint8_t code) {
+    mailbox[static_cast<size_t>(source)].store(pack(pattern, color, code), std::memory_order_relaxed);
+}
+
+void LedService::clear(const Source source) {
+    mailbox[static_cast<size_t>(source)].store(0, std::memory_order_relaxed);
+}
+
+void LedService::tick([[maybe_unused]] void *arg) {
+    xTaskNotifyGive(task);
+}
+
+void LedService::run([[maybe_unused]] void *arg) {
+    for (;;) {
+        // Ticks that arrive while a refresh is in progress collapse into one frame
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        frame();
+    }
+}
+
+void LedService::frame() {
+    uint32_t message = 0;
+    for (const auto &slot : mailbox) {
+        if ((message = slot.load(std::memory_order_relaxed)) != 0) {
+            break;
+        }
+    }
+
+    const auto pattern = static_cast<LedPattern>((message >> 4) & 0x0F);
+    const uint32_t code = message & 0x0F;
+    const auto now_ms = static_cast<uint32_t>(esp_timer_get_time() / 1000);
+    uint32_t level = 0;
+    switch (pattern) {
+        case LedPattern::NONE:
+            break;
+        case LedPattern::SOLID:
+            level = 255;
+            break;
+        case LedPattern::BLINK:
+            level = now_ms % 500 < 250 ? 255 : 0;
+            break;
+        case LedPattern::BREATHE: {
+            const uint32_t phase = now_ms % 2000;
+            const uint32_t linear = (phase < 1000 ? phase : 2000 - phase) * 255 / 1000;
+            // Square for a perceptually even fade
+            level = linear * linear / 255;
+            break;
+        }
+        case LedPattern::CODE: {
+            // 200 ms flash every 400 ms, `code` times, then a 1.2 s pause
+            const uint32_t flashes_ms = (code ? code : 1) * 400;
+            const uint32_t phase = now_ms % (flashes_ms + 1200);
+            level = phase < flashes_ms && phase % 400 < 200 ? 255 : 0;
+            break;
+        }
+    }
+
+    const COLOR color = {
+        static_cast<uint8_t>((message >> 24) * level / 255),
+        static_cast<uint8_t>(((message >> 16) & 0xFF) * level / 255),
+        static_cast<uint8_t>(((message >> 8) & 0xFF) * level / 255),
+    };
+    const uint32_t packed = static_cast<uint32_t>(color.r) << 16 | static_cast<uint32_t>(color.g) << 8 | color.b;
+    if (packed != shown) {
+        // Only this task touches the strip, the refresh blocks until the RMT transmission is done
+        set_led_color(strip, color);
+        shown = packed;
+    }
+}
@@ -1,4 +1,4 @@
-#include <led_strip.h>
+#include <atomic>
 #include <nvs_flash.h>
 #include <freertos/FreeRTOS.h>
 
@@ -6,24 +6,42 @@
 #include <SoftAPSetup.hpp>
 
 #include "colors.hpp"
-#include "led.hpp"
+#include "config/ConfigStore.hpp"
+#include "led/LedService.hpp"
+#include "mem/HeapGuard.hpp"
+#include "metrics/Metrics.hpp"
+#include "metrics/TaskStats.hpp"
+#include "mqtt/MqttPublisher.hpp"
+#include "ota/Ota.hpp"
+#include "power/LowPower.hpp"
+#include "pump/Pump.hpp"
+#include "pump/PumpApi.hpp"
+#include "scale/Sampler.hpp"
+#include "scale/ScaleApi.hpp"
 #include "server/WebServer.hpp"
+#include "trace/Trace.hpp"
 
 
 // Declare and define a custom event base for scale-related events
 ESP_EVENT_DECLARE_BASE(SCALE_EVENT);
 ESP_EVENT_DEFINE_BASE(SCALE_EVENT);
 
-static led_strip_handle_t g_led_strip = nullptr;
 // Use a dedicated event loop for scale-related events (avoid default loop where possible)
 static esp_event_loop_handle_t g_scale_loop = nullptr;
+// Publishes filtered weight readings once the scale is tared
+static Sampler *g_sampler = nullptr;
+// Station has an IP and the web server is up
+static std::atomic<bool> g_online{false};
 
 static void on_ip_got(void *arg, esp_event_base_t event_base, int32_t event_id, [[maybe_unused]] void *event_data) {
     if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
+        TRACE_SCOPE("net.got_ip");
         ESP_LOGI("net", "Got IP, starting server");
         auto *server = static_cast<WebServer *>(arg);
+        LedService::clear(LedService::Source::WIFI);
         // Start server when station gets an IP
         server->start();
+        g_online.store(true);
     }
 }
 
@@ -32,9 +50,13 @@ static void on_wifi_disconnected(void *arg,
                                  int32_t event_id,
                                  [[maybe_unused]] void *event_data) {
     if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
+        TRACE_SCOPE_ARG("net.disconnected", static_cast<wifi_event_sta_disconnected_t *>(event_data)->reason);
         ESP_LOGE("net", "Disconnected from AP");
         auto *server = static_cast<WebServer *>(arg);
-        // Stop server when disconnected
+        LedService::post(LedService::Source::WIFI, LedPattern::CODE, COLOR_RED, 2);
+        // Stop server when disconnected, parked long polls are answered first
+        g_online.store(false);
+        ScaleApi::drain();
         server->stop();
         // Restart
         //esp_restart();
@@ -49,22 +71,40 @@ static void on_scale_init(void *arg,
     if (event_base == SCALE_EVENT) {
         auto *sc = static_cast<HX711 *>(arg);
         ESP_LOGI("scale", "Initializing HX711 scale in worker task");
-        set_led_color(g_led_strip, COLOR_ORANGE);
-        sc->tare(10);
-        set_led_color(g_led_strip, COLOR_NONE);
+        LedService::post(LedService::Source::SCALE, LedPattern::BREATHE, COLOR_ORANGE);
+#if SMART_FOUNTAIN_LOW_POWER
+        // Woken from deep sleep with the water in place, taring now would zero it
+        const bool tared = LowPower::restore_tare(*sc);
+#else
+        constexpr bool tared = false;
+#endif
+        if (!tared) {
+            TRACE_SCOPE("scale.tare");
+            sc->tare(10);
+        }
+        LedService::clear(LedService::Source::SCALE);
         ESP_LOGI("scale", "Scale initialized and tared");
+        // From now on the sampler task is the only reader of the HX711
+        g_sampler->start();
     }
 }
 
 
 extern "C" void app_main(void) {
-    // Reset LED
-    configure_led(&g_led_strip);
-    set_led_color(g_led_strip, COLOR_NONE);
+#if SMART_FOUNTAIN_LOW_POWER
+    // Before anything touches the HX711 pins, which the ULP may still own
+    LowPower::boot();
+#endif
+    // Status LED, blinks blue until the station gets an IP
+    LedService::start();
+    LedService::post(LedService::Source::WIFI, LedPattern::BLINK, COLOR_BLUE);
 
     // Init nvs & net stack
     nvs_flash_init();
     esp_netif_init();
+    // Settings are read from RAM from here on
+    ConfigStore::load();
+    Metrics::register_collector(ConfigStore::render_metrics);
 
     // Create the default event loop
     esp_event_loop_create_default();
@@ -84,6 +124,48 @@ extern "C" void app_main(void) {
 
     static auto *server = new WebServer();
     static auto *scale = new HX711(GPIO_NUM_1, GPIO_NUM_2, GAIN_128);
+    const CalibrationConfig calibration = ConfigStore::get(&DeviceConfig::calibration);
+    scale->set_scale(calibration.scale);
+    g_sampler = new Sampler(*scale, calibration.filter_alpha);
+    static auto *pump = new Pump(GPIO_NUM_4, *g_sampler);
+    restore_pump_config(*pump);
+    pump->start();
+    Metrics::register_collector([](ResponseBuffer &out) { pump->render_metrics(out); });
+    Metrics::register_collector([](ResponseBuffer &out) { g_sampler->render_metrics(out); });
+    TaskStats::start();
+    Metrics::register_collector(TaskStats::render_metrics);
+    Metrics::register_collector(HeapGuard::render_metrics);
+#if SMART_FOUNTAIN_TRACE
+    Metrics::register_collector(Trace::render_metrics);
+#endif
+
+    // Push telemetry to the broker, queued through Wi-Fi and broker outages
+    static auto *publisher = new MqttPublisher(*g_sampler, *pump);
+    publisher->start();
+    Metrics::register_collector([](ResponseBuffer &out) { publisher->render_metrics(out); });
+#if SMART_FOUNTAIN_LOW_POWER
+    if (const ulp_wake_reason_t reason = LowPower::wake_reason(); reason != ULP_WAKE_NONE) {
+        char detail[16];
+        snprintf(detail, sizeof(detail), "\"%s\"", LowPower::reason_name(reason));
+        publisher->event("wake", detail);
+        LowPower::replay([](const Reading &reading) { publisher->sample(reading); });
+    }
+#endif
+
+    // A freshly updated image is kept only once it is online and reading the scale
+    Ota::start([] { return g_online.load() && g_sampler->latest().seq > 0; });
+    Metrics::register_collector(Ota::render_metrics);
+
+#if SMART_FOUNTAIN_LOW_POWER
+    // Sleep once online, with nothing to pump and no update in flight. Samples are queued every second, so waiting
+    // for an empty queue would never sleep; it is flushed right before sleeping instead
+    LowPower::start(*scale, [] {
+        return g_online.load() && pump->status().mode == PumpMode::OFF && Ota::idle();
+    }, [] {
+        return static_cast<uint32_t>(publisher->flush(LowPower::FLUSH_TIMEOUT_MS));
+    });
+    Metrics::register_collector(LowPower::render_metrics);
+#endif
 
     // Register Wi-Fi/IP event handlers to control the web server lifecycle
     esp_event_handler_instance_t got_ip_instance;
@@ -110,13 +192,19 @@ extern "C" void app_main(void) {
                 httpd_resp_sendstr(req, "Hello World");
                 return ESP_OK;
             })
-            .registerUri("/scale", HTTP_GET, [](httpd_req_t *req) {
-                const auto scale_value = scale->get_units();
-                const auto resp = R"({"value": )" + std::to_string(scale_value) + R"(})";
-                httpd_resp_set_type(req, "application/json");
-                httpd_resp_send(req, resp.c_str(), HTTPD_RESP_USE_STRLEN);
-                return ESP_OK;
-            });
+            .registerUri("/metrics", HTTP_GET, Metrics::handler)
+            .registerUri("/api/tasks", HTTP_GET, TaskStats::handler)
+            .registerUri("/api/ota", HTTP_GET, Ota::status_handler)
+            .registerUri("/api/ota", HTTP_POST, Ota::handler);
+#if SMART_FOUNTAIN_TRACE
+    server->registerUri("/api/trace", HTTP_GET, Trace::handler);
+#endif
+    register_pump_routes(*server, *pump);
+    ScaleApi::start(*server, *g_sampler);
+    Metrics::register_collector(ScaleApi::render_metrics);
+
+    // Everything below runs from preallocated buffers
+    HeapGuard::seal();
 
     vTaskDelay(portMAX_DELAY);
 }
\ No newline at end of file
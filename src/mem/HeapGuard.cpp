@@ -0,0 +1,177 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#include "mem/HeapGuard.hpp"
+
+#include <cinttypes>
+#include <esp_attr.h>
+#include <esp_heap_caps.h>
+#include <esp_log.h>
+
+static auto TAG = "HeapGuard";
+
+struct ScopeSlot {
+    std::atomic<TaskHandle_t> task{nullptr};
+    std::atomic<uint32_t> count{0};
+};
+
+static std::atomic<TaskHandle_t> g_watched[HeapGuard::MAX_WATCHED];
+static std::atomic<TaskHandle_t> g_exempt[HeapGuard::MAX_SCOPES];
+static ScopeSlot g_scopes[HeapGuard::MAX_SCOPES];
+static std::atomic<bool> g_sealed{false};
+static std::atomic<uint32_t> g_allocations{0};
+static std::atomic<uint32_t> g_frees{0};
+static std::atomic<uint32_t> g_violations{0};
+static std::atomic<uint32_t> g_watched_allocations{0};
+static std::atomic<uint32_t> g_untracked{0};
+static std::atomic<uint32_t> g_unexempted{0};
+
+HeapGuard::Scope::Scope() : m_slot(-1) {
+    const TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    for (size_t i = 0; i < MAX_SCOPES; ++i) {
+        TaskHandle_t expected = nullptr;
+        if (g_scopes[i].task.compare_exchange_strong(expected, self)) {
+            g_scopes[i].count.store(0, std::memory_order_relaxed);
+            m_slot = static_cast<int>(i);
+            return;
+        }
+    }
+    g_untracked.fetch_add(1, std::memory_order_relaxed);
+    ESP_LOGW(TAG, "Scope table full, allocations of this scope are not counted");
+}
+
+HeapGuard::Scope::~Scope() {
+    if (m_slot >= 0) {
+        g_scopes[m_slot].task.store(nullptr);
+    }
+}
+
+bool HeapGuard::Scope::tracked() const {
+    return m_slot >= 0;
+}
+
+uint32_t HeapGuard::Scope::count() const {
+    return m_slot >= 0 ? g_scopes[m_slot].count.load(std::memory_order_relaxed) : 0;
+}
+
+HeapGuard::Exempt::Exempt() : m_slot(-1) {
+    const TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    for (size_t i = 0; i < MAX_SCOPES; ++i) {
+        TaskHandle_t expected = nullptr;
+        if (g_exempt[i].compare_exchange_strong(expected, self)) {
+            m_slot = static_cast<int>(i);
+            return;
+        }
+    }
+    g_unexempted.fetch_add(1, std::memory_order_relaxed);
+    ESP_LOGW(TAG, "Exempt table full, allocations of this exemption count against the steady state");
+}
+
+HeapGuard::Exempt::~Exempt() {
+    if (m_slot >= 0) {
+        g_exempt[m_slot].store(nullptr);
+    }
+}
+
+void HeapGuard::watch(TaskHandle_t task) {
+    for (auto &slot : g_watched) {
+        TaskHandle_t expected = nullptr;
+        if (slot.compare_exchange_strong(expected, task) || expected == task) {
+            return;
+        }
+    }
+    ESP_LOGW(TAG, "Watch table full");
+}
+
+void HeapGuard::seal() {
+    g_sealed.store(true);
+    ESP_LOGI(TAG, "Boot done after %" PRIu32 " allocations, steady state enforced", g_allocations.load());
+}
+
+bool HeapGuard::sealed() {
+    return g_sealed.load(std::memory_order_relaxed);
+}
+
+void HeapGuard::report(const char *what, const uint32_t allocations) {
+    if (allocations == 0 || !sealed()) {
+        return;
+    }
+    g_violations.fetch_add(allocations, std::memory_order_relaxed);
+    ESP_LOGW(TAG, "%s allocated %" PRIu32 " times in steady state", what, allocations);
+}
+
+uint32_t HeapGuard::allocations() {
+    return g_allocations.load(std::memory_order_relaxed);
+}
+
+uint32_t HeapGuard::violations() {
+    return g_violations.load(std::memory_order_relaxed) + g_watched_allocations.load(std::memory_order_relaxed);
+}
+
+void HeapGuard::render_metrics(ResponseBuffer &out) {
+    const size_t free_bytes = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    const size_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+    const double fragmentation = free_bytes ? 1.0 - static_cast<double>(largest) / free_bytes : 0.0;
+    out.appendf("# HELP heap_free_bytes Free internal heap\n# TYPE heap_free_bytes gauge\nheap_free_bytes %u\n"
+                "# HELP heap_min_free_bytes Lowest free internal heap since boot\n"
+                "# TYPE heap_min_free_bytes gauge\nheap_min_free_bytes %u\n"
+                "# HELP heap_largest_free_block_bytes Largest allocatable internal block\n"
+                "# TYPE heap_largest_free_block_bytes gauge\nheap_largest_free_block_bytes %u\n"
+                "# HELP heap_fragmentation_ratio 1 - largest free block / free heap\n"
+                "# TYPE heap_fragmentation_ratio gauge\nheap_fragmentation_ratio %.4f\n",
+                static_cast<unsigned>(free_bytes),
+                static_cast<unsigned>(heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL)),
+                static_cast<unsigned>(largest), fragmentation);
+    out.appendf("# HELP heap_allocations_total Heap allocations since boot\n"
+                "# TYPE heap_allocations_total counter\nheap_allocations_total %" PRIu32 "\n"
+                "# HELP heap_frees_total Heap frees since boot\n# TYPE heap_frees_total counter\n"
+                "heap_frees_total %" PRIu32 "\n"
+                "# HELP heap_steady_state_violations_total Allocations on steady-state paths after boot\n"
+                "# TYPE heap_steady_state_violations_total counter\nheap_steady_state_violations_total %" PRIu32 "\n"
+                "# HELP heap_untracked_scopes_total Scopes opened while every slot was taken, not counted\n"
+                "# TYPE heap_untracked_scopes_total counter\nheap_untracked_scopes_total %" PRIu32 "\n"
+                "# HELP heap_unexempted_total Exemptions opened while every slot was taken, counted as usual\n"
+                "# TYPE heap_unexempted_total counter\nheap_unexempted_total %" PRIu32 "\n"
+                "# HELP response_buffer_exhausted_total Requests refused because no response buffer was free\n"
+                "# TYPE response_buffer_exhausted_total counter\nresponse_buffer_exhausted_total %" PRIu32 "\n",
+                g_allocations.load(), g_frees.load(), violations(), g_untracked.load(), g_unexempted.load(), ResponseBuffer::exhausted());
+}
+
+IRAM_ATTR void HeapGuard::on_alloc() {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    const TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    for (const auto &exempt : g_exempt) {
+        if (exempt.load(std::memory_order_relaxed) == self) {
+            return;
+        }
+    }
+    for (auto &slot : g_scopes) {
+        if (slot.task.load(std::memory_order_relaxed) == self) {
+            slot.count.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    if (g_sealed.load(std::memory_order_relaxed)) {
+        for (const auto &watched : g_watched) {
+            if (watched.load(std::memory_order_relaxed) == self) {
+                g_watched_allocations.fetch_add(1, std::memory_order_relaxed);
+                break;
+            }
+        }
+    }
+}
+
+IRAM_ATTR void HeapGuard::on_free() {
+    g_frees.fetch_add(1, std::memory_order_relaxed);
+}
+
+extern "C" IRAM_ATTR void esp_heap_trace_alloc_hook([[maybe_unused]] void *ptr,
+                                                    [[maybe_unused]] size_t size,
+                                                    [[maybe_unused]] uint32_t caps) {
+    HeapGuard::on_alloc();
+}
+
+extern "C" IRAM_ATTR void esp_heap_trace_free_hook([[maybe_unused]] void *ptr) {
+    HeapGuard::on_free();
+}
@@ -0,0 +1,115 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#include "mem/ResponseBuffer.hpp"
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <esp_log.h>
+
+#include "mem/BlockPool.hpp"
+
+static auto TAG = "ResponseBuffer";
+
+static BlockPool<ResponseBuffer::BLOCK_SIZE, ResponseBuffer::BLOCK_COUNT> pool;
+
+ResponseBuffer::ResponseBuffer(httpd_req_t *req) : m_req(req), m_data(pool.acquire()) {
+    if (!m_data) {
+        ESP_LOGW(TAG, "Response buffer pool exhausted");
+    }
+}
+
+ResponseBuffer::~ResponseBuffer() {
+    if (m_data) {
+        pool.release(m_data);
+    }
+}
+
+void ResponseBuffer::append_slow(const char *data, size_t len) {
+    if (!m_data) {
+        m_truncated = true;
+        return;
+    }
+    while (len > 0) {
+        if (m_len == BLOCK_SIZE && !flush()) {
+            m_truncated = true;
+            return;
+        }
+        const size_t n = len < BLOCK_SIZE - m_len ? len : BLOCK_SIZE - m_len;
+        memcpy(m_data + m_len, data, n);
+        m_len += n;
+        data += n;
+        len -= n;
+    }
+}
+
+void ResponseBuffer::append(const char *str) {
+    append(str, strlen(str));
+}
+
+void ResponseBuffer::appendf(const char *fmt, ...) {
+    if (!m_data) {
+        m_truncated = true;
+        return;
+    }
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        va_list args;
+        va_start(args, fmt);
+        const int n = vsnprintf(m_data + m_len, BLOCK_SIZE - m_len, fmt, args);
+        va_end(args);
+        if (n < 0) {
+            return;
+        }
+        if (static_cast<size_t>(n) < BLOCK_SIZE - m_len) {
+            m_len += n;
+            return;
+        }
+        // Did not fit: flush what is already buffered and format again into the empty block
+        if (m_len == 0 || !flush()) {
+            break;
+        }
+    }
+    m_truncated = true;
+}
+
+bool ResponseBuffer::flush() {
+    if (!m_req) {
+        return false;
+    }
+    if (m_len > 0 && httpd_resp_send_chunk(m_req, m_data, static_cast<ssize_t>(m_len)) != ESP_OK) {
+        m_req = nullptr;
+        return false;
+    }
+    m_chunked = true;
+    m_len = 0;
+    return true;
+}
+
+esp_err_t ResponseBuffer::send() {
+    if (!m_req) {
+        return ESP_FAIL;
+    }
+    if (!m_data) {
+        httpd_resp_set_status(m_req, "503 Service Unavailable");
+        return httpd_resp_send(m_req, nullptr, 0);
+    }
+    if (!m_chunked) {
+        return httpd_resp_send(m_req, m_data, static_cast<ssize_t>(m_len));
+    }
+    if (m_len > 0 && httpd_resp_send_chunk(m_req, m_data, static_cast<ssize_t>(m_len)) != ESP_OK) {
+        return ESP_FAIL;
+    }
+    m_len = 0;
+    return httpd_resp_send_chunk(m_req, nullptr, 0);
+}
+
+size_t ResponseBuffer::in_use() {
+    return pool.in_use();
+}
+
+uint32_t ResponseBuffer::exhausted() {
+    return pool.exhausted();
+}
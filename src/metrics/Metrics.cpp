@@ -0,0 +1,38 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#include "metrics/Metrics.hpp"
+
+#include <cinttypes>
+#include <esp_log.h>
+#include <esp_timer.h>
+
+static auto TAG = "Metrics";
+
+std::array<Metrics::Collector, Metrics::MAX_COLLECTORS> Metrics::collectors;
+size_t Metrics::collector_count = 0;
+
+void Metrics::register_collector(const Collector collector) {
+    if (collector_count == collectors.size()) {
+        ESP_LOGE(TAG, "Too many collectors");
+        return;
+    }
+    collectors[collector_count++] = collector;
+}
+
+void Metrics::render(ResponseBuffer &out) {
+    out.appendf("# HELP uptime_seconds Time since boot\n# TYPE uptime_seconds gauge\nuptime_seconds %" PRId64 "\n",
+                esp_timer_get_time() / 1000000);
+    for (size_t i = 0; i < collector_count; ++i) {
+        collectors[i](out);
+    }
+}
+
+esp_err_t Metrics::handler(httpd_req_t *req) {
+    ResponseBuffer out(req);
+    httpd_resp_set_type(req, "text/plain; version=0.0.4");
+    render(out);
+    return out.send();
+}
@@ -0,0 +1,171 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#include "metrics/TaskStats.hpp"
+
+#include <cinttypes>
+#include <cstring>
+#include <esp_log.h>
+
+#include "json/JsonWriter.hpp"
+
+static auto TAG = "TaskStats";
+
+TaskStats::Snapshot TaskStats::snapshots[2];
+size_t TaskStats::current = 0;
+std::array<TaskSample, TaskStats::MAX_TASKS> TaskStats::samples;
+size_t TaskStats::sample_count = 0;
+float TaskStats::core_load[portNUM_PROCESSORS];
+uint32_t TaskStats::window_us = 0;
+portMUX_TYPE TaskStats::lock = portMUX_INITIALIZER_UNLOCKED;
+esp_timer_handle_t TaskStats::timer = nullptr;
+
+// Scratch results, only touched by the esp_timer task and published under the lock
+static std::array<TaskSample, TaskStats::MAX_TASKS> pending;
+
+static const char *state_name(const eTaskState state) {
+    switch (state) {
+        case eRunning: return "running";
+        case eReady: return "ready";
+        case eBlocked: return "blocked";
+        case eSuspended: return "suspended";
+        case eDeleted: return "deleted";
+        default: return "invalid";
+    }
+}
+
+template<>
+struct JsonSchema<TaskSample> {
+    static constexpr auto fields = std::make_tuple(
+        json_field("name", &TaskSample::name),
+        json_field("core", &TaskSample::core),
+        json_field("priority", &TaskSample::priority),
+        json_field("state", &TaskSample::state, state_name),
+        json_field("cpu", &TaskSample::cpu_percent, 2),
+        json_field("stack_free", &TaskSample::stack_free));
+};
+
+void TaskStats::start(const uint32_t period_ms) {
+    if (timer) {
+        return;
+    }
+    const esp_timer_create_args_t args = {
+        .callback = sample,
+        .arg = nullptr,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "task_stats",
+        .skip_unhandled_events = true,
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&args, &timer));
+    sample(nullptr);
+    ESP_ERROR_CHECK(esp_timer_start_periodic(timer, static_cast<uint64_t>(period_ms) * 1000));
+    ESP_LOGI(TAG, "Sampling task stats every %" PRIu32 " ms", period_ms);
+}
+
+void TaskStats::sample([[maybe_unused]] void *arg) {
+    const Snapshot &prev = snapshots[current];
+    Snapshot &now = snapshots[current ^ 1];
+    now.count = uxTaskGetSystemState(now.tasks.data(), MAX_TASKS, &now.total);
+    current ^= 1;
+    if (now.count == 0) {
+        ESP_LOGW(TAG, "More than %u tasks, snapshot skipped", static_cast<unsigned>(MAX_TASKS));
+        return;
+    }
+    if (prev.count == 0) {
+        // First snapshot, nothing to diff against yet
+        return;
+    }
+
+    const configRUN_TIME_COUNTER_TYPE elapsed = now.total - prev.total;
+    if (elapsed == 0) {
+        return;
+    }
+
+    float idle[portNUM_PROCESSORS] = {};
+    for (UBaseType_t i = 0; i < now.count; ++i) {
+        const TaskStatus_t &task = now.tasks[i];
+        configRUN_TIME_COUNTER_TYPE delta = task.ulRunTimeCounter;
+        for (UBaseType_t j = 0; j < prev.count; ++j) {
+            if (prev.tasks[j].xHandle == task.xHandle) {
+                delta = task.ulRunTimeCounter - prev.tasks[j].ulRunTimeCounter;
+                break;
+            }
+        }
+
+        TaskSample &out = pending[i];
+        strlcpy(out.name, task.pcTaskName, sizeof(out.name));
+        const BaseType_t core = xTaskGetCoreID(task.xHandle);
+        out.core = core == tskNO_AFFINITY ? -1 : static_cast<int>(core);
+        out.priority = task.uxCurrentPriority;
+        out.state = task.eCurrentState;
+        out.cpu_percent = 100.0f * static_cast<float>(delta) / static_cast<float>(elapsed);
+        out.stack_free = task.usStackHighWaterMark;
+
+        for (BaseType_t c = 0; c < portNUM_PROCESSORS; ++c) {
+            if (task.xHandle == xTaskGetIdleTaskHandleForCore(c)) {
+                idle[c] = out.cpu_percent;
+            }
+        }
+    }
+
+    taskENTER_CRITICAL(&lock);
+    memcpy(samples.data(), pending.data(), now.count * sizeof(TaskSample));
+    sample_count = now.count;
+    for (size_t c = 0; c < portNUM_PROCESSORS; ++c) {
+        core_load[c] = idle[c] > 100.0f ? 0.0f : 100.0f - idle[c];
+    }
+    window_us = elapsed;
+    taskEXIT_CRITICAL(&lock);
+}
+
+void TaskStats::render_metrics(ResponseBuffer &out) {
+    std::array<TaskSample, MAX_TASKS> tasks;
+    taskENTER_CRITICAL(&lock);
+    const size_t count = sample_count;
+    memcpy(tasks.data(), samples.data(), count * sizeof(TaskSample));
+    float load[portNUM_PROCESSORS];
+    memcpy(load, core_load, sizeof(load));
+    taskEXIT_CRITICAL(&lock);
+
+    out.append("# HELP cpu_core_load_ratio Share of time the core was not idle over the last window\n"
+               "# TYPE cpu_core_load_ratio gauge\n");
+    for (size_t c = 0; c < portNUM_PROCESSORS; ++c) {
+        out.appendf("cpu_core_load_ratio{core=\"%u\"} %.4f\n",
+                    static_cast<unsigned>(c), static_cast<double>(load[c]) / 100.0);
+    }
+    out.append("# HELP task_cpu_ratio Share of one core used by the task over the last window\n"
+               "# TYPE task_cpu_ratio gauge\n");
+    for (size_t i = 0; i < count; ++i) {
+        const TaskSample &t = tasks[i];
+        out.appendf("task_cpu_ratio{task=\"%s\",core=\"%s\"} %.4f\n", t.name,
+                    t.core < 0 ? "any" : t.core == 0 ? "0" : "1", static_cast<double>(t.cpu_percent) / 100.0);
+    }
+    out.append("# HELP task_stack_free_bytes Lowest free stack observed for the task\n"
+               "# TYPE task_stack_free_bytes gauge\n");
+    for (size_t i = 0; i < count; ++i) {
+        out.appendf("task_stack_free_bytes{task=\"%s\"} %" PRIu32 "\n", tasks[i].name, tasks[i].stack_free);
+    }
+}
+
+esp_err_t TaskStats::handler(httpd_req_t *req) {
+    std::array<TaskSample, MAX_TASKS> tasks;
+    float load[portNUM_PROCESSORS];
+    taskENTER_CRITICAL(&lock);
+    const size_t count = sample_count;
+    const uint32_t window = window_us;
+    memcpy(tasks.data(), samples.data(), count * sizeof(TaskSample));
+    memcpy(load, core_load, sizeof(load));
+    taskEXIT_CRITICAL(&lock);
+
+    ResponseBuffer resp(req);
+    httpd_resp_set_type(req, "application/json");
+    JsonWriter json(resp);
+    json.begin_object().field("window_ms", window / 1000).key("cores").begin_array();
+    for (size_t c = 0; c < portNUM_PROCESSORS; ++c) {
+        json.begin_object().field("core", c).field("load", json_fixed(load[c], 2)).end_object();
+    }
+    json.end_array().key("tasks").array(tasks.data(), count).end_object();
+    return resp.send();
+}
@@ -0,0 +1,323 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#include "mqtt/MqttPublisher.hpp"
+
+#include <cinttypes>
+#include <cstring>
+#include <esp_heap_caps.h>
+#include <esp_log.h>
+#include <esp_mac.h>
+#include <esp_timer.h>
+
+static auto TAG = "MqttPublisher";
+
+static constexpr const char *TOPIC_NAMES[] = {"samples", "events", "metrics"};
+static constexpr int64_t LOOP_PERIOD_US = 100'000;
+static constexpr int64_t ACK_TIMEOUT_US = 10'000'000;
+static constexpr int64_t RATE_WINDOW_US = 10'000'000;
+
+MqttPublisher::MqttPublisher(Sampler &sampler, const Pump &pump, const Config &config) : m_sampler(sampler),
+    m_pump(pump),
+    m_config(config) {}
+
+void MqttPublisher::start() {
+    if (m_client) {
+        return;
+    }
+
+    uint8_t mac[6] = {};
+    esp_read_mac(mac, ESP_MAC_WIFI_STA);
+    char device_id[13];
+    snprintf(device_id, sizeof(device_id), "%02x%02x%02x%02x%02x%02x", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+    for (size_t i = 0; i < static_cast<size_t>(MqttTopic::COUNT); ++i) {
+        snprintf(m_topics[i], sizeof(m_topics[i]), "%s/%s/%s", m_config.base_topic, device_id, TOPIC_NAMES[i]);
+    }
+    static char client_id[32];
+    snprintf(client_id, sizeof(client_id), "smart-fountain-%s", device_id);
+
+    esp_mqtt_client_config_t mqtt_config = {};
+    mqtt_config.broker.address.uri = m_config.broker_uri;
+    mqtt_config.credentials.client_id = client_id;
+    mqtt_config.network.reconnect_timeout_ms = 5000;
+    mqtt_config.buffer.size = BATCH_BYTES + 128;
+    m_client = esp_mqtt_client_init(&mqtt_config);
+    if (!m_client) {
+        ESP_LOGE(TAG, "Failed to create MQTT client");
+        return;
+    }
+    esp_mqtt_client_register_event(m_client, MQTT_EVENT_ANY, on_mqtt_event, this);
+    esp_mqtt_client_start(m_client);
+
+    event("boot");
+    xTaskCreatePinnedToCore(task_entry, "mqtt_pub", 4096, this, 3, &m_task, 0);
+    ESP_LOGI(TAG, "Publishing to %s under %s/%s", m_config.broker_uri, m_config.base_topic, device_id);
+}
+
+void MqttPublisher::event(const char *name, const char *detail) {
+    const int64_t now_us = esp_timer_get_time();
+    char payload[RECORD_SIZE];
+    const int len = detail
+                        ? snprintf(payload, sizeof(payload), R"({"t":%)" PRId64 R"(,"event":"%s","detail":%s})",
+                                   now_us / 1000, name, detail)
+                        : snprintf(payload, sizeof(payload), R"({"t":%)" PRId64 R"(,"event":"%s"})", now_us / 1000,
+                                   name);
+    if (len > 0 && static_cast<size_t>(len) < sizeof(payload)) {
+        enqueue(MqttTopic::EVENTS, now_us, payload, len);
+    } else {
+        ESP_LOGW(TAG, "Event %s too large, dropped", name);
+    }
+}
+
+void MqttPublisher::sample(const Reading &reading) {
+    enqueue_sample(reading);
+}
+
+size_t MqttPublisher::pending() const {
+    taskENTER_CRITICAL(&m_lock);
+    const size_t depth = m_count;
+    taskEXIT_CRITICAL(&m_lock);
+    return depth;
+}
+
+size_t MqttPublisher::flush(const uint32_t timeout_ms) {
+    m_flushing.store(true);
+    for (uint32_t waited_ms = 0; pending() > 0 && waited_ms < timeout_ms; waited_ms += LOOP_PERIOD_US / 1000) {
+        vTaskDelay(pdMS_TO_TICKS(LOOP_PERIOD_US / 1000));
+    }
+    m_flushing.store(false);
+    return pending();
+}
+
+void MqttPublisher::render_metrics(ResponseBuffer &out) const {
+    taskENTER_CRITICAL(&m_lock);
+    const size_t depth = m_count;
+    taskEXIT_CRITICAL(&m_lock);
+    out.appendf("# HELP mqtt_connected Connected to the MQTT broker\n# TYPE mqtt_connected gauge\nmqtt_connected %d\n"
+                "# HELP mqtt_queue_depth Records waiting to be published\n# TYPE mqtt_queue_depth gauge\n"
+                "mqtt_queue_depth %u\n"
+                "# HELP mqtt_queue_capacity Capacity of the store-and-forward queue\n"
+                "# TYPE mqtt_queue_capacity gauge\nmqtt_queue_capacity %u\n"
+                "# HELP mqtt_published_records_total Records delivered to the broker\n"
+                "# TYPE mqtt_published_records_total counter\nmqtt_published_records_total %" PRIu32 "\n"
+                "# HELP mqtt_published_batches_total Batches delivered to the broker\n"
+                "# TYPE mqtt_published_batches_total counter\nmqtt_published_batches_total %" PRIu32 "\n"
+                "# HELP mqtt_dropped_records_total Records dropped because the queue was full\n"
+                "# TYPE mqtt_dropped_records_total counter\nmqtt_dropped_records_total %" PRIu32 "\n"
+                "# HELP mqtt_publish_failures_total Publish calls rejected or not acknowledged in time\n"
+                "# TYPE mqtt_publish_failures_total counter\nmqtt_publish_failures_total %" PRIu32 "\n"
+                "# HELP mqtt_publish_rate Records published per second over the last 10 s\n"
+                "# TYPE mqtt_publish_rate gauge\nmqtt_publish_rate %.2f\n",
+                m_connected.load() ? 1 : 0, static_cast<unsigned>(depth), static_cast<unsigned>(QUEUE_CAPACITY),
+                m_published.load(), m_batches.load(), m_dropped.load(), m_failures.load(),
+                static_cast<double>(m_rate.load()));
+}
+
+void MqttPublisher::task_entry(void *arg) {
+    static_cast<MqttPublisher *>(arg)->run();
+}
+
+void MqttPublisher::run() {
+    int64_t last_sample_us = 0;
+    int64_t last_metrics_us = esp_timer_get_time();
+    int64_t rate_window_start_us = last_metrics_us;
+    uint32_t rate_window_published = 0;
+    uint32_t last_seq = 0;
+    PumpStatus last_pump = m_pump.status();
+
+    for (;;) {
+        vTaskDelay(pdMS_TO_TICKS(LOOP_PERIOD_US / 1000));
+        const int64_t now_us = esp_timer_get_time();
+
+        if (const Reading reading = m_sampler.latest();
+            reading.seq != last_seq && now_us - last_sample_us >= m_config.sample_interval_ms * 1000LL) {
+            last_seq = reading.seq;
+            last_sample_us = now_us;
+            enqueue_sample(reading);
+        }
+
+        if (const PumpStatus pump = m_pump.status(); pump.dry != last_pump.dry || pump.mode != last_pump.mode) {
+            if (pump.dry != last_pump.dry) {
+                event(pump.dry ? "dry_run" : "water_restored");
+            }
+            if (pump.mode != last_pump.mode) {
+                char mode[4];
+                snprintf(mode, sizeof(mode), "%d", static_cast<int>(pump.mode));
+                event("pump_mode", mode);
+            }
+            last_pump = pump;
+        }
+
+        if (now_us - last_metrics_us >= m_config.metrics_interval_ms * 1000LL) {
+            last_metrics_us = now_us;
+            enqueue_metrics(now_us);
+        }
+
+        if (now_us - rate_window_start_us >= RATE_WINDOW_US) {
+            const uint32_t published = m_published.load();
+            m_rate.store(static_cast<float>(published - rate_window_published) * 1e6f /
+                         static_cast<float>(now_us - rate_window_start_us));
+            rate_window_published = published;
+            rate_window_start_us = now_us;
+        }
+
+        pump_queue(now_us);
+    }
+}
+
+void MqttPublisher::on_mqtt_event(void *arg, [[maybe_unused]] esp_event_base_t base, const int32_t event_id,
+                                  void *event_data) {
+    auto *self = static_cast<MqttPublisher *>(arg);
+    const auto *event = static_cast<esp_mqtt_event_handle_t>(event_data);
+    switch (static_cast<esp_mqtt_event_id_t>(event_id)) {
+        case MQTT_EVENT_CONNECTED:
+            ESP_LOGI(TAG, "Connected to broker");
+            self->m_connected.store(true);
+            break;
+        case MQTT_EVENT_DISCONNECTED:
+            ESP_LOGW(TAG, "Disconnected from broker");
+            self->m_connected.store(false);
+            break;
+        case MQTT_EVENT_PUBLISHED:
+            self->m_acked_msg_id.store(event->msg_id);
+            break;
+        default:
+            break;
+    }
+}
+
+void MqttPublisher::enqueue(const MqttTopic topic, const int64_t timestamp_us, const char *payload, size_t len) {
+    if (len >= RECORD_SIZE) {
+        len = RECORD_SIZE - 1;
+    }
+    bool dropped = false;
+    taskENTER_CRITICAL(&m_lock);
+    if (m_count == QUEUE_CAPACITY) {
+        // Full: overwrite the oldest record, newer data is more useful after a long outage
+        m_head = (m_head + 1) % QUEUE_CAPACITY;
+        ++m_head_abs;
+        --m_count;
+        dropped = true;
+    }
+    Record &record = m_queue[(m_head + m_count) % QUEUE_CAPACITY];
+    record.topic = topic;
+    record.len = static_cast<uint8_t>(len);
+    record.timestamp_us = timestamp_us;
+    memcpy(record.payload, payload, len);
+    ++m_count;
+    taskEXIT_CRITICAL(&m_lock);
+    if (dropped) {
+        m_dropped.fetch_add(1);
+    }
+}
+
+void MqttPublisher::pump_queue(const int64_t now_us) {
+    if (!m_connected.load()) {
+        // Keep the batch in flight, it is sent again after reconnection
+        m_inflight_msg_id = -1;
+        return;
+    }
+
+    if (m_inflight_msg_id >= 0) {
+        if (m_acked_msg_id.load() == m_inflight_msg_id) {
+            pop_through(m_inflight_end_abs);
+            m_published.fetch_add(m_inflight_records);
+            m_batches.fetch_add(1);
+            m_inflight_msg_id = -1;
+        } else if (now_us - m_inflight_since_us > ACK_TIMEOUT_US) {
+            ESP_LOGW(TAG, "Batch %d not acknowledged, sending again", m_inflight_msg_id);
+            m_failures.fetch_add(1);
+            m_inflight_msg_id = -1;
+        }
+        return;
+    }
+
+    // Assemble consecutive records of the head topic into a JSON array
+    size_t len = 0;
+    size_t records = 0;
+    bool full = false;
+    m_batch[len++] = '[';
+    taskENTER_CRITICAL(&m_lock);
+    if (m_count == 0) {
+        taskEXIT_CRITICAL(&m_lock);
+        return;
+    }
+    const MqttTopic topic = m_queue[m_head].topic;
+    const int64_t oldest_us = m_queue[m_head].timestamp_us;
+    const uint32_t start_abs = m_head_abs;
+    for (; records < m_count; ++records) {
+        const Record &record = m_queue[(m_head + records) % QUEUE_CAPACITY];
+        if (record.topic != topic || len + record.len + 1 > BATCH_BYTES) {
+            full = true;
+            break;
+        }
+        if (records > 0) {
+            m_batch[len++] = ',';
+        }
+        memcpy(m_batch + len, record.payload, record.len);
+        len += record.len;
+    }
+    taskEXIT_CRITICAL(&m_lock);
+    m_batch[len++] = ']';
+    m_batch[len] = '\0';
+
+    // Send when the batch cannot grow, when its oldest record is due, while replaying a backlog or flushing
+    if (!full && !m_flushing.load() && now_us - oldest_us < m_config.batch_interval_ms * 1000LL) {
+        return;
+    }
+
+    const int qos = m_config.qos[static_cast<size_t>(topic)];
+    const int msg_id = esp_mqtt_client_publish(m_client, m_topics[static_cast<size_t>(topic)], m_batch,
+                                               static_cast<int>(len), qos, 0);
+    if (msg_id < 0) {
+        m_failures.fetch_add(1);
+        return;
+    }
+    if (qos == 0) {
+        pop_through(start_abs + records);
+        m_published.fetch_add(records);
+        m_batches.fetch_add(1);
+    } else {
+        m_inflight_msg_id = msg_id;
+        m_inflight_records = records;
+        m_inflight_end_abs = start_abs + records;
+        m_inflight_since_us = now_us;
+    }
+}
+
+void MqttPublisher::pop_through(const uint32_t end_abs) {
+    taskENTER_CRITICAL(&m_lock);
+    // Records may already have been dropped by a full queue while the batch was in flight
+    while (m_count > 0 && static_cast<int32_t>(end_abs - m_head_abs) > 0) {
+        m_head = (m_head + 1) % QUEUE_CAPACITY;
+        ++m_head_abs;
+        --m_count;
+    }
+    taskEXIT_CRITICAL(&m_lock);
+}
+
+void MqttPublisher::enqueue_sample(const Reading &reading) {
+    char payload[RECORD_SIZE];
+    const int len = snprintf(payload, sizeof(payload), R"({"t":%)" PRId64 R"(,"seq":%)" PRIu32 R"(,"w":%.2f})",
+                             reading.timestamp_us / 1000, reading.seq, static_cast<double>(reading.weight));
+    if (len > 0 && static_cast<size_t>(len) < sizeof(payload)) {
+        enqueue(MqttTopic::SAMPLES, reading.timestamp_us, payload, len);
+    }
+}
+
+void MqttPublisher::enqueue_metrics(const int64_t now_us) {
+    const PumpStatus pump = m_pump.status();
+    taskENTER_CRITICAL(&m_lock);
+    const size_t depth = m_count;
+    taskEXIT_CRITICAL(&m_lock);
+    char payload[RECORD_SIZE];
+    const int len = snprintf(payload, sizeof(payload),
+                             R"({"t":%)" PRId64 R"(,"heap":%u,"duty":%u,"dry":%d,"q":%u,"drop":%)" PRIu32 "}",
+                             now_us / 1000, static_cast<unsigned>(heap_caps_get_free_size(MALLOC_CAP_INTERNAL)),
+                             pump.output_duty, pump.dry ? 1 : 0, static_cast<unsigned>(depth), m_dropped.load());
+    if (len > 0 && static_cast<size_t>(len) < sizeof(payload)) {
+        enqueue(MqttTopic::METRICS, now_us, payload, len);
+    }
+}
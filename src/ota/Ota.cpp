@@ -0,0 +1,647 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#include "ota/Ota.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cstdlib>
+#include <cstring>
+#include <esp_log.h>
+#include <esp_ota_ops.h>
+#include <esp_partition.h>
+#include <esp_system.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <miniz.h>
+
+#include "config/ConfigStore.hpp"
+#include "json/JsonWriter.hpp"
+
+static auto TAG = "Ota";
+
+namespace {
+    enum class DeltaOp : uint8_t {
+        NONE = 0,
+        COPY = 1,   ///< u32 offset, u32 length: bytes of the running image
+        INSERT = 2, ///< u32 length, then the bytes
+        ADD = 3,    ///< u32 offset, u32 length, then one difference per byte, added to the running image
+    };
+
+    enum class Input : uint8_t {
+        OPEN,
+        COMPLETE,
+        ABORTED,    ///< The connection closed before the end of the payload
+    };
+
+    /**
+     * @brief An update in progress, allocated by the update task for its duration
+     */
+    struct Session {
+        OtaPackageHeader header;
+        const esp_partition_t *target;
+        const esp_partition_t *base;
+        esp_ota_handle_t handle;
+        bool handle_open;
+
+        // Ring of received blocks, filled by the httpd task and drained by the update task
+        uint8_t blocks[Ota::BLOCK_COUNT][Ota::BLOCK_SIZE];
+        size_t lengths[Ota::BLOCK_COUNT];
+        uint32_t consumed;                 ///< Payload bytes processed
+
+        tinfl_decompressor inflater;
+        uint8_t window[TINFL_LZ_DICT_SIZE]; ///< Circular output of the inflater, also its dictionary
+        size_t window_pos;
+        bool inflated;                     ///< The zlib stream ended
+
+        DeltaOp op;
+        uint8_t operands[8];
+        size_t operands_len;
+        uint32_t src;                      ///< Offset in the running image of the current op
+        uint32_t remaining;                ///< Bytes left in the current op
+        uint8_t base_chunk[512];
+
+        uint8_t sector[Ota::BLOCK_SIZE];   ///< Image bytes not written yet, flash is written a sector at a time
+        size_t sector_len;
+        uint32_t written;                  ///< Image bytes produced
+    };
+}
+
+static TaskHandle_t worker = nullptr;
+static std::atomic<TaskHandle_t> client{nullptr};
+static esp_timer_handle_t restart_timer = nullptr;
+
+// Handshake between the handler (client) and the update task, one update at a time
+static std::atomic<bool> busy{false};
+static OtaPackageHeader requested{};
+static std::atomic<bool> begin_requested{false};
+static std::atomic<bool> started{false};
+static std::atomic<bool> finished{false};
+static std::atomic<Input> input{Input::OPEN};
+static Session *session = nullptr;        // Published by `started`, freed by the update task after `input` closes
+static std::atomic<uint32_t> filled{0};   // Blocks ever published by the client
+static std::atomic<uint32_t> drained{0};  // Blocks ever processed by the update task
+static std::atomic<bool> failed{false};
+static esp_err_t error = ESP_OK;          // First failure, published by `failed`
+
+// Reporting
+static std::atomic<uint32_t> progress{0};
+static std::atomic<uint32_t> progress_total{0};
+static std::atomic<uint32_t> updates_ok{0};
+static std::atomic<uint32_t> updates_failed{0};
+static std::atomic<uint32_t> last_duration_ms{0};
+static std::atomic<const char *> last_error{nullptr};
+
+// Rollback protection
+static Ota::HealthCheck health = nullptr;
+static esp_timer_handle_t health_timer = nullptr;
+static int64_t health_deadline_us = 0;
+static std::atomic<bool> pending_verify{false};
+
+static uint32_t read_le32(const uint8_t *p) {
+    return p[0] | p[1] << 8 | p[2] << 16 | static_cast<uint32_t>(p[3]) << 24;
+}
+
+static bool ok() {
+    return !failed.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Records the first failure of the update, later steps are skipped
+ */
+static void fail(const esp_err_t err, const char *why) {
+    if (failed.load()) {
+        return;
+    }
+    ESP_LOGE(TAG, "Update failed: %s (%s)", why, esp_err_to_name(err));
+    error = err;
+    last_error.store(why);
+    failed.store(true);
+}
+
+static void notify_client() {
+    if (const TaskHandle_t task = client.load()) {
+        xTaskNotifyGive(task);
+    }
+}
+
+static void write_sector(Session &s) {
+    if (const esp_err_t err = esp_ota_write(s.handle, s.sector, s.sector_len); err != ESP_OK) {
+        fail(err, "Flash write failed");
+    }
+    s.sector_len = 0;
+}
+
+/**
+ * @brief Appends bytes of the new image
+ */
+static void emit(Session &s, const uint8_t *data, size_t len) {
+    if (len > s.header.image_size - s.written) {
+        fail(ESP_ERR_INVALID_SIZE, "Image larger than announced");
+        return;
+    }
+    s.written += len;
+    while (len && ok()) {
+        const size_t n = std::min(len, Ota::BLOCK_SIZE - s.sector_len);
+        memcpy(s.sector + s.sector_len, data, n);
+        s.sector_len += n;
+        data += n;
+        len -= n;
+        if (s.sector_len == Ota::BLOCK_SIZE) {
+            write_sector(s);
+        }
+    }
+    progress.store(s.written, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Reads the next bytes of the running image for a COPY or ADD op, at most sizeof(base_chunk)
+ */
+static size_t read_base(Session &s, const size_t max) {
+    const size_t n = std::min({max, static_cast<size_t>(s.remaining), sizeof(s.base_chunk)});
+    if (const esp_err_t err = esp_partition_read(s.base, s.src, s.base_chunk, n); err != ESP_OK) {
+        fail(err, "Cannot read the running image");
+        return 0;
+    }
+    s.src += n;
+    s.remaining -= n;
+    return n;
+}
+
+/**
+ * @brief Decodes delta ops, whose operands and data may be split across calls
+ */
+static void apply_delta(Session &s, const uint8_t *data, size_t len) {
+    while (len && ok()) {
+        if (s.op == DeltaOp::NONE) {
+            s.op = static_cast<DeltaOp>(*data++);
+            --len;
+            s.operands_len = 0;
+            if (s.op != DeltaOp::COPY && s.op != DeltaOp::INSERT && s.op != DeltaOp::ADD) {
+                fail(ESP_ERR_INVALID_ARG, "Unknown delta op");
+            }
+            continue;
+        }
+        const size_t operands_size = s.op == DeltaOp::INSERT ? 4 : 8;
+        if (s.operands_len < operands_size) {
+            const size_t n = std::min(len, operands_size - s.operands_len);
+            memcpy(s.operands + s.operands_len, data, n);
+            s.operands_len += n;
+            data += n;
+            len -= n;
+            if (s.operands_len < operands_size) {
+                continue;
+            }
+            if (s.op == DeltaOp::INSERT) {
+                s.remaining = read_le32(s.operands);
+            } else {
+                s.src = read_le32(s.operands);
+                s.remaining = read_le32(s.operands + 4);
+                if (static_cast<uint64_t>(s.src) + s.remaining > s.base->size) {
+                    fail(ESP_ERR_INVALID_ARG, "Delta reads past the running image");
+                    continue;
+                }
+            }
+            if (s.op == DeltaOp::COPY) {
+                // Needs no payload, copy it all now
+                while (s.remaining && ok()) {
+                    const size_t n_base = read_base(s, sizeof(s.base_chunk));
+                    emit(s, s.base_chunk, n_base);
+                }
+            }
+            if (!s.remaining) {
+                s.op = DeltaOp::NONE;
+            }
+            continue;
+        }
+        size_t n;
+        if (s.op == DeltaOp::INSERT) {
+            n = std::min<size_t>(len, s.remaining);
+            emit(s, data, n);
+            s.remaining -= n;
+        } else {
+            n = read_base(s, len);
+            for (size_t i = 0; i < n; ++i) {
+                s.base_chunk[i] += data[i];
+            }
+            emit(s, s.base_chunk, n);
+        }
+        data += n;
+        len -= n;
+        if (!s.remaining) {
+            s.op = DeltaOp::NONE;
+        }
+    }
+}
+
+static void emit_decoded(Session &s, const uint8_t *data, const size_t len) {
+    if (s.header.format == OtaFormat::DELTA) {
+        apply_delta(s, data, len);
+    } else {
+        emit(s, data, len);
+    }
+}
+
+static void inflate(Session &s, const uint8_t *data, size_t len, const bool last) {
+    if (s.inflated) {
+        fail(ESP_ERR_INVALID_SIZE, "Data after the end of the stream");
+        return;
+    }
+    const mz_uint32 flags = TINFL_FLAG_PARSE_ZLIB_HEADER | (last ? 0 : TINFL_FLAG_HAS_MORE_INPUT);
+    while (ok()) {
+        size_t in = len;
+        size_t out = sizeof(s.window) - s.window_pos;
+        const tinfl_status status = tinfl_decompress(&s.inflater, data, &in, s.window, s.window + s.window_pos,
+                                                     &out, flags);
+        data += in;
+        len -= in;
+        if (out) {
+            emit_decoded(s, s.window + s.window_pos, out);
+            s.window_pos = (s.window_pos + out) & (sizeof(s.window) - 1);
+        }
+        if (status < TINFL_STATUS_DONE) {
+            fail(ESP_ERR_INVALID_ARG, "Corrupt compressed stream");
+        } else if (status == TINFL_STATUS_DONE) {
+            s.inflated = true;
+            if (len) {
+                fail(ESP_ERR_INVALID_SIZE, "Data after the end of the stream");
+            }
+            return;
+        } else if (status == TINFL_STATUS_NEEDS_MORE_INPUT) {
+            return;
+        }
+        // TINFL_STATUS_HAS_MORE_OUTPUT: the window wrapped, continue from its start
+    }
+}
+
+static void process(Session &s, const uint8_t *data, const size_t len) {
+    s.consumed += len;
+    if (s.header.format == OtaFormat::RAW) {
+        emit(s, data, len);
+    } else {
+        inflate(s, data, len, s.consumed == s.header.payload_size);
+    }
+}
+
+static void begin() {
+    auto *s = static_cast<Session *>(calloc(1, sizeof(Session)));
+    if (!s) {
+        fail(ESP_ERR_NO_MEM, "Not enough memory for the update");
+        return;
+    }
+    session = s;
+    s->header = requested;
+    s->base = esp_ota_get_running_partition();
+    s->target = esp_ota_get_next_update_partition(nullptr);
+    if (!s->base || !s->target) {
+        fail(ESP_ERR_NOT_FOUND, "No OTA slot in the partition table");
+        return;
+    }
+    if (s->header.image_size > s->target->size) {
+        fail(ESP_ERR_INVALID_SIZE, "Image larger than the OTA slot");
+        return;
+    }
+    if (s->header.format == OtaFormat::DELTA) {
+        uint8_t digest[32];
+        if (esp_partition_get_sha256(s->base, digest) != ESP_OK ||
+            memcmp(digest, s->header.base_sha256, sizeof(digest)) != 0) {
+            fail(ESP_ERR_INVALID_VERSION, "Delta does not apply to the running image");
+            return;
+        }
+    }
+    if (s->header.format != OtaFormat::RAW) {
+        tinfl_init(&s->inflater);
+    }
+    // Sectors are erased as they are written, so the transfer starts immediately
+    if (const esp_err_t err = esp_ota_begin(s->target, OTA_WITH_SEQUENTIAL_WRITES, &s->handle); err != ESP_OK) {
+        fail(err, "Cannot start the update");
+        return;
+    }
+    s->handle_open = true;
+    progress_total.store(s->header.image_size);
+    ESP_LOGI(TAG, "Updating %s: %" PRIu32 " bytes from a %" PRIu32 " byte payload (format %d)", s->target->label,
+             s->header.image_size, s->header.payload_size, static_cast<int>(s->header.format));
+}
+
+static void finish(Session &s) {
+    if (s.sector_len && ok()) {
+        write_sector(s);
+    }
+    if (!ok()) {
+        return;
+    }
+    if (s.header.format != OtaFormat::RAW && !s.inflated) {
+        fail(ESP_ERR_INVALID_SIZE, "Truncated compressed stream");
+    } else if (s.op != DeltaOp::NONE) {
+        fail(ESP_ERR_INVALID_SIZE, "Truncated delta op");
+    } else if (s.written != s.header.image_size) {
+        fail(ESP_ERR_INVALID_SIZE, "Image shorter than announced");
+    }
+    if (!ok()) {
+        return;
+    }
+    s.handle_open = false;
+    if (const esp_err_t err = esp_ota_end(s.handle); err != ESP_OK) {
+        fail(err, "Invalid image");
+        return;
+    }
+    uint8_t digest[32];
+    if (esp_partition_get_sha256(s.target, digest) != ESP_OK ||
+        memcmp(digest, s.header.image_sha256, sizeof(digest)) != 0) {
+        fail(ESP_ERR_OTA_VALIDATE_FAILED, "Image digest mismatch");
+        return;
+    }
+    if (const esp_err_t err = esp_ota_set_boot_partition(s.target); err != ESP_OK) {
+        fail(err, "Cannot select the new slot");
+    }
+}
+
+static void release() {
+    if (session) {
+        if (session->handle_open) {
+            esp_ota_abort(session->handle);
+        }
+        free(session);
+        session = nullptr;
+    }
+    (ok() ? updates_ok : updates_failed).fetch_add(1);
+}
+
+[[noreturn]] static void run(void *) {
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (begin_requested.exchange(false)) {
+            begin();
+            started.store(true);
+            notify_client();
+        }
+        if (!started.load() || finished.load()) {
+            continue;
+        }
+        // Read before draining: every block published before the input closed is then processed
+        const Input state = input.load();
+        uint32_t index = drained.load(std::memory_order_relaxed);
+        while (ok() && index != filled.load(std::memory_order_acquire)) {
+            const size_t slot = index % Ota::BLOCK_COUNT;
+            process(*session, session->blocks[slot], session->lengths[slot]);
+            drained.store(++index, std::memory_order_release);
+            notify_client();
+        }
+        if (state == Input::OPEN) {
+            continue;
+        }
+        if (state == Input::ABORTED) {
+            fail(ESP_ERR_INVALID_SIZE, "Connection closed during the transfer");
+        } else if (ok()) {
+            finish(*session);
+        }
+        release();
+        finished.store(true);
+        notify_client();
+    }
+}
+
+/**
+ * @brief Blocks the client until the update task sets the flag
+ */
+static void wait_for(const std::atomic<bool> &flag) {
+    while (!flag.load()) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+    }
+}
+
+/**
+ * @brief Receives exactly len bytes, gives up when the client stalls for MAX_RECV_TIMEOUTS receive timeouts
+ */
+static bool recv_all(httpd_req_t *req, uint8_t *buf, const size_t len) {
+    static constexpr int MAX_RECV_TIMEOUTS = 3;
+    size_t received = 0;
+    int timeouts = 0;
+    while (received < len) {
+        const int ret = httpd_req_recv(req, reinterpret_cast<char *>(buf + received), len - received);
+        if (ret == HTTPD_SOCK_ERR_TIMEOUT && ++timeouts < MAX_RECV_TIMEOUTS) continue;
+        if (ret <= 0) return false;
+        received += ret;
+        timeouts = 0;
+    }
+    return true;
+}
+
+static const char *validate(const OtaPackageHeader &header, const size_t content_len) {
+    if (header.magic != Ota::PACKAGE_MAGIC) return "Not an update package";
+    if (header.version != Ota::PACKAGE_VERSION) return "Unsupported package version";
+    if (header.format > OtaFormat::DELTA) return "Unknown package format";
+    if (content_len != sizeof(header) + header.payload_size) return "Payload size does not match Content-Length";
+    if (header.format == OtaFormat::RAW && header.payload_size != header.image_size) return "Raw payload size mismatch";
+    if (!header.image_size) return "Empty image";
+    return nullptr;
+}
+
+static esp_err_t send_error(httpd_req_t *req, const char *status, const char *message) {
+    ResponseBuffer resp(req);
+    httpd_resp_set_status(req, status);
+    httpd_resp_set_type(req, "application/json");
+    JsonWriter(resp).begin_object().field("error", message).end_object();
+    return resp.send();
+}
+
+static esp_err_t receive(httpd_req_t *req) {
+    OtaPackageHeader header{};
+    if (req->content_len < sizeof(header)) {
+        return send_error(req, HTTPD_400, "Not an update package");
+    }
+    if (!recv_all(req, reinterpret_cast<uint8_t *>(&header), sizeof(header))) {
+        return ESP_FAIL;
+    }
+    if (const char *invalid = validate(header, req->content_len)) {
+        return send_error(req, HTTPD_400, invalid);
+    }
+
+    const int64_t start_us = esp_timer_get_time();
+    requested = header;
+    filled.store(0);
+    drained.store(0);
+    input.store(Input::OPEN);
+    failed.store(false);
+    finished.store(false);
+    started.store(false);
+    progress.store(0);
+    last_error.store(nullptr);
+    client.store(xTaskGetCurrentTaskHandle());
+    begin_requested.store(true);
+    xTaskNotifyGive(worker);
+    wait_for(started);
+
+    // Receive into free blocks while the update task works on the filled ones
+    uint32_t remaining = header.payload_size;
+    bool connection_lost = false;
+    while (remaining && ok()) {
+        const uint32_t index = filled.load(std::memory_order_relaxed);
+        if (index - drained.load(std::memory_order_acquire) == Ota::BLOCK_COUNT) {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+            continue;
+        }
+        const size_t slot = index % Ota::BLOCK_COUNT;
+        const size_t len = std::min<size_t>(remaining, Ota::BLOCK_SIZE);
+        if (!recv_all(req, session->blocks[slot], len)) {
+            connection_lost = true;
+            break;
+        }
+        session->lengths[slot] = len;
+        filled.store(index + 1, std::memory_order_release);
+        xTaskNotifyGive(worker);
+        remaining -= len;
+    }
+    input.store(remaining ? Input::ABORTED : Input::COMPLETE);
+    xTaskNotifyGive(worker);
+    wait_for(finished);
+    client.store(nullptr);
+
+    if (connection_lost) {
+        return ESP_FAIL;
+    }
+    if (!ok()) {
+        const bool rejected = error == ESP_ERR_INVALID_ARG || error == ESP_ERR_INVALID_SIZE ||
+                              error == ESP_ERR_INVALID_VERSION || error == ESP_ERR_OTA_VALIDATE_FAILED;
+        return send_error(req, rejected ? HTTPD_400 : HTTPD_500, last_error.load());
+    }
+
+    const auto duration_ms = static_cast<uint32_t>((esp_timer_get_time() - start_us) / 1000);
+    last_duration_ms.store(duration_ms);
+    const double seconds = duration_ms / 1000.0;
+    ESP_LOGI(TAG, "Update written in %.2f s, restarting", seconds);
+    ResponseBuffer resp(req);
+    httpd_resp_set_type(req, "application/json");
+    JsonWriter(resp).begin_object()
+            .field("status", "ok")
+            .field("image_size", header.image_size)
+            .field("payload_size", header.payload_size)
+            .field("seconds", json_fixed(seconds, 2))
+            .field("kib_per_s", json_fixed(seconds > 0 ? header.payload_size / 1024.0 / seconds : 0.0, 1))
+            .field("restart_ms", Ota::RESTART_DELAY_MS)
+            .end_object();
+    const esp_err_t ret = resp.send();
+    esp_timer_start_once(restart_timer, Ota::RESTART_DELAY_MS * 1000);
+    return ret;
+}
+
+esp_err_t Ota::handler(httpd_req_t *req) {
+    if (busy.exchange(true)) {
+        return send_error(req, "409 Conflict", "Update already in progress");
+    }
+    const esp_err_t ret = receive(req);
+    busy.store(false);
+    return ret;
+}
+
+static const char *state_name(const esp_ota_img_states_t state) {
+    switch (state) {
+        case ESP_OTA_IMG_NEW: return "new";
+        case ESP_OTA_IMG_PENDING_VERIFY: return "pending_verify";
+        case ESP_OTA_IMG_VALID: return "valid";
+        case ESP_OTA_IMG_INVALID: return "invalid";
+        case ESP_OTA_IMG_ABORTED: return "aborted";
+        default: return "undefined";
+    }
+}
+
+esp_err_t Ota::status_handler(httpd_req_t *req) {
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    const esp_partition_t *next = esp_ota_get_next_update_partition(nullptr);
+    esp_ota_img_states_t state = ESP_OTA_IMG_UNDEFINED;
+    if (running) {
+        esp_ota_get_state_partition(running, &state);
+    }
+
+    ResponseBuffer resp(req);
+    httpd_resp_set_type(req, "application/json");
+    JsonWriter json(resp);
+    json.begin_object()
+            .field("running", running ? running->label : "")
+            .field("state", state_name(state))
+            .field("next", next ? next->label : "")
+            .field("updating", busy.load())
+            .field("written", progress.load())
+            .field("image_size", progress_total.load())
+            .field("updates", updates_ok.load())
+            .field("failures", updates_failed.load());
+    if (const char *why = last_error.load()) {
+        json.field("last_error", why);
+    } else {
+        json.key("last_error").null();
+    }
+    json.end_object();
+    return resp.send();
+}
+
+bool Ota::idle() {
+    return !busy.load() && !pending_verify.load();
+}
+
+void Ota::render_metrics(ResponseBuffer &out) {
+    out.appendf("# HELP ota_updates_total Update attempts by result\n# TYPE ota_updates_total counter\n"
+                "ota_updates_total{result=\"ok\"} %" PRIu32 "\nota_updates_total{result=\"failed\"} %" PRIu32 "\n"
+                "# HELP ota_last_update_seconds Duration of the last successful update\n"
+                "# TYPE ota_last_update_seconds gauge\nota_last_update_seconds %.3f\n"
+                "# HELP ota_pending_verify Running image waits for its health check\n"
+                "# TYPE ota_pending_verify gauge\nota_pending_verify %d\n",
+                updates_ok.load(), updates_failed.load(), last_duration_ms.load() / 1000.0,
+                pending_verify.load() ? 1 : 0);
+}
+
+static void check_health(void *) {
+    if (health()) {
+        esp_timer_stop(health_timer);
+        esp_ota_mark_app_valid_cancel_rollback();
+        pending_verify.store(false);
+        ESP_LOGI(TAG, "Health check passed, image confirmed");
+    } else if (esp_timer_get_time() >= health_deadline_us) {
+        ESP_LOGE(TAG, "Health check failed for %" PRIu32 " ms, rolling back", Ota::HEALTH_WINDOW_MS);
+        esp_ota_mark_app_invalid_rollback_and_reboot();
+    }
+}
+
+void Ota::start(const HealthCheck health_check) {
+    if (worker) {
+        return;
+    }
+    // Below the httpd task so the receive side keeps the ring full
+    xTaskCreatePinnedToCore(run, "ota", 4096, nullptr, 4, &worker, 0);
+
+    const esp_timer_create_args_t restart_args = {
+        .callback = [](void *) {
+            ConfigStore::flush();
+            esp_restart();
+        },
+        .arg = nullptr,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "ota_restart",
+        .skip_unhandled_events = false,
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&restart_args, &restart_timer));
+
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    esp_ota_img_states_t state;
+    if (!running || esp_ota_get_state_partition(running, &state) != ESP_OK ||
+        state != ESP_OTA_IMG_PENDING_VERIFY) {
+        return;
+    }
+    ESP_LOGW(TAG, "Running %s pending verification, rolling back unless healthy within %" PRIu32 " ms",
+             running->label, HEALTH_WINDOW_MS);
+    health = health_check;
+    health_deadline_us = esp_timer_get_time() + HEALTH_WINDOW_MS * 1000LL;
+    pending_verify.store(true);
+    const esp_timer_create_args_t health_args = {
+        .callback = check_health,
+        .arg = nullptr,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "ota_health",
+        .skip_unhandled_events = true,
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&health_args, &health_timer));
+    ESP_ERROR_CHECK(esp_timer_start_periodic(health_timer, 1000 * 1000));
+}
@@ -0,0 +1,195 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#include "power/LowPower.hpp"
+
+#if SMART_FOUNTAIN_LOW_POWER
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
+#include <driver/rtc_io.h>
+#include <esp_attr.h>
+#include <esp_log.h>
+#include <esp_sleep.h>
+#include <esp_timer.h>
+#include <freertos/task.h>
+#include <ulp_riscv.h>
+
+#include "config/ConfigStore.hpp"
+#include "ulp_main.h"
+
+static auto TAG = "LowPower";
+
+extern const uint8_t ulp_main_bin_start[] asm("_binary_ulp_main_bin_start");
+extern const uint8_t ulp_main_bin_end[] asm("_binary_ulp_main_bin_end");
+
+namespace {
+    /**
+     * @brief What the main CPU needs after a ULP wakeup, in RTC memory
+     */
+    struct SleepContext {
+        bool valid;
+        int32_t tare;
+        float scale;
+        gpio_num_t clk;
+        gpio_num_t data;
+    };
+}
+
+RTC_DATA_ATTR static SleepContext context;
+RTC_DATA_ATTR static uint32_t sleeps;
+RTC_DATA_ATTR static uint32_t wakes[4];
+RTC_DATA_ATTR static uint32_t hx711_timeouts;
+RTC_DATA_ATTR static uint32_t lost_records;
+
+static ulp_wake_reason_t woken_by = ULP_WAKE_NONE;
+static int64_t boot_us = 0;
+static uint32_t wake_ticks = 0;
+static uint32_t history_count = 0;
+static ulp_sample_t history[ULP_HISTORY_CAPACITY];
+
+static LowPower::SleepCheck sleep_check = nullptr;
+static LowPower::SleepHook sleep_hook = nullptr;
+static LowPower::Config sleep_config{};
+static HX711 *sleep_scale = nullptr;
+
+// Exported by the ULP program, see ulp/main.c
+static ulp_sampling_config_t &ulp_shared_config() {
+    return *reinterpret_cast<ulp_sampling_config_t *>(&ulp_config);
+}
+
+static ulp_sampling_state_t &ulp_shared_state() {
+    return *reinterpret_cast<ulp_sampling_state_t *>(&ulp_state);
+}
+
+void LowPower::boot() {
+    boot_us = esp_timer_get_time();
+    if (esp_sleep_get_wakeup_cause() != ESP_SLEEP_WAKEUP_ULP || !context.valid) {
+        context.valid = false;
+        return;
+    }
+    // The ULP does nothing more once it woke the CPU, stopping its timer hands the pins back
+    ulp_riscv_timer_stop();
+    const ulp_sampling_state_t &state = ulp_shared_state();
+    woken_by = state.wake_reason <= ULP_WAKE_REPORT ? static_cast<ulp_wake_reason_t>(state.wake_reason)
+                                                  : ULP_WAKE_NONE;
+    wake_ticks = state.ticks;
+    history_count = std::min<uint32_t>(state.count, ULP_HISTORY_CAPACITY);
+    memcpy(history, state.history, history_count * sizeof(ulp_sample_t));
+    ++wakes[woken_by];
+    hx711_timeouts += state.timeouts;
+    rtc_gpio_deinit(context.clk);
+    rtc_gpio_deinit(context.data);
+    ESP_LOGI(TAG, "Woken by the ULP (%s) after %" PRIu32 " readings, %" PRIu32 " recorded", reason_name(woken_by),
+             state.samples, history_count);
+}
+
+ulp_wake_reason_t LowPower::wake_reason() {
+    return woken_by;
+}
+
+bool LowPower::restore_tare(HX711 &scale) {
+    if (!context.valid) {
+        return false;
+    }
+    scale.set_tare(context.tare);
+    scale.set_scale(context.scale);
+    ESP_LOGI(TAG, "Tare restored: %" PRId32, context.tare);
+    return true;
+}
+
+void LowPower::replay(const SampleSink sink) {
+    for (uint32_t i = 0; i < history_count; ++i) {
+        const ulp_sample_t &sample = history[i];
+        const int64_t age_us = static_cast<int64_t>(wake_ticks - sample.tick) * ULP_PERIOD_MS * 1000;
+        const float weight = static_cast<float>(sample.raw - context.tare) / context.scale;
+        sink({
+            .weight = weight,
+            .raw_weight = weight,
+            .timestamp_us = boot_us - age_us,
+            .seq = 0,
+            .version = 0,
+        });
+    }
+}
+
+void LowPower::start(HX711 &scale, const SleepCheck can_sleep, const SleepHook before_sleep, const Config &config) {
+    sleep_scale = &scale;
+    sleep_check = can_sleep;
+    sleep_hook = before_sleep;
+    sleep_config = config;
+    xTaskCreatePinnedToCore(task_entry, "low_power", 3072, nullptr, 2, nullptr, 0);
+}
+
+void LowPower::task_entry(void *) {
+    uint32_t idle_ms = 0;
+    for (;;) {
+        vTaskDelay(pdMS_TO_TICKS(1000));
+        idle_ms = sleep_check() ? idle_ms + 1000 : 0;
+        if (idle_ms >= sleep_config.awake_ms) {
+            sleep();
+        }
+    }
+}
+
+void LowPower::sleep() {
+    const Config &config = sleep_config;
+    if (sleep_hook) {
+        if (const uint32_t lost = sleep_hook(); lost > 0) {
+            lost_records += lost;
+            ESP_LOGW(TAG, "Sleeping with %" PRIu32 " records undelivered", lost);
+        }
+    }
+    context = {
+        .valid = true,
+        .tare = sleep_scale->get_tare(),
+        .scale = sleep_scale->get_scale(),
+        .clk = config.clk,
+        .data = config.data,
+    };
+    ++sleeps;
+    ConfigStore::flush();
+
+    ESP_ERROR_CHECK(ulp_riscv_load_binary(ulp_main_bin_start, ulp_main_bin_end - ulp_main_bin_start));
+    ulp_shared_config() = ulp_config(config, context.scale);
+    ulp_sampling_reset(&ulp_shared_state());
+
+    // SCK high keeps the HX711 powered down until the ULP takes the first reading
+    rtc_gpio_init(config.clk);
+    rtc_gpio_set_direction(config.clk, RTC_GPIO_MODE_OUTPUT_ONLY);
+    rtc_gpio_set_level(config.clk, 1);
+    rtc_gpio_init(config.data);
+    rtc_gpio_set_direction(config.data, RTC_GPIO_MODE_INPUT_ONLY);
+    rtc_gpio_pullup_dis(config.data);
+    rtc_gpio_pulldown_en(config.data);
+
+    // RTC IO must stay powered for the ULP to drive the pins
+    esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_PERIPH, ESP_PD_OPTION_ON);
+    ESP_ERROR_CHECK(ulp_set_wakeup_period(0, ULP_PERIOD_MS * 1000));
+    ESP_ERROR_CHECK(esp_sleep_enable_ulp_wakeup());
+    ESP_ERROR_CHECK(ulp_riscv_run());
+    ESP_LOGI(TAG, "Entering deep sleep, wake on %.1f units", static_cast<double>(config.wake_delta));
+    esp_deep_sleep_start();
+}
+
+void LowPower::render_metrics(ResponseBuffer &out) {
+    out.appendf("# HELP lowpower_sleeps_total Deep sleeps with the ULP sampling the scale\n"
+                "# TYPE lowpower_sleeps_total counter\nlowpower_sleeps_total %" PRIu32 "\n"
+                "# HELP lowpower_wakes_total ULP wakeups by reason\n# TYPE lowpower_wakes_total counter\n",
+                sleeps);
+    for (const ulp_wake_reason_t r : {ULP_WAKE_CHANGE, ULP_WAKE_FULL, ULP_WAKE_REPORT}) {
+        out.appendf("lowpower_wakes_total{reason=\"%s\"} %" PRIu32 "\n", reason_name(r), wakes[r]);
+    }
+    out.appendf("# HELP lowpower_history_samples Readings recorded by the ULP before the last wakeup\n"
+                "# TYPE lowpower_history_samples gauge\nlowpower_history_samples %" PRIu32 "\n"
+                "# HELP lowpower_hx711_timeouts_total ULP conversions that never became ready\n"
+                "# TYPE lowpower_hx711_timeouts_total counter\nlowpower_hx711_timeouts_total %" PRIu32 "\n"
+                "# HELP lowpower_lost_records_total Telemetry records still undelivered when entering deep sleep\n"
+                "# TYPE lowpower_lost_records_total counter\nlowpower_lost_records_total %" PRIu32 "\n",
+                history_count, hx711_timeouts, lost_records);
+}
+
+#endif
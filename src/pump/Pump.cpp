@@ -0,0 +1,236 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#include "pump/Pump.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#include "led/LedService.hpp"
+#include "mem/HeapGuard.hpp"
+
+static auto TAG = "Pump";
+
+// 10 bits at 25 kHz keeps the PWM above the audible range
+static constexpr ledc_mode_t PUMP_LEDC_MODE = LEDC_LOW_SPEED_MODE;
+static constexpr ledc_timer_t PUMP_LEDC_TIMER = LEDC_TIMER_0;
+static constexpr ledc_channel_t PUMP_LEDC_CHANNEL = LEDC_CHANNEL_0;
+static constexpr ledc_timer_bit_t PUMP_LEDC_RESOLUTION = LEDC_TIMER_10_BIT;
+static constexpr uint32_t PUMP_LEDC_FREQ_HZ = 25000;
+static constexpr uint32_t PUMP_MAX_DUTY = (1u << PUMP_LEDC_RESOLUTION) - 1;
+
+Pump::Pump(const gpio_num_t gpio, Sampler &sampler) : m_gpio(gpio), m_sampler(sampler) {}
+
+void Pump::start(const UBaseType_t priority) {
+    if (m_task) {
+        return;
+    }
+
+    ledc_timer_config_t timer_config = {};
+    timer_config.speed_mode = PUMP_LEDC_MODE;
+    timer_config.duty_resolution = PUMP_LEDC_RESOLUTION;
+    timer_config.timer_num = PUMP_LEDC_TIMER;
+    timer_config.freq_hz = PUMP_LEDC_FREQ_HZ;
+    timer_config.clk_cfg = LEDC_AUTO_CLK;
+    ESP_ERROR_CHECK(ledc_timer_config(&timer_config));
+
+    ledc_channel_config_t channel_config = {};
+    channel_config.gpio_num = m_gpio;
+    channel_config.speed_mode = PUMP_LEDC_MODE;
+    channel_config.channel = PUMP_LEDC_CHANNEL;
+    channel_config.timer_sel = PUMP_LEDC_TIMER;
+    channel_config.duty = 0;
+    channel_config.hpoint = 0;
+    ESP_ERROR_CHECK(ledc_channel_config(&channel_config));
+
+    xTaskCreatePinnedToCore(task_entry, "pump_ctl", 3072, this, priority, &m_task, 1);
+    m_sampler.add_listener(m_task);
+    ESP_LOGI(TAG, "Pump control started on GPIO %d", static_cast<int>(m_gpio));
+}
+
+void Pump::set_mode(const PumpMode mode) {
+    if (mode == PumpMode::SCHEDULE && m_mode.load() != PumpMode::SCHEDULE) {
+        m_schedule_start_us.store(esp_timer_get_time());
+    }
+    m_mode.store(mode);
+}
+
+void Pump::set_duty(const uint8_t percent) {
+    m_target_duty.store(std::min<uint8_t>(percent, 100));
+}
+
+void Pump::set_ramp(const uint32_t ramp_ms) {
+    m_ramp_ms.store(ramp_ms);
+}
+
+void Pump::set_schedule(const uint32_t on_s, const uint32_t off_s) {
+    m_schedule_on_s.store(on_s);
+    m_schedule_off_s.store(off_s);
+    m_schedule_start_us.store(esp_timer_get_time());
+}
+
+void Pump::set_dry_threshold(const float threshold, const float hysteresis) {
+    m_dry_threshold.store(threshold);
+    m_dry_hysteresis.store(hysteresis < 0.0f ? 0.0f : hysteresis);
+}
+
+PumpStatus Pump::status() const {
+    return {
+        .mode = m_mode.load(),
+        .target_duty = m_target_duty.load(),
+        .output_duty = static_cast<uint8_t>((m_output_duty.load() * 100 + PUMP_MAX_DUTY / 2) / PUMP_MAX_DUTY),
+        .dry = m_dry.load(),
+        .stale = m_stale.load(),
+        .dry_threshold = m_dry_threshold.load(),
+        .dry_hysteresis = m_dry_hysteresis.load(),
+        .ramp_ms = m_ramp_ms.load(),
+        .schedule_on_s = m_schedule_on_s.load(),
+        .schedule_off_s = m_schedule_off_s.load(),
+        .dry_trips = m_dry_trips.load(),
+        .deadline_misses = m_deadline_misses.load(),
+    };
+}
+
+void Pump::render_metrics(ResponseBuffer &out) const {
+    const PumpStatus s = status();
+    out.appendf("# HELP pump_mode Pump mode (0 off, 1 on, 2 schedule)\n# TYPE pump_mode gauge\npump_mode %d\n"
+                "# HELP pump_duty_ratio Duty cycle applied to the pump output\n# TYPE pump_duty_ratio gauge\n"
+                "pump_duty_ratio %.3f\n"
+                "# HELP pump_dry Dry-run protection tripped\n# TYPE pump_dry gauge\npump_dry %d\n"
+                "# HELP pump_reading_stale Pump cut because dry-run protection has no recent reading\n"
+                "# TYPE pump_reading_stale gauge\npump_reading_stale %d\n"
+                "# HELP pump_dry_trips_total Dry-run protection trips\n# TYPE pump_dry_trips_total counter\n"
+                "pump_dry_trips_total %" PRIu32 "\n"
+                "# HELP pump_dry_deadline_misses_total Readings evaluated later than the dry-run deadline\n"
+                "# TYPE pump_dry_deadline_misses_total counter\npump_dry_deadline_misses_total %" PRIu32 "\n",
+                static_cast<int>(s.mode), static_cast<double>(m_output_duty.load()) / PUMP_MAX_DUTY, s.dry ? 1 : 0,
+                s.stale ? 1 : 0, s.dry_trips, s.deadline_misses);
+    m_jitter.render(out, "pump_control_jitter_seconds", "Lateness of the pump control loop period");
+    m_reaction.render(out, "pump_dry_reaction_seconds", "Time from a weight conversion to its dry-run evaluation");
+}
+
+void Pump::task_entry(void *arg) {
+    static_cast<Pump *>(arg)->run();
+}
+
+void Pump::run() {
+    HeapGuard::watch(xTaskGetCurrentTaskHandle());
+    int64_t next_tick_us = esp_timer_get_time() + CONTROL_PERIOD_US;
+    for (;;) {
+        // Sleep until the next control period, or until the Sampler publishes a reading
+        const int64_t wait_us = next_tick_us - esp_timer_get_time();
+        const TickType_t wait_ticks = wait_us > 0 ? pdMS_TO_TICKS((wait_us + 999) / 1000) : 0;
+        ulTaskNotifyTake(pdTRUE, wait_ticks);
+
+        if (const Reading reading = m_sampler.latest(); reading.seq != m_last_seq) {
+            m_last_seq = reading.seq;
+            on_reading(reading);
+        }
+
+        if (const int64_t now_us = esp_timer_get_time(); now_us >= next_tick_us) {
+            m_jitter.observe(static_cast<uint32_t>(now_us - next_tick_us));
+            on_tick(now_us);
+            next_tick_us += CONTROL_PERIOD_US;
+            if (next_tick_us <= now_us) {
+                // Fell more than a period behind, resynchronize instead of bursting
+                next_tick_us = now_us + CONTROL_PERIOD_US;
+            }
+        }
+    }
+}
+
+void Pump::on_reading(const Reading &reading) {
+    const float threshold = m_dry_threshold.load();
+    bool tripped = false;
+    if (threshold <= 0.0f) {
+        // Protection disabled
+        if (m_dry.exchange(false)) {
+            LedService::clear(LedService::Source::PUMP);
+        }
+    } else if (!m_dry.load() && reading.weight < threshold) {
+        m_dry.store(true);
+        apply_duty(0);
+        tripped = true;
+    } else if (m_dry.load() && reading.weight >= threshold + m_dry_hysteresis.load()) {
+        m_dry.store(false);
+        LedService::clear(LedService::Source::PUMP);
+        ESP_LOGI(TAG, "Water level restored (%.1f), pump re-armed", static_cast<double>(reading.weight));
+    }
+
+    const int64_t reaction_us = esp_timer_get_time() - reading.timestamp_us;
+    m_reaction.observe(static_cast<uint32_t>(reaction_us));
+    if (reaction_us > DRY_DEADLINE_US) {
+        m_deadline_misses.fetch_add(1);
+    }
+    if (tripped) {
+        m_dry_trips.fetch_add(1);
+        LedService::post(LedService::Source::PUMP, LedPattern::CODE, COLOR_RED, 3);
+        ESP_LOGW(TAG, "Dry run: weight %.1f below %.1f, pump cut in %" PRId64 " us",
+                 static_cast<double>(reading.weight), static_cast<double>(threshold), reaction_us);
+    }
+}
+
+void Pump::on_tick(const int64_t now_us) {
+    uint32_t desired_percent = 0;
+    switch (m_mode.load()) {
+        case PumpMode::OFF:
+            break;
+        case PumpMode::ON:
+            desired_percent = m_target_duty.load();
+            break;
+        case PumpMode::SCHEDULE: {
+            const int64_t on_us = static_cast<int64_t>(m_schedule_on_s.load()) * 1000000;
+            const int64_t off_us = static_cast<int64_t>(m_schedule_off_s.load()) * 1000000;
+            const int64_t cycle_us = on_us + off_us;
+            const int64_t phase_us = cycle_us > 0 ? (now_us - m_schedule_start_us.load()) % cycle_us : 0;
+            if (off_us == 0 || phase_us < on_us) {
+                desired_percent = m_target_duty.load();
+            }
+            break;
+        }
+    }
+    if (m_dry.load()) {
+        desired_percent = 0;
+    }
+
+    // Protection only reacts to readings, so without recent ones it cannot be trusted
+    const bool stale = m_dry_threshold.load() > 0.0f &&
+                       now_us - m_sampler.latest().timestamp_us > STALE_READING_US;
+    if (stale != m_stale.load()) {
+        m_stale.store(stale);
+        if (stale) {
+            m_deadline_misses.fetch_add(1);
+            ESP_LOGW(TAG, "No reading for %" PRId64 " ms, pump cut", STALE_READING_US / 1000);
+        } else {
+            ESP_LOGI(TAG, "Readings resumed, pump re-armed");
+        }
+    }
+    if (stale) {
+        desired_percent = 0;
+    }
+
+    const uint32_t desired = desired_percent * PUMP_MAX_DUTY / 100;
+    const uint32_t current = m_output_duty.load();
+    uint32_t next = desired;
+    if (desired > current) {
+        // Soft-start: limit the rise per control period, stopping is always immediate
+        if (const uint32_t ramp_ms = m_ramp_ms.load(); ramp_ms > 0) {
+            const uint32_t step = std::max<uint32_t>(
+                1, static_cast<uint32_t>(PUMP_MAX_DUTY * CONTROL_PERIOD_US / (static_cast<int64_t>(ramp_ms) * 1000)));
+            next = std::min(desired, current + step);
+        }
+    }
+    if (next != current) {
+        apply_duty(next);
+    }
+}
+
+void Pump::apply_duty(const uint32_t duty) {
+    ledc_set_duty(PUMP_LEDC_MODE, PUMP_LEDC_CHANNEL, duty);
+    ledc_update_duty(PUMP_LEDC_MODE, PUMP_LEDC_CHANNEL);
+    m_output_duty.store(duty);
+}
@@ -0,0 +1,196 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#include "pump/PumpApi.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+
+#include "config/ConfigStore.hpp"
+#include "json/JsonWriter.hpp"
+
+static auto TAG = "PumpApi";
+
+// Locates the value of "key" in a flat JSON object, returns nullptr if absent
+static const char *json_value(const char *body, const char *key) {
+    char quoted[32];
+    snprintf(quoted, sizeof(quoted), "\"%s\"", key);
+    const char *p = strstr(body, quoted);
+    if (!p) return nullptr;
+    p += strlen(quoted);
+    while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') p++;
+    if (*p != ':') return nullptr;
+    p++;
+    while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') p++;
+    return p;
+}
+
+/**
+ * @brief Reads an optional number within [min, max], `out` stays empty if the key is absent
+ * @return false if the key is present but its value is not such a number
+ */
+static bool json_number(const char *body, const char *key, const float min, const float max,
+                        std::optional<float> &out) {
+    const char *p = json_value(body, key);
+    if (!p) return true;
+    char *end = nullptr;
+    const float value = strtof(p, &end);
+    // strtof also accepts nan and inf, which no setting can take
+    if (end == p || !std::isfinite(value) || value < min || value > max) return false;
+    out = value;
+    return true;
+}
+
+/**
+ * @brief Reads the optional "mode" string
+ * @return false if the key is present but names no mode
+ */
+static bool json_mode(const char *body, std::optional<PumpMode> &out) {
+    const char *p = json_value(body, "mode");
+    if (!p) return true;
+    if (strncmp(p, "\"off\"", 5) == 0) {
+        out = PumpMode::OFF;
+    } else if (strncmp(p, "\"on\"", 4) == 0) {
+        out = PumpMode::ON;
+    } else if (strncmp(p, "\"schedule\"", 10) == 0) {
+        out = PumpMode::SCHEDULE;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Converting a float outside the range of the target type is undefined, clamp first
+static uint32_t clamp_u32(const float value) {
+    if (value <= 0.0f) return 0;
+    if (static_cast<double>(value) >= 4294967295.0) return UINT32_MAX;
+    return static_cast<uint32_t>(value);
+}
+
+static const char *mode_name(const PumpMode mode) {
+    switch (mode) {
+        case PumpMode::ON: return "on";
+        case PumpMode::SCHEDULE: return "schedule";
+        default: return "off";
+    }
+}
+
+template<>
+struct JsonSchema<PumpStatus> {
+    static constexpr auto fields = std::make_tuple(
+        json_field("mode", &PumpStatus::mode, mode_name),
+        json_field("duty", &PumpStatus::target_duty),
+        json_field("output_duty", &PumpStatus::output_duty),
+        json_field("dry", &PumpStatus::dry),
+        json_field("stale", &PumpStatus::stale),
+        json_field("dry_threshold", &PumpStatus::dry_threshold, 2),
+        json_field("dry_hysteresis", &PumpStatus::dry_hysteresis, 2),
+        json_field("ramp_ms", &PumpStatus::ramp_ms),
+        json_field("schedule_on_s", &PumpStatus::schedule_on_s),
+        json_field("schedule_off_s", &PumpStatus::schedule_off_s),
+        json_field("dry_trips", &PumpStatus::dry_trips),
+        json_field("deadline_misses", &PumpStatus::deadline_misses));
+};
+
+static esp_err_t send_status(httpd_req_t *req, const Pump &pump) {
+    ResponseBuffer resp(req);
+    httpd_resp_set_type(req, "application/json");
+    JsonWriter(resp).object(pump.status());
+    return resp.send();
+}
+
+static esp_err_t handle_post(httpd_req_t *req, Pump &pump) {
+    char body[256];
+    if (req->content_len >= sizeof(body)) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Body too large");
+        return ESP_OK;
+    }
+    // A client that stalls after its headers would otherwise hold the only httpd task
+    static constexpr int MAX_RECV_TIMEOUTS = 3;
+    size_t received = 0;
+    int timeouts = 0;
+    while (received < req->content_len) {
+        const int ret = httpd_req_recv(req, body + received, req->content_len - received);
+        if (ret == HTTPD_SOCK_ERR_TIMEOUT && ++timeouts < MAX_RECV_TIMEOUTS) continue;
+        if (ret <= 0) return ESP_FAIL;
+        received += ret;
+        timeouts = 0;
+    }
+    body[received] = '\0';
+
+    // Every field is checked before any is applied, so a rejected request changes nothing
+    static constexpr float U32_MAX = 4294967295.0f;
+    std::optional<PumpMode> mode;
+    std::optional<float> duty, ramp_ms, on_s, off_s, threshold, hysteresis;
+    const char *invalid = nullptr;
+    if (!json_mode(body, mode)) invalid = "mode";
+    else if (!json_number(body, "duty", 0.0f, 100.0f, duty)) invalid = "duty";
+    else if (!json_number(body, "ramp_ms", 0.0f, U32_MAX, ramp_ms)) invalid = "ramp_ms";
+    else if (!json_number(body, "schedule_on_s", 0.0f, U32_MAX, on_s)) invalid = "schedule_on_s";
+    else if (!json_number(body, "schedule_off_s", 0.0f, U32_MAX, off_s)) invalid = "schedule_off_s";
+    else if (!json_number(body, "dry_threshold", 0.0f, INFINITY, threshold)) invalid = "dry_threshold";
+    else if (!json_number(body, "dry_hysteresis", 0.0f, INFINITY, hysteresis)) invalid = "dry_hysteresis";
+    if (invalid) {
+        char message[48];
+        snprintf(message, sizeof(message), "Invalid %s", invalid);
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, message);
+        return ESP_OK;
+    }
+
+    const PumpStatus current = pump.status();
+    if (duty) {
+        pump.set_duty(static_cast<uint8_t>(*duty));
+    }
+    if (ramp_ms) {
+        pump.set_ramp(clamp_u32(*ramp_ms));
+    }
+    if (on_s || off_s) {
+        pump.set_schedule(on_s ? clamp_u32(*on_s) : current.schedule_on_s,
+                          off_s ? clamp_u32(*off_s) : current.schedule_off_s);
+    }
+    if (threshold || hysteresis) {
+        pump.set_dry_threshold(threshold.value_or(current.dry_threshold),
+                               hysteresis.value_or(current.dry_hysteresis));
+    }
+    if (mode) {
+        pump.set_mode(*mode);
+    }
+
+    // Starting from the stored section keeps its padding bytes, so an unchanged setting is not rewritten
+    const PumpStatus updated = pump.status();
+    PumpConfig config = ConfigStore::get(&DeviceConfig::pump);
+    config.mode = updated.mode;
+    config.duty = updated.target_duty;
+    config.ramp_ms = updated.ramp_ms;
+    config.schedule_on_s = updated.schedule_on_s;
+    config.schedule_off_s = updated.schedule_off_s;
+    config.dry_threshold = updated.dry_threshold;
+    config.dry_hysteresis = updated.dry_hysteresis;
+    ConfigStore::set(&DeviceConfig::pump, config);
+
+    ESP_LOGI(TAG, "Pump updated: %s", body);
+    return send_status(req, pump);
+}
+
+void restore_pump_config(Pump &pump) {
+    const PumpConfig config = ConfigStore::get(&DeviceConfig::pump);
+    pump.set_duty(config.duty);
+    pump.set_ramp(config.ramp_ms);
+    pump.set_schedule(config.schedule_on_s, config.schedule_off_s);
+    pump.set_dry_threshold(config.dry_threshold, config.dry_hysteresis);
+    pump.set_mode(config.mode);
+}
+
+void register_pump_routes(WebServer &server, Pump &pump) {
+    server
+            .registerUri("/api/pump", HTTP_GET, [](httpd_req_t *req) {
+                return send_status(req, *static_cast<Pump *>(req->user_ctx));
+            }, &pump)
+            .registerUri("/api/pump", HTTP_POST, [](httpd_req_t *req) {
+                return handle_post(req, *static_cast<Pump *>(req->user_ctx));
+            }, &pump);
+}
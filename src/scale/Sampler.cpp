@@ -0,0 +1,114 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#include "scale/Sampler.hpp"
+
+#include <cmath>
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#include "mem/HeapGuard.hpp"
+#include "trace/Trace.hpp"
+
+static auto TAG = "Sampler";
+
+Sampler::Sampler(HX711 &scale, const float alpha, const float deadband)
+    : m_scale(scale),
+      m_alpha(alpha > 0.0f && alpha <= 1.0f ? alpha : 1.0f),
+      m_deadband(deadband > 0.0f ? deadband : 0.0f) {}
+
+void Sampler::start(const UBaseType_t priority, const BaseType_t core) {
+    if (m_task) {
+        return;
+    }
+    xTaskCreatePinnedToCore(task_entry, "sampler", 3072, this, priority, &m_task, core);
+    ESP_LOGI(TAG, "Sampler started on core %d", static_cast<int>(core));
+}
+
+Reading Sampler::latest() const {
+    taskENTER_CRITICAL(&m_lock);
+    const Reading reading = m_latest;
+    taskEXIT_CRITICAL(&m_lock);
+    return reading;
+}
+
+Reading Sampler::current() const {
+    taskENTER_CRITICAL(&m_lock);
+    const Reading reading = m_current;
+    taskEXIT_CRITICAL(&m_lock);
+    return reading;
+}
+
+bool Sampler::add_listener(TaskHandle_t task, const bool versions_only) {
+    taskENTER_CRITICAL(&m_lock);
+    const bool added = m_listener_count < m_listeners.size();
+    if (added) {
+        m_listeners[m_listener_count++] = {task, versions_only};
+    }
+    taskEXIT_CRITICAL(&m_lock);
+    return added;
+}
+
+void Sampler::task_entry(void *arg) {
+    static_cast<Sampler *>(arg)->run();
+}
+
+void Sampler::run() {
+    HeapGuard::watch(xTaskGetCurrentTaskHandle());
+    for (;;) {
+        // The HX711 converts at 10 or 80 SPS, waiting for DOUT paces the loop
+        if (!m_scale.wait_ready_timeout(200)) {
+            on_timeout();
+            continue;
+        }
+        const int64_t ready_us = esp_timer_get_time();
+        const auto units = m_scale.try_get_units(0);
+        const int64_t read_us = esp_timer_get_time();
+        if (!units) {
+            // DOUT went high again between the ready check and the read
+            on_timeout();
+            continue;
+        }
+        m_read.observe(static_cast<uint32_t>(read_us - ready_us));
+        publish(*units, read_us);
+    }
+}
+
+void Sampler::on_timeout() {
+    TRACE_INSTANT("sampler.timeout", m_timeouts + 1);
+    if (++m_timeouts % 10 == 1) {
+        ESP_LOGW(TAG, "HX711 not ready (%u timeouts)", static_cast<unsigned>(m_timeouts));
+    }
+}
+
+void Sampler::render_metrics(ResponseBuffer &out) const {
+    m_read.render(out, "sampler_read_seconds", "Time to clock one conversion out of the HX711");
+}
+
+void Sampler::publish(const float raw_weight, const int64_t timestamp_us) {
+    taskENTER_CRITICAL(&m_lock);
+    m_latest.raw_weight = raw_weight;
+    m_latest.weight = m_latest.seq == 0 ? raw_weight : m_latest.weight + m_alpha * (raw_weight - m_latest.weight);
+    m_latest.timestamp_us = timestamp_us;
+    const uint32_t seq = ++m_latest.seq;
+    // Compared with the weight of the current version, so a slow drift adds up until it crosses the deadband
+    const bool changed = m_current.version == 0 ||
+                         (std::fabs(m_latest.weight - m_current.weight) >= m_deadband &&
+                          timestamp_us - m_current.timestamp_us >= MIN_VERSION_INTERVAL_MS * 1000LL);
+    if (changed) {
+        ++m_latest.version;
+        m_current = m_latest;
+    }
+    const size_t listener_count = m_listener_count;
+    taskEXIT_CRITICAL(&m_lock);
+    // Gaps between publishes show missed conversions
+    TRACE_INSTANT("sampler.publish", seq);
+
+    for (size_t i = 0; i < listener_count; ++i) {
+        if (changed || !m_listeners[i].versions_only) {
+            xTaskNotifyGive(m_listeners[i].task);
+        }
+    }
+}
@@ -0,0 +1,247 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#include "scale/ScaleApi.hpp"
+
+#include <atomic>
+#include <cinttypes>
+#include <cstdlib>
+#include <cstring>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include "json/JsonWriter.hpp"
+#include "mem/HeapGuard.hpp"
+
+static auto TAG = "ScaleApi";
+
+namespace {
+    /**
+     * @brief A long poll waiting for a reading newer than `after`
+     */
+    struct Parked {
+        httpd_req_t *req;       ///< Async copy of the request, nullptr if the slot is free
+        uint32_t after;
+        int64_t deadline_us;
+        char if_none_match[40];
+    };
+}
+
+static Sampler *sampler = nullptr;
+static TaskHandle_t poller = nullptr;
+static portMUX_TYPE parked_lock = portMUX_INITIALIZER_UNLOCKED;
+static Parked parked[ScaleApi::MAX_PARKED];
+static std::atomic<uint32_t> parked_count{0};
+static std::atomic<bool> draining{false};
+
+static std::atomic<uint32_t> not_modified{0};
+static std::atomic<uint32_t> poll_timeouts{0};
+static std::atomic<uint32_t> poll_rejected{0};
+
+static int64_t us_to_ms(const int64_t us) {
+    return us / 1000;
+}
+
+template<>
+struct JsonSchema<Reading> {
+    static constexpr auto fields = std::make_tuple(
+        json_field("value", &Reading::weight, 3),
+        json_field("version", &Reading::version),
+        json_field("timestamp_ms", &Reading::timestamp_us, us_to_ms));
+};
+
+static void format_etag(const Reading &reading, char *out, const size_t size) {
+    snprintf(out, size, "\"%" PRIu32 "-%" PRId64 "\"", reading.version, reading.timestamp_us);
+}
+
+// If-None-Match holds one or more entity tags separated by commas, or "*"
+static bool etag_matches(const char *if_none_match, const char *etag) {
+    if (if_none_match[0] == '\0') {
+        return false;
+    }
+    return strcmp(if_none_match, "*") == 0 || strstr(if_none_match, etag) != nullptr;
+}
+
+static esp_err_t send_reading(httpd_req_t *req, const Reading &reading, const char *if_none_match) {
+    char etag[32];
+    format_etag(reading, etag, sizeof(etag));
+    httpd_resp_set_hdr(req, "ETag", etag);
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+    if (etag_matches(if_none_match, etag)) {
+        not_modified.fetch_add(1, std::memory_order_relaxed);
+        httpd_resp_set_status(req, "304 Not Modified");
+        return httpd_resp_send(req, nullptr, 0);
+    }
+    ResponseBuffer resp(req);
+    httpd_resp_set_type(req, "application/json");
+    JsonWriter(resp).object(reading);
+    return resp.send();
+}
+
+static bool park(httpd_req_t *req, const uint32_t after, const uint32_t wait_ms, const char *if_none_match) {
+    if (draining.load()) {
+        return false;
+    }
+    int free_slot = -1;
+    taskENTER_CRITICAL(&parked_lock);
+    for (size_t i = 0; i < ScaleApi::MAX_PARKED; ++i) {
+        // Claimed with a placeholder, the async copy is made outside the critical section
+        if (!parked[i].req) {
+            parked[i].req = req;
+            free_slot = static_cast<int>(i);
+            break;
+        }
+    }
+    taskEXIT_CRITICAL(&parked_lock);
+    if (free_slot < 0) {
+        return false;
+    }
+
+    httpd_req_t *async = nullptr;
+    esp_err_t err;
+    {
+        // The copy is httpd's own allocation, freed by httpd_req_async_handler_complete()
+        const HeapGuard::Exempt exempt;
+        err = httpd_req_async_handler_begin(req, &async);
+    }
+    Parked &slot = parked[free_slot];
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Cannot park request: %s", esp_err_to_name(err));
+        taskENTER_CRITICAL(&parked_lock);
+        slot.req = nullptr;
+        taskEXIT_CRITICAL(&parked_lock);
+        return false;
+    }
+    taskENTER_CRITICAL(&parked_lock);
+    slot.after = after;
+    slot.deadline_us = esp_timer_get_time() + static_cast<int64_t>(wait_ms) * 1000;
+    strlcpy(slot.if_none_match, if_none_match, sizeof(slot.if_none_match));
+    slot.req = async;
+    taskEXIT_CRITICAL(&parked_lock);
+    parked_count.fetch_add(1);
+    // The poller rechecks the latest reading, so one published since the handler read it is not missed
+    xTaskNotifyGive(poller);
+    return true;
+}
+
+static esp_err_t handle_get(httpd_req_t *req) {
+    const Reading reading = sampler->current();
+
+    char if_none_match[40] = "";
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", if_none_match, sizeof(if_none_match)) != ESP_OK) {
+        if_none_match[0] = '\0';
+    }
+
+    char query[48];
+    char value[12];
+    bool has_after = false;
+    uint32_t after = 0;
+    uint32_t wait_ms = 0;
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        if (httpd_query_key_value(query, "after", value, sizeof(value)) == ESP_OK) {
+            has_after = true;
+            after = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+        }
+        if (httpd_query_key_value(query, "wait", value, sizeof(value)) == ESP_OK) {
+            const unsigned long wait = strtoul(value, nullptr, 10);
+            wait_ms = wait > ScaleApi::MAX_WAIT_MS ? ScaleApi::MAX_WAIT_MS : static_cast<uint32_t>(wait);
+        }
+    }
+
+    if (has_after && wait_ms > 0 && reading.version == after) {
+        if (park(req, after, wait_ms, if_none_match)) {
+            return ESP_OK;
+        }
+        poll_rejected.fetch_add(1, std::memory_order_relaxed);
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_set_hdr(req, "Retry-After", "1");
+        httpd_resp_sendstr(req, "Too many long polls");
+        return ESP_OK;
+    }
+    return send_reading(req, reading, if_none_match);
+}
+
+[[noreturn]] static void run(void *) {
+    HeapGuard::watch(xTaskGetCurrentTaskHandle());
+    sampler->add_listener(xTaskGetCurrentTaskHandle(), true);
+    for (;;) {
+        // Woken by every new version and every newly parked request, otherwise at the nearest deadline
+        TickType_t timeout = portMAX_DELAY;
+        if (parked_count.load() > 0) {
+            int64_t nearest = INT64_MAX;
+            taskENTER_CRITICAL(&parked_lock);
+            for (const auto &slot : parked) {
+                if (slot.req && slot.deadline_us < nearest) {
+                    nearest = slot.deadline_us;
+                }
+            }
+            taskEXIT_CRITICAL(&parked_lock);
+            const int64_t left_us = nearest - esp_timer_get_time();
+            timeout = left_us <= 0 ? 0 : pdMS_TO_TICKS(left_us / 1000) + 1;
+        }
+        ulTaskNotifyTake(pdTRUE, timeout);
+
+        const Reading reading = sampler->current();
+        const int64_t now = esp_timer_get_time();
+        const bool drain = draining.load();
+        for (auto &slot : parked) {
+            Parked due{};
+            taskENTER_CRITICAL(&parked_lock);
+            // A slot still holding the original request is being parked by the httpd task
+            const bool ready = slot.req && slot.deadline_us != 0 &&
+                               (drain || reading.version != slot.after || now >= slot.deadline_us);
+            if (ready) {
+                due = slot;
+                slot.req = nullptr;
+                slot.deadline_us = 0;
+            }
+            taskEXIT_CRITICAL(&parked_lock);
+            if (!ready) {
+                continue;
+            }
+            if (reading.version == due.after) {
+                poll_timeouts.fetch_add(1, std::memory_order_relaxed);
+            }
+            send_reading(due.req, reading, due.if_none_match);
+            httpd_req_async_handler_complete(due.req);
+            parked_count.fetch_sub(1);
+        }
+    }
+}
+
+void ScaleApi::start(WebServer &server, Sampler &scale_sampler) {
+    if (poller) {
+        return;
+    }
+    sampler = &scale_sampler;
+    xTaskCreatePinnedToCore(run, "scale_poll", 4096, nullptr, 4, &poller, 0);
+    server.registerUri("/scale", HTTP_GET, handle_get);
+}
+
+void ScaleApi::drain() {
+    if (!poller) {
+        return;
+    }
+    draining.store(true);
+    xTaskNotifyGive(poller);
+    for (int i = 0; i < 100 && parked_count.load() > 0; ++i) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    draining.store(false);
+}
+
+void ScaleApi::render_metrics(ResponseBuffer &out) {
+    out.appendf("# HELP scale_not_modified_total Reads answered 304 Not Modified\n"
+                "# TYPE scale_not_modified_total counter\nscale_not_modified_total %" PRIu32 "\n"
+                "# HELP scale_long_polls_parked Long polls waiting for a reading\n"
+                "# TYPE scale_long_polls_parked gauge\nscale_long_polls_parked %" PRIu32 "\n"
+                "# HELP scale_long_poll_timeouts_total Long polls answered without a newer reading\n"
+                "# TYPE scale_long_poll_timeouts_total counter\nscale_long_poll_timeouts_total %" PRIu32 "\n"
+                "# HELP scale_long_poll_rejected_total Long polls refused with 503, every slot was taken\n"
+                "# TYPE scale_long_poll_rejected_total counter\nscale_long_poll_rejected_total %" PRIu32 "\n",
+                not_modified.load(), parked_count.load(), poll_timeouts.load(), poll_rejected.load());
+}
@@ -1,12 +1,18 @@
 #include "server/WebServer.hpp"
 
+#include <cstring>
+
+#include "json/JsonWriter.hpp"
+#include "mem/HeapGuard.hpp"
+#include "trace/Trace.hpp"
+
 static auto TAG = "WebServer";
 
 esp_err_t health_handler(httpd_req_t *req) {
-    const auto resp = R"({"status": "ok", "version": "1.0"})";
+    ResponseBuffer resp(req);
     httpd_resp_set_type(req, "application/json");
-    httpd_resp_send(req, resp, HTTPD_RESP_USE_STRLEN);
-    return ESP_OK;
+    JsonWriter(resp).begin_object().field("status", "ok").field("version", "1.0").end_object();
+    return resp.send();
 }
 
 WebServer::WebServer() : m_server(nullptr) {
@@ -17,17 +23,26 @@ WebServer::~WebServer() { stop(); }
 
 WebServer &WebServer::registerUri(const char *uri,
                                   httpd_method_t method,
-                                  const std::function<esp_err_t(httpd_req_t *)> &handler) {
+                                  const Handler handler,
+                                  void *user_ctx) {
     ESP_LOGI(TAG, "Registering URI: %s", uri);
-    handlers[uri] = {handler, method};
+    HANDLER *entry = nullptr;
+    for (size_t i = 0; i < handler_count; ++i) {
+        if (handlers[i].method == method && strcmp(handlers[i].uri, uri) == 0) {
+            entry = &handlers[i];
+            break;
+        }
+    }
+    if (!entry) {
+        if (handler_count == handlers.size()) {
+            ESP_LOGE(TAG, "Handler table full, cannot register URI: %s", uri);
+            return *this;
+        }
+        entry = &handlers[handler_count++];
+    }
+    *entry = {uri, handler, user_ctx, method, TRACE_INTERN(uri)};
     if (m_server) {
-        const httpd_uri_t ep = {
-            .uri = uri,
-            .method = method,
-            .handler = dispatch_handler,
-            .user_ctx = nullptr
-        };
-        httpd_register_uri_handler(m_server, &ep);
+        expose(*entry);
     }
     ESP_LOGI(TAG, "Registered URI: %s", uri);
     return *this;
@@ -40,6 +55,9 @@ WebServer &WebServer::start() {
     }
 
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.max_uri_handlers = MAX_URI_HANDLERS;
+    // Metrics and JSON handlers format on the stack
+    config.stack_size = 6144;
     if (const esp_err_t err = httpd_start(&m_server, &config); err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to start WebServer: %s", esp_err_to_name(err));
         m_server = nullptr;
@@ -48,19 +66,9 @@ WebServer &WebServer::start() {
 
     ESP_LOGI(TAG, "WebServer started");
 
-    auto register_handlers = [this]() {
-        for (const auto &[uri, handler] : handlers) {
-            httpd_uri_t ep = {
-                .uri = uri.c_str(),
-                .method = handler.method,
-                .handler = dispatch_handler,
-                .user_ctx = nullptr
-            };
-            ESP_LOGI(TAG, "Exposing URI: %s", uri.c_str());
-            httpd_register_uri_handler(m_server, &ep);
-        }
-    };
-    register_handlers();
+    for (size_t i = 0; i < handler_count; ++i) {
+        expose(handlers[i]);
+    }
 
     return *this;
 }
@@ -74,19 +82,33 @@ WebServer &WebServer::stop() {
     return *this;
 }
 
-std::map<std::string, HANDLER > WebServer::handlers;
+std::array<HANDLER, WebServer::MAX_URI_HANDLERS> WebServer::handlers;
+size_t WebServer::handler_count = 0;
+
+void WebServer::expose(HANDLER &handler) const {
+    const httpd_uri_t ep = {
+        .uri = handler.uri,
+        .method = handler.method,
+        .handler = dispatch_handler,
+        .user_ctx = &handler
+    };
+    ESP_LOGI(TAG, "Exposing URI: %s", handler.uri);
+    httpd_register_uri_handler(m_server, &ep);
+}
 
 esp_err_t WebServer::dispatch_handler(httpd_req_t *req) {
-    ESP_LOGI(TAG, "Dispatching URI: %s", req->uri);
-    const char *uri = req->uri;
-    const auto it = handlers.find(uri);
-    if (it == handlers.end()) {
+    ESP_LOGD(TAG, "Dispatching URI: %s", req->uri);
+    const auto *handler = static_cast<const HANDLER *>(req->user_ctx);
+    if (!handler || !handler->fn) {
         // No handler found for this URI
         return ESP_FAIL;
     }
-    const auto &fn = it->second.fn;
-    if (!fn) {
-        return ESP_FAIL;
-    }
-    return fn(req);
+    // The socket tells requests from different connections apart in the trace
+    TRACE_SCOPE_ID(handler->trace_id, static_cast<uint32_t>(httpd_req_to_sockfd(req)));
+    // Handlers must not allocate once boot is over
+    const HeapGuard::Scope scope;
+    req->user_ctx = handler->user_ctx;
+    const esp_err_t err = handler->fn(req);
+    HeapGuard::report(handler->uri, scope.count());
+    return err;
 }
@@ -0,0 +1,166 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+
+#include "trace/Trace.hpp"
+
+#if SMART_FOUNTAIN_TRACE
+
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cstring>
+#include <esp_attr.h>
+#include <freertos/FreeRTOS.h>
+
+#include "json/JsonWriter.hpp"
+
+namespace {
+    // Sequence lock: seq is odd while the slot is being written and advances by two per record, so a reader
+    // that sees the same even value before and after its copy got one whole record
+    struct Slot {
+        std::atomic<uint32_t> seq;      ///< 0 until the first record
+        std::atomic<uint32_t> meta;     ///< Timestamp bits 32..39 << 24 | kind << 16 | id
+        std::atomic<uint32_t> start_lo; ///< Timestamp bits 0..31, in µs since boot
+        std::atomic<uint32_t> duration;
+        std::atomic<uint32_t> arg;
+    };
+
+    struct Ring {
+        std::atomic<uint32_t> head;     ///< Records ever written on this core
+        Slot slots[Trace::RING_SIZE];
+    };
+
+    struct Record {
+        int64_t start_us;
+        uint32_t duration_us;
+        uint32_t arg;
+        uint16_t id;
+        Trace::Kind kind;
+    };
+
+    constexpr uint64_t TIMESTAMP_MASK = (1ULL << 40) - 1;
+}
+
+static Ring rings[portNUM_PROCESSORS];
+static const char *event_names[Trace::MAX_EVENTS + 1];
+static std::atomic<size_t> event_count{0};
+static portMUX_TYPE names_lock = portMUX_INITIALIZER_UNLOCKED;
+
+uint16_t Trace::intern(const char *name) {
+    taskENTER_CRITICAL(&names_lock);
+    uint16_t id = 0;
+    const size_t count = event_count.load(std::memory_order_relaxed);
+    for (size_t i = 1; i <= count; ++i) {
+        if (strcmp(event_names[i], name) == 0) {
+            id = static_cast<uint16_t>(i);
+            break;
+        }
+    }
+    if (!id && count < MAX_EVENTS) {
+        event_names[count + 1] = name;
+        id = static_cast<uint16_t>(count + 1);
+        event_count.store(count + 1, std::memory_order_release);
+    }
+    taskEXIT_CRITICAL(&names_lock);
+    return id;
+}
+
+IRAM_ATTR void Trace::record(const uint16_t id, const Kind kind, const int64_t start_us, const uint32_t duration_us,
+                             const uint32_t arg) {
+    if (!id) {
+        return;
+    }
+    Ring &ring = rings[xPortGetCoreID()];
+    const uint32_t index = ring.head.fetch_add(1, std::memory_order_relaxed);
+    Slot &slot = ring.slots[index & (RING_SIZE - 1)];
+    const auto start = static_cast<uint64_t>(start_us);
+
+    slot.seq.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.meta.store(static_cast<uint32_t>(start >> 32 & 0xFF) << 24 | static_cast<uint32_t>(kind) << 16 | id,
+                    std::memory_order_relaxed);
+    slot.start_lo.store(static_cast<uint32_t>(start), std::memory_order_relaxed);
+    slot.duration.store(duration_us, std::memory_order_relaxed);
+    slot.arg.store(arg, std::memory_order_relaxed);
+    slot.seq.fetch_add(1, std::memory_order_release);
+}
+
+/**
+ * @brief Copies a slot, returns false if it is empty or was rewritten during the copy
+ */
+static bool read_slot(const Slot &slot, const int64_t now_us, Record &out) {
+    const uint32_t seq = slot.seq.load(std::memory_order_acquire);
+    if (seq == 0 || seq & 1) {
+        return false;
+    }
+    const uint32_t meta = slot.meta.load(std::memory_order_relaxed);
+    const uint32_t start_lo = slot.start_lo.load(std::memory_order_relaxed);
+    out.duration_us = slot.duration.load(std::memory_order_relaxed);
+    out.arg = slot.arg.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.seq.load(std::memory_order_relaxed) != seq) {
+        return false;
+    }
+    out.id = static_cast<uint16_t>(meta & 0xFFFF);
+    out.kind = static_cast<Trace::Kind>(meta >> 16 & 0xFF);
+    if (out.id == 0 || out.id > event_count.load(std::memory_order_acquire)) {
+        return false;
+    }
+    // 40 bits of µs wrap after 12 days, records are placed relative to now
+    const uint64_t start40 = static_cast<uint64_t>(meta >> 24) << 32 | start_lo;
+    const auto now = static_cast<uint64_t>(now_us);
+    out.start_us = static_cast<int64_t>(now - ((now - start40) & TIMESTAMP_MASK));
+    return true;
+}
+
+void Trace::render_metrics(ResponseBuffer &out) {
+    out.append("# HELP trace_events_total Trace records written per core\n# TYPE trace_events_total counter\n");
+    for (int core = 0; core < portNUM_PROCESSORS; ++core) {
+        out.appendf("trace_events_total{core=\"%d\"} %" PRIu32 "\n", core, rings[core].head.load());
+    }
+}
+
+esp_err_t Trace::handler(httpd_req_t *req) {
+    ResponseBuffer resp(req);
+    httpd_resp_set_type(req, "application/json");
+    JsonWriter json(resp);
+    json.begin_object().field("displayTimeUnit", "ms").key("traceEvents").begin_array();
+
+    // One track per core
+    json.begin_object().field("name", "process_name").field("ph", "M").field("pid", 1)
+            .key("args").begin_object().field("name", "smart-fountain").end_object().end_object();
+    for (int core = 0; core < portNUM_PROCESSORS; ++core) {
+        char name[8] = "core 0";
+        name[5] = static_cast<char>('0' + core);
+        json.begin_object().field("name", "thread_name").field("ph", "M").field("pid", 1).field("tid", core)
+                .key("args").begin_object().field("name", name).end_object().end_object();
+    }
+
+    const int64_t now_us = esp_timer_get_time();
+    for (int core = 0; core < portNUM_PROCESSORS; ++core) {
+        const Ring &ring = rings[core];
+        const uint32_t head = ring.head.load(std::memory_order_acquire);
+        const uint32_t count = std::min<uint32_t>(head, RING_SIZE);
+        for (uint32_t i = head - count; i != head; ++i) {
+            Record record{};
+            if (!read_slot(ring.slots[i & (RING_SIZE - 1)], now_us, record)) {
+                continue;
+            }
+            json.begin_object().field("name", event_names[record.id]);
+            if (record.kind == Kind::COMPLETE) {
+                json.field("ph", "X").field("dur", record.duration_us);
+            } else {
+                json.field("ph", "i").field("s", "t");
+            }
+            json.field("ts", record.start_us).field("pid", 1).field("tid", core)
+                    .key("args").begin_object().field("arg", record.arg).end_object()
+                    .end_object();
+        }
+    }
+    json.end_array().end_object();
+    return resp.send();
+}
+
+#endif
@@ -0,0 +1,32 @@
+#
+# Created on 19/10/2026.
+# Copyright (c) 2026 smart-fountain.
+#
+# PlatformIO post script of the release profile: fails the build when src/linker.lf did not place the sampler loop
+# in IRAM, e.g. because its archive or object name no longer matches what the build produces. ldgen does not report
+# a mapping that matches nothing, so without this check the release image would keep the sampler in flash.
+
+Import("env")
+
+import os
+import sys
+
+sys.path.insert(0, os.path.join(env.subst("$PROJECT_DIR"), "tools"))
+from profile_report import HOT_PATH, hot_path_sections
+
+
+def check_hot_path(source, target, env):
+    objdump = env.WhereIs(env.subst("$CC").replace("-gcc", "-objdump"))
+    if not objdump:
+        sys.stderr.write("objdump not found next to %s, cannot check the IRAM placement\n" % env.subst("$CC"))
+        env.Exit(1)
+    sections = hot_path_sections(objdump, str(target[0]))
+    outside = ["%s in %s" % (name, sections.get(name, "no section")) for name in HOT_PATH
+               if not sections.get(name, "").startswith(".iram0")]
+    if outside:
+        sys.stderr.write("src/linker.lf did not place the sampler loop in IRAM: %s\n" % ", ".join(outside))
+        env.Exit(1)
+    print("Sampler loop in IRAM")
+
+
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", check_hot_path)
@@ -0,0 +1,226 @@
+#!/usr/bin/env python3
+#
+# Created on 19/10/2026.
+# Copyright (c) 2026 smart-fountain.
+#
+# Compares the debug and release build profiles: image size and memory use from the linked ELF, and optionally
+# per-sample and per-request latency measured on a device flashed with each profile in turn.
+#
+#   tools/profile_report.py [--no-build] [--host 192.168.1.50 [--port 80] [--upload-port /dev/ttyACM0]
+#                           [--bench host/build/http_bench] [--duration 10]] [--output report.md]
+#
+# Sizes come from the section headers of .pio/build/<env>/firmware.elf. With --host, each profile is uploaded, the
+# device is given time to sample, then http_bench measures the API and /metrics provides sampler_read_seconds.
+# The symbol table tells where the sampler loop was linked, the release profile fails the report unless linker.lf
+# placed it in IRAM. The report is Markdown, printed or written to --output. The exit code is 2 on usage errors, 1 if
+# a step fails or the release hot path is not in IRAM.
+
+import argparse
+import glob
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+import urllib.request
+
+ENVS = [("debug", "esp32-s3-devkitc-1"), ("release", "esp32-s3-devkitc-1-release")]
+ROUTES = ["/health", "/scale", "/api/pump", "/metrics"]
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+
+def run(cmd):
+    print("+ " + " ".join(cmd), file=sys.stderr)
+    subprocess.run(cmd, cwd=ROOT, check=True)
+
+
+HOT_PATH = ["Sampler::run()", "Sampler::publish(float, long long)"]
+
+
+def tool(name):
+    found = shutil.which("xtensa-esp32s3-elf-" + name)
+    if found:
+        return found
+    candidates = glob.glob(os.path.expanduser(
+        "~/.platformio/packages/toolchain-xtensa-esp*/bin/xtensa-esp32s3-elf-" + name))
+    if not candidates:
+        sys.exit("xtensa-esp32s3-elf-%s not found, add the toolchain to PATH" % name)
+    return candidates[0]
+
+
+def hot_path_sections(objdump, elf):
+    """Section each HOT_PATH function was linked into, functions missing from the symbol table are left out.
+    Also used by tools/check_hot_path.py after every release link."""
+    out = subprocess.run([objdump, "-t", "-C", elf], check=True, capture_output=True, text=True).stdout
+    sections = {}
+    for line in out.splitlines():
+        # "<address> <7 flag characters> <section>\t<size> <name>"
+        match = re.match(r"^[0-9a-f]+ .{7} (\S+)\t[0-9a-f]+\s+(.*)$", line)
+        if match and match.group(2) in HOT_PATH:
+            sections[match.group(2)] = match.group(1)
+    return sections
+
+
+def hot_path_in_iram(env):
+    """True if every HOT_PATH function was linked into an IRAM section."""
+    elf = os.path.join(ROOT, ".pio", "build", env, "firmware.elf")
+    sections = hot_path_sections(tool("objdump"), elf)
+    missing = [name for name in HOT_PATH if name not in sections]
+    if missing:
+        sys.exit("%s not found in %s" % (", ".join(missing), elf))
+    return all(section.startswith(".iram0") for section in sections.values())
+
+
+def sizes(env):
+    build = os.path.join(ROOT, ".pio", "build", env)
+    out = subprocess.run([tool("size"), "-A", os.path.join(build, "firmware.elf")], check=True, capture_output=True,
+                         text=True).stdout
+    sections = {}
+    for line in out.splitlines():
+        fields = line.split()
+        if len(fields) >= 2 and fields[0].startswith(".") and fields[1].isdigit():
+            sections[fields[0]] = int(fields[1])
+
+    def total(prefix):
+        return sum(size for name, size in sections.items() if name.startswith(prefix))
+
+    return {
+        "image_bytes": os.path.getsize(os.path.join(build, "firmware.bin")),
+        "iram_bytes": total(".iram0"),
+        "dram_bytes": total(".dram0"),
+        "flash_code_bytes": total(".flash.text"),
+        "flash_rodata_bytes": total(".flash.rodata"),
+    }
+
+
+def fetch(url, timeout=5):
+    with urllib.request.urlopen(url, timeout=timeout) as response:
+        return response.read().decode()
+
+
+def wait_for(base, timeout_s=90):
+    deadline = time.time() + timeout_s
+    while time.time() < deadline:
+        try:
+            fetch(base + "/health", timeout=2)
+            return
+        except OSError:
+            time.sleep(2)
+    sys.exit("device at %s did not come back after the upload" % base)
+
+
+def read_histogram(metrics, name):
+    """Mean and p99 upper bound in microseconds of a histogram in Prometheus text format."""
+    buckets, total, count = [], 0.0, 0
+    for line in metrics.splitlines():
+        if line.startswith(name + "_bucket{le=\""):
+            bound = line.split("\"")[1]
+            buckets.append((float("inf") if bound == "+Inf" else float(bound), int(line.split()[-1])))
+        elif line.startswith(name + "_sum "):
+            total = float(line.split()[-1])
+        elif line.startswith(name + "_count "):
+            count = int(line.split()[-1])
+    if count == 0:
+        return None
+    p99 = next(bound for bound, cumulative in buckets if cumulative >= 0.99 * count)
+    return {"mean_us": total / count * 1e6, "p99_le_us": p99 * 1e6, "count": count}
+
+
+def measure(env, args):
+    upload = ["pio", "run", "-e", env, "-t", "upload"]
+    if args.upload_port:
+        upload += ["--upload-port", args.upload_port]
+    run(upload)
+    base = "http://%s:%d" % (args.host, args.port)
+    wait_for(base)
+    # Let the sampler and the pump loop fill their histograms before the load starts
+    time.sleep(args.settle)
+    with tempfile.NamedTemporaryFile(suffix=".json") as results:
+        cmd = [args.bench, "--host", args.host, "--port", str(args.port), "--duration", str(args.duration),
+               "--json", results.name]
+        for route in ROUTES:
+            cmd += ["--route", route]
+        run(cmd)
+        bench = json.load(results)
+    return {
+        "sample": read_histogram(fetch(base + "/metrics"), "sampler_read_seconds"),
+        "routes": {r["route"]: r for r in bench["routes"]},
+    }
+
+
+def row(label, debug, release, unit="", fmt="%d"):
+    if debug is None or release is None:
+        return "| %s | %s | %s | |" % (label, "-" if debug is None else fmt % debug, "-" if release is None else
+                                        fmt % release)
+    delta = "%+.1f%%" % ((release - debug) / debug * 100) if debug else ""
+    return "| %s | %s%s | %s%s | %s |" % (label, fmt % debug, unit, fmt % release, unit, delta)
+
+
+def report(results, measured):
+    debug, release = results["debug"], results["release"]
+    lines = ["# Build profile report", "", "| | debug | release | change |", "|---|---:|---:|---:|"]
+    for key, label in [("image_bytes", "Image size"), ("iram_bytes", "IRAM"), ("dram_bytes", "DRAM (static)"),
+                       ("flash_code_bytes", "Flash code"), ("flash_rodata_bytes", "Flash rodata")]:
+        lines.append(row(label, debug["sizes"][key], release["sizes"][key], " B"))
+    lines.append("| Sampler loop in IRAM | %s | %s | |" % tuple("yes" if results[p]["hot_path_in_iram"] else "no"
+                                                              for p in ("debug", "release")))
+    if measured:
+        ds, rs = debug["latency"]["sample"], release["latency"]["sample"]
+        lines.append(row("HX711 read, mean", ds and ds["mean_us"], rs and rs["mean_us"], " µs", "%.1f"))
+        lines.append(row("HX711 read, p99 ≤", ds and ds["p99_le_us"], rs and rs["p99_le_us"], " µs", "%.0f"))
+        for route in ROUTES:
+            d = debug["latency"]["routes"].get(route)
+            r = release["latency"]["routes"].get(route)
+            for metric in ["p50_ms", "p99_ms"]:
+                lines.append(row("%s %s" % (route, metric[:3]), d and d[metric], r and r[metric], " ms", "%.2f"))
+            lines.append(row("%s req/s" % route, d and d["rps"], r and r["rps"], "", "%.0f"))
+    else:
+        lines += ["", "Latency not measured, pass --host to flash each profile and measure it."]
+    return "\n".join(lines) + "\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare the debug and release build profiles")
+    parser.add_argument("--no-build", action="store_true", help="use the existing .pio/build outputs")
+    parser.add_argument("--host", help="device to flash and measure, sizes only without it")
+    parser.add_argument("--port", type=int, default=80)
+    parser.add_argument("--upload-port")
+    parser.add_argument("--bench", default=os.path.join(ROOT, "host", "build", "http_bench"))
+    parser.add_argument("--duration", type=float, default=10)
+    parser.add_argument("--settle", type=float, default=15, help="seconds between boot and the measurement")
+    parser.add_argument("--output")
+    args = parser.parse_args()
+    if args.host and not os.access(args.bench, os.X_OK):
+        print("%s not found, build it with cmake -S host -B host/build" % args.bench, file=sys.stderr)
+        return 2
+
+    results = {}
+    try:
+        for profile, env in ENVS:
+            if not args.no_build:
+                run(["pio", "run", "-e", env])
+            results[profile] = {"sizes": sizes(env), "hot_path_in_iram": hot_path_in_iram(env)}
+            if args.host:
+                results[profile]["latency"] = measure(env, args)
+    except (subprocess.CalledProcessError, OSError) as e:
+        print(e, file=sys.stderr)
+        return 1
+
+    text = report(results, bool(args.host))
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(text)
+    else:
+        sys.stdout.write(text)
+    if not results["release"]["hot_path_in_iram"]:
+        print("release: the Sampler is not in IRAM, check the archive and object names in src/linker.lf",
+              file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
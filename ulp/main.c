@@ -0,0 +1,77 @@
+//
+// Created on 19/10/2026.
+// Copyright (c) 2026 smart-fountain.
+//
+// ULP RISC-V program: samples the HX711 while the main CPU is in deep sleep, see LowPower.
+// Runs every LowPower::ULP_PERIOD_MS, the decisions are in UlpSampling.h so they can be checked on the host.
+
+#include <stdint.h>
+
+#include "ulp_riscv_gpio.h"
+#include "ulp_riscv_utils.h"
+
+#include "../include/scale/UlpSampling.h"
+
+// Shared with the main CPU as ulp_config and ulp_state
+ulp_sampling_config_t config;
+ulp_sampling_state_t state;
+
+// Same 1 µs half period as the HX711 driver
+static inline void hx711_delay(void) {
+    ulp_riscv_delay_cycles(ULP_RISCV_CYCLES_PER_US);
+}
+
+static inline void clk_high(void) {
+    ulp_riscv_gpio_output_level((gpio_num_t) config.clk_gpio, 1);
+}
+
+static inline void clk_low(void) {
+    ulp_riscv_gpio_output_level((gpio_num_t) config.clk_gpio, 0);
+}
+
+// Mirrors HX711::read_once, nothing can interrupt the ULP so SCK never stays high long enough to power down
+static int32_t read_once(void) {
+    uint32_t value = 0;
+    clk_low();
+    hx711_delay();
+    for (int i = 0; i < 24; ++i) {
+        clk_high();
+        hx711_delay();
+        value = (value << 1) | (ulp_riscv_gpio_get_level((gpio_num_t) config.data_gpio) & 0x01);
+        clk_low();
+        hx711_delay();
+    }
+    value = value ^ 0x800000;
+    for (uint32_t i = 0; i < config.gain_pulses; ++i) {
+        clk_high();
+        hx711_delay();
+        clk_low();
+        hx711_delay();
+    }
+    return (int32_t) value;
+}
+
+int main(void) {
+    const bool data_ready = ulp_riscv_gpio_get_level((gpio_num_t) config.data_gpio) == 0;
+    switch (ulp_sampling_run(&config, &state, data_ready)) {
+        case ULP_ACTION_POWER_UP:
+            clk_low();
+            break;
+        case ULP_ACTION_READ: {
+            const int32_t raw = read_once();
+            // SCK high for more than 60 µs powers the HX711 down until the next conversion
+            clk_high();
+            if (ulp_sampling_on_sample(&config, &state, raw) != ULP_WAKE_NONE) {
+                ulp_riscv_wakeup_main_processor();
+            }
+            break;
+        }
+        case ULP_ACTION_POWER_DOWN:
+            clk_high();
+            break;
+        default:
+            break;
+    }
+    // Halts until the next timer wakeup
+    return 0;
+}